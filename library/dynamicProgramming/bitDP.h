@@ -5,6 +5,8 @@
 // Sum over Subsets(SOS)
 // http://codeforces.com/blog/usaxena95
 // https://discuss.codechef.com/questions/107073/maxor-ediorial
+//  - See "../polynomial/walshHadamard.h" for vectorized zeta/Mobius transforms (FWHT::transformOr/And)
+//    and "../polynomial/subsetConvolution.h" for O(2^n * n^2) subset convolution
 
 // O(3^n)
 // n : the number of elements
@@ -8,6 +8,8 @@ using namespace std;
 int main(void) {
     TEST(PrimeNumberBasic);
     TEST(PrimeNumberEratosthenes);
+    TEST(PrimeNumberSegmentedSieve);
+    TEST(PrimeCounting);
     TEST(Gcd);
     TEST(IntMod);
     TEST(FactorialMod);
@@ -15,6 +17,7 @@ int main(void) {
     TEST(PrimeFactor);
     TEST(EulerTheorem);
     TEST(Mobius);
+    TEST(MultiplicativeSieve);
     TEST(Digit);
     TEST(ChineseRemainderTheorem);
     TEST(DiophantineEquation);
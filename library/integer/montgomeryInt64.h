@@ -0,0 +1,205 @@
+#pragma once
+
+#include <memory>
+
+#ifndef __GNUC__
+#include <intrin.h>
+#endif
+
+// Montgomery multiplication modulo an odd 64-bit integer
+//   - values are kept in Montgomery form, x' = x * R mod n (R = 2^64), and they are in [0, n)
+//   - mul() is two 64x64->128 multiplies and one 64-bit multiply, no division
+//   - it works for all odd n < 2^64 (n > 1)
+struct MontgomeryInt64 {
+    unsigned long long n;
+    unsigned long long nInv;        // n * nInv = 1 (mod 2^64)
+    unsigned long long r2;          // R^2 mod n
+    unsigned long long one;         // R mod n, 1 in Montgomery form
+
+    MontgomeryInt64() : n(0), nInv(0), r2(0), one(0) {
+    }
+
+    explicit MontgomeryInt64(unsigned long long n) {
+        init(n);
+    }
+
+    // n must be odd
+    void init(unsigned long long n) {
+        this->n = n;
+
+        // Newton's method, the number of correct bits doubles : 3 -> 6 -> 12 -> 24 -> 48 -> 96
+        nInv = n;
+        for (int i = 0; i < 5; i++)
+            nInv *= 2 - n * nInv;
+
+        one = (0 - n) % n;
+#ifndef __GNUC__
+        r2 = one;
+        for (int i = 0; i < 64; i++)
+            r2 = add(r2, r2);
+#else
+        r2 = static_cast<unsigned long long>(-static_cast<__uint128_t>(n) % n);
+#endif
+    }
+
+    unsigned long long toMont(unsigned long long x) const {
+        return mul(x % n, r2);
+    }
+
+    unsigned long long fromMont(unsigned long long x) const {
+        return reduce(0, x);
+    }
+
+    // a * b / R mod n, 0 <= a, b < n
+    unsigned long long mul(unsigned long long a, unsigned long long b) const {
+        unsigned long long hi, lo;
+        mul128(a, b, hi, lo);
+        return reduce(hi, lo);
+    }
+
+    unsigned long long add(unsigned long long a, unsigned long long b) const {
+        unsigned long long r = a + b;
+        return (r < a || r >= n) ? r - n : r;
+    }
+
+    unsigned long long sub(unsigned long long a, unsigned long long b) const {
+        return (a >= b) ? a - b : a - b + n;
+    }
+
+    // a^e, 'a' is in Montgomery form
+    unsigned long long power(unsigned long long a, unsigned long long e) const {
+        unsigned long long res = one;
+        while (e > 0) {
+            if (e & 1)
+                res = mul(res, a);
+            a = mul(a, a);
+            e >>= 1;
+        }
+        return res;
+    }
+
+    //--- 128-bit helpers
+
+    static unsigned long long mulHigh(unsigned long long a, unsigned long long b) {
+#ifndef __GNUC__
+        return __umulh(a, b);
+#else
+        return static_cast<unsigned long long>(static_cast<__uint128_t>(a) * b >> 64);
+#endif
+    }
+
+    static void mul128(unsigned long long a, unsigned long long b, unsigned long long& hi, unsigned long long& lo) {
+#ifndef __GNUC__
+        lo = _umul128(a, b, &hi);
+#else
+        __uint128_t t = static_cast<__uint128_t>(a) * b;
+        hi = static_cast<unsigned long long>(t >> 64);
+        lo = static_cast<unsigned long long>(t);
+#endif
+    }
+
+private:
+    // (hi * 2^64 + lo) / R mod n, hi < n
+    //   m = lo / n (mod R), then (hi:lo - m * n) is a multiple of R and its low words are the same
+    unsigned long long reduce(unsigned long long hi, unsigned long long lo) const {
+        unsigned long long m = lo * nInv;
+        unsigned long long t = mulHigh(m, n);
+        return (hi >= t) ? hi - t : hi - t + n;
+    }
+};
+
+// Strong probable prime tests (a step of Miller-Rabin test) with Montgomery multiplication
+//   testBatch() runs LANES tests in lock step, so the multiplications of different numbers overlap in the pipeline.
+//   64-bit SIMD lanes have no 64x64->128 multiplication, so the lanes are interleaved scalar pipelines.
+struct MillerRabinInt64 {
+    static const int LANES = 4;
+
+    // whether n is a strong probable prime to base a, n is odd and n > 2 (true if n == a)
+    static bool test(unsigned long long n, unsigned long long a) {
+        bool res;
+        testBlock<1>(&n, &a, &res);
+        return res;
+    }
+
+    // res[i] = test(n[i], a[i])
+    static void testBatch(const unsigned long long* n, const unsigned long long* a, size_t count, bool* res) {
+        size_t i = 0;
+        for (; i + LANES <= count; i += LANES)
+            testBlock<LANES>(n + i, a + i, res + i);
+        for (; i < count; i++)
+            testBlock<1>(n + i, a + i, res + i);
+    }
+
+    // res[index[j]] = test(n[j], a[j]), and only the numbers which pass the test remain in the lists
+    static void filter(vector<size_t>& index, vector<unsigned long long>& n, vector<unsigned long long>& a, bool* res) {
+        unique_ptr<bool[]> ok(new bool[n.size() + 1]);
+        testBatch(n.data(), a.data(), n.size(), ok.get());
+
+        size_t m = 0;
+        for (size_t j = 0; j < n.size(); j++) {
+            res[index[j]] = ok[j];
+            if (ok[j]) {
+                index[m] = index[j];
+                n[m] = n[j];
+                a[m] = a[j];
+                m++;
+            }
+        }
+        index.resize(m);
+        n.resize(m);
+        a.resize(m);
+    }
+
+private:
+    template <int K>
+    static void testBlock(const unsigned long long* n, const unsigned long long* a, bool* res) {
+        MontgomeryInt64 mont[K];
+        unsigned long long d[K], b[K], y[K], minusOne[K];
+        int s[K];
+        bool ok[K];
+
+        int bits = 0, maxS = 0;
+        for (int l = 0; l < K; l++) {
+            mont[l].init(n[l]);
+            d[l] = n[l] - 1;
+            s[l] = 0;
+            while (!(d[l] & 1)) {
+                d[l] >>= 1;
+                s[l]++;
+            }
+            b[l] = mont[l].toMont(a[l]);
+            y[l] = mont[l].one;
+            minusOne[l] = n[l] - mont[l].one;
+
+            int t = 0;
+            while (t < 64 && (d[l] >> t))
+                t++;
+            bits = max(bits, t);
+            maxS = max(maxS, s[l]);
+        }
+
+        // y = b^d, left-to-right
+        //   lanes have different exponents, so a multiplication is done in every step and its result is selected
+        for (int i = bits - 1; i >= 0; i--) {
+            for (int l = 0; l < K; l++) {
+                unsigned long long t = mont[l].mul(y[l], y[l]);
+                unsigned long long u = mont[l].mul(t, b[l]);
+                y[l] = ((d[l] >> i) & 1) ? u : t;
+            }
+        }
+
+        for (int l = 0; l < K; l++)
+            ok[l] = (y[l] == mont[l].one) | (y[l] == minusOne[l]);
+
+        // b^(d * 2^r) == -1 for some 0 < r < s
+        for (int r = 1; r < maxS; r++) {
+            for (int l = 0; l < K; l++) {
+                y[l] = mont[l].mul(y[l], y[l]);
+                ok[l] |= (r < s[l]) & (y[l] == minusOne[l]);
+            }
+        }
+
+        for (int l = 0; l < K; l++)
+            res[l] = ok[l] | (n[l] == a[l]);
+    }
+};
@@ -0,0 +1,147 @@
+#include <cmath>
+#include <numeric>
+#include <vector>
+#include <algorithm>
+
+using namespace std;
+
+#include "multiplicativeSieve.h"
+#include "primeFactor.h"
+#include "mobius.h"
+#include "eulerTheorem.h"
+
+/////////// For Testing ///////////////////////////////////////////////////////
+
+#include <time.h>
+#include <cassert>
+#include <string>
+#include <iostream>
+#include "../common/iostreamhelper.h"
+#include "../common/profile.h"
+#include "../common/rand.h"
+
+namespace {
+vector<unsigned> divisorSumNaive(int n) {
+    vector<unsigned> res(n + 1);
+    for (int d = 1; d <= n; d++) {
+        for (int x = d; x <= n; x += d)
+            res[x] += d;
+    }
+    return res;
+}
+
+void checkSegment(const MultiplicativeSieve& seg, const MultiplicativeSieve& full, int functions) {
+    for (int i = 0; i < seg.size; i++) {
+        int x = seg.first + i;
+        assert(seg.minFactor[i] == full.minFactor[x]);
+        if (functions & MultiplicativeSieve::PHI)
+            assert(seg.phi[i] == full.phi[x]);
+        if (functions & MultiplicativeSieve::MU)
+            assert(seg.mu[i] == full.mu[x]);
+        if (functions & MultiplicativeSieve::DIVISOR_COUNT)
+            assert(seg.divisorCount[i] == full.divisorCount[x]);
+        if (functions & MultiplicativeSieve::DIVISOR_SUM)
+            assert(seg.divisorSum[i] == full.divisorSum[x]);
+    }
+    for (int p : seg.primes)
+        assert(full.isPrimeNumber(p));
+}
+}
+
+void testMultiplicativeSieve() {
+    return; //TODO: if you want to test, make this line a comment.
+
+    cout << "--- Multiplicative Sieve ----------------------------" << endl;
+    {
+        const int N = 1000000;
+        MultiplicativeSieve sieve(N);
+
+        MinFactors minFactors(N);
+        assert(sieve.minFactor == minFactors.minFactors);
+        assert(sieve.primes == eratosthenes2(N));
+        assert(sieve.phi == phiAll(N));
+        assert(sieve.mu == mobiusSeive(N, minFactors));
+        assert(sieve.divisorCount == minFactors.getAllFactorCount());
+        assert(sieve.divisorSum == divisorSumNaive(N));
+
+        // a part of functions
+        MultiplicativeSieve sieve2(N, MultiplicativeSieve::MU | MultiplicativeSieve::DIVISOR_SUM);
+        assert(sieve2.phi.empty() && sieve2.divisorCount.empty());
+        assert(sieve2.mu == sieve.mu && sieve2.divisorSum == sieve.divisorSum);
+
+        // small
+        for (int n = 0; n <= 10; n++) {
+            MultiplicativeSieve s(n);
+            for (int x = 0; x <= n; x++) {
+                assert(s.minFactor[x] == sieve.minFactor[x]);
+                assert(s.phi[x] == sieve.phi[x]);
+                assert(s.divisorSum[x] == sieve.divisorSum[x]);
+            }
+        }
+
+        // segmented mode
+        for (int segSize : { 1, 7, 1000, 65536 }) {
+            int lo = segSize == 1 ? N - 100 : RandInt32::get() % 1000;
+            int total = 0;
+            MultiplicativeSieve::forEachSegment(lo, N, MultiplicativeSieve::ALL, [&](const MultiplicativeSieve& seg) {
+                assert(seg.first == lo + total);
+                total += seg.size;
+                checkSegment(seg, sieve, MultiplicativeSieve::ALL);
+            }, segSize);
+            assert(total == N - lo + 1);
+        }
+        MultiplicativeSieve::forEachSegment(0, 100, MultiplicativeSieve::PHI, [&](const MultiplicativeSieve& seg) {
+            checkSegment(seg, sieve, MultiplicativeSieve::PHI);
+        });
+
+        // near INT_MAX
+        const int hi = 0x7fffffff, lo = hi - 1000;
+        int total = 0;
+        MultiplicativeSieve::forEachSegment(lo, hi, MultiplicativeSieve::MIN_FACTOR | MultiplicativeSieve::MU, [&](const MultiplicativeSieve& seg) {
+            for (int i = 0; i < seg.size; i++) {
+                int x = seg.first + i;
+                int p = 2;
+                while (1ll * p * p <= x && x % p != 0)
+                    p++;
+                if (1ll * p * p > x)
+                    p = x;
+                assert(seg.minFactor[i] == p);
+                assert((p == x) == (find(seg.primes.begin(), seg.primes.end(), x) != seg.primes.end()));
+            }
+            total += seg.size;
+        }, 300);
+        assert(total == hi - lo + 1);
+    }
+    cout << "OK!" << endl;
+
+    cout << "*** Speed test ***" << endl;
+    {
+        // 10^8 in the original measurement, it's reduced to run faster
+        const int N = 20000000;
+        cout << "N = " << N << endl;
+
+        // separate sieves
+        PROFILE_START(0);
+        MinFactors minFactors(N);
+        auto mu = mobiusSeive(N, minFactors);
+        auto phi = phiAll(N);
+        auto d = minFactors.getAllFactorCount();
+        PROFILE_STOP(0);
+
+        PROFILE_START(1);
+        MultiplicativeSieve sieve(N, MultiplicativeSieve::ALL & ~MultiplicativeSieve::DIVISOR_SUM);
+        PROFILE_STOP(1);
+
+        long long sum = 0;
+        PROFILE_START(2);
+        MultiplicativeSieve::forEachSegment(0, N, MultiplicativeSieve::ALL & ~MultiplicativeSieve::DIVISOR_SUM,
+            [&sum](const MultiplicativeSieve& seg) {
+                for (int i = 0; i < seg.size; i++)
+                    sum += seg.phi[i];
+            });
+        PROFILE_STOP(2);
+
+        assert(sieve.minFactor == minFactors.minFactors && sieve.mu == mu && sieve.phi == phi && sieve.divisorCount == d);
+        assert(sum == accumulate(phi.begin(), phi.end(), 0ll));
+    }
+}
@@ -0,0 +1,225 @@
+#pragma once
+
+#include <cmath>
+#include <algorithm>
+
+#include "primeNumberEratosthenes.h"
+
+// Linear (Euler) sieve of multiplicative functions
+//   - every composite x = p * i is visited once with p = minFactor[x], so the functions of x come from i in O(1)
+//   - the functions are selected with flags, and all of them are filled in one pass
+//       MIN_FACTOR    : minFactor[x], the min prime factor (-1 for 0 and 1, same as MinFactors)
+//       PHI           : phi[x], Euler's totient function
+//       MU            : mu[x], Mobius function
+//       DIVISOR_COUNT : divisorCount[x], d(x)
+//       DIVISOR_SUM   : divisorSum[x], sigma(x) (it fits in 32 bits up to 7*10^8)
+//   - arrays are 32-bit, and minFactor is always filled because the sieve needs it
+//
+//   Segmented mode, forEachSegment(), keeps memory O(sqrt(hi) + segment size).
+//     it divides out primes <= sqrt(hi) from numbers of each segment, O(N loglogN)
+struct MultiplicativeSieve {
+    enum FunctionT {
+        MIN_FACTOR = 1,
+        PHI = 2,
+        MU = 4,
+        DIVISOR_COUNT = 8,
+        DIVISOR_SUM = 16,
+        ALL = 31
+    };
+
+    int first;                  // arrays are of [first, first + size)
+    int size;
+    vector<int> primes;         // primes in [first, first + size)
+    vector<int> minFactor;
+    vector<int> phi;
+    vector<int> mu;
+    vector<int> divisorCount;
+    vector<unsigned> divisorSum;
+
+    MultiplicativeSieve() : first(0), size(0) {
+    }
+
+    explicit MultiplicativeSieve(int n, int functions = ALL) {
+        build(n, functions);
+    }
+
+    // [0, n], O(N)
+    void build(int n, int functions = ALL) {
+        init(0, n + 1, functions);
+
+        // the power of the min prime factor, p^e
+        vector<int> minPow;
+        if (functions & DIVISOR_SUM)
+            minPow.resize(size);
+        // the exponent of the min prime factor
+        vector<unsigned char> minExp;
+        if (functions & DIVISOR_COUNT)
+            minExp.resize(size);
+
+        for (int i = 2; i < size; i++) {
+            if (minFactor[i] == 0) {
+                minFactor[i] = i;
+                primes.push_back(i);
+                if (functions & PHI)
+                    phi[i] = i - 1;
+                if (functions & MU)
+                    mu[i] = -1;
+                if (functions & DIVISOR_COUNT) {
+                    divisorCount[i] = 2;
+                    minExp[i] = 1;
+                }
+                if (functions & DIVISOR_SUM) {
+                    divisorSum[i] = unsigned(i) + 1;
+                    minPow[i] = i;
+                }
+            }
+
+            int lp = minFactor[i];
+            int maxP = min(lp, (size - 1) / i);
+            for (int k = 0; k < int(primes.size()) && primes[k] <= maxP; k++) {
+                int p = primes[k];
+                int x = i * p;
+                minFactor[x] = p;
+                if (p < lp) {
+                    // p doesn't divide i
+                    if (functions & PHI)
+                        phi[x] = phi[i] * (p - 1);
+                    if (functions & MU)
+                        mu[x] = -mu[i];
+                    if (functions & DIVISOR_COUNT) {
+                        divisorCount[x] = divisorCount[i] * 2;
+                        minExp[x] = 1;
+                    }
+                    if (functions & DIVISOR_SUM) {
+                        divisorSum[x] = divisorSum[i] * unsigned(p + 1);
+                        minPow[x] = p;
+                    }
+                } else {
+                    // x = p^(e+1) * m, i = p^e * m
+                    if (functions & PHI)
+                        phi[x] = phi[i] * p;
+                    if (functions & MU)
+                        mu[x] = 0;
+                    if (functions & DIVISOR_COUNT) {
+                        int e = minExp[i];
+                        divisorCount[x] = divisorCount[i] / (e + 1) * (e + 2);
+                        minExp[x] = (unsigned char)(e + 1);
+                    }
+                    if (functions & DIVISOR_SUM) {
+                        // sigma(x) = sigma(m) * (p^(e+2) - 1) / (p - 1)
+                        int pe = minPow[i];
+                        int m = i / pe;
+                        minPow[x] = pe * p;
+                        divisorSum[x] = divisorSum[m] * unsigned((1ll * pe * p * p - 1) / (p - 1));
+                    }
+                }
+            }
+        }
+    }
+
+    bool isPrimeNumber(int x) const {
+        return x >= 2 && minFactor[x - first] == x;
+    }
+
+    // f(sieve) for segments of [lo, hi], the arrays of 'sieve' are of [sieve.first, sieve.first + sieve.size)
+    // O(N loglogN), memory O(sqrt(hi) + segmentSize)
+    template <typename FuncT>
+    static void forEachSegment(int lo, int hi, int functions, const FuncT& f, int segmentSize = 1 << 18) {
+        int root = int(sqrt(hi));
+        while (1ll * root * root > hi)
+            root--;
+        while (1ll * (root + 1) * (root + 1) <= hi)
+            root++;
+        vector<int> base = (root >= 2) ? eratosthenes2(root) : vector<int>();
+
+        MultiplicativeSieve sieve;
+        vector<int> rest;
+        for (long long L = lo; L <= hi; L += segmentSize) {
+            int R = int(min<long long>(hi, L + segmentSize - 1));
+            sieve.buildSegment(int(L), R, functions, base, rest);
+            f(sieve);
+        }
+    }
+
+private:
+    void init(int lo, int n, int functions) {
+        first = lo;
+        size = n;
+        primes.clear();
+        minFactor.assign(n, 0);
+        phi.assign((functions & PHI) ? n : 0, 1);
+        mu.assign((functions & MU) ? n : 0, 1);
+        divisorCount.assign((functions & DIVISOR_COUNT) ? n : 0, 1);
+        divisorSum.assign((functions & DIVISOR_SUM) ? n : 0, 1);
+
+        // 0 and 1
+        for (int x = lo; x - lo < n && x <= 1; x++) {
+            minFactor[x - lo] = -1;
+            if (x == 0) {
+                if (functions & PHI)
+                    phi[0] = 0;
+                if (functions & MU)
+                    mu[0] = 0;
+                if (functions & DIVISOR_COUNT)
+                    divisorCount[0] = 0;
+                if (functions & DIVISOR_SUM)
+                    divisorSum[0] = 0;
+            }
+        }
+    }
+
+    // [lo, hi], 'base' has all primes <= sqrt(hi)
+    void buildSegment(int lo, int hi, int functions, const vector<int>& base, vector<int>& rest) {
+        int n = hi - lo + 1;
+        init(lo, n, functions);
+
+        rest.resize(n);
+        for (int i = 0; i < n; i++)
+            rest[i] = lo + i;
+
+        for (int p : base) {
+            long long start = max(2ll, (1ll * lo + p - 1) / p) * p;
+            for (long long x = start; x <= hi; x += p) {
+                int i = int(x - lo);
+                int e = 0;
+                long long pe = 1, sum = 1;
+                do {
+                    rest[i] /= p;
+                    e++;
+                    pe *= p;
+                    sum += pe;
+                } while (rest[i] % p == 0);
+
+                apply(i, p, e, pe, sum, functions);
+            }
+            // p itself
+            if (lo <= p && p <= hi) {
+                apply(p - lo, p, 1, p, p + 1, functions);
+                rest[p - lo] = 1;
+            }
+        }
+
+        for (int i = 0; i < n; i++) {
+            if (rest[i] > 1) {
+                int q = rest[i];
+                apply(i, q, 1, q, 1ll * q + 1, functions);
+            }
+            if (minFactor[i] == lo + i)
+                primes.push_back(lo + i);
+        }
+    }
+
+    // multiplies the factor p^e of the number at i
+    void apply(int i, int p, int e, long long pe, long long sum, int functions) {
+        if (minFactor[i] == 0)
+            minFactor[i] = p;
+        if (functions & PHI)
+            phi[i] *= int(pe / p * (p - 1));
+        if (functions & MU)
+            mu[i] = (e > 1) ? 0 : -mu[i];
+        if (functions & DIVISOR_COUNT)
+            divisorCount[i] *= e + 1;
+        if (functions & DIVISOR_SUM)
+            divisorSum[i] *= unsigned(sum);
+    }
+};
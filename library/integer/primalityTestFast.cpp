@@ -20,6 +20,7 @@ using namespace std;
 
 #include "primalityTest.h"
 #include "primeNumberBasic.h"
+#include "primalityTestInt64.h"
 
 template <typename T>
 inline bool isPrimeNumberSlow(T x) {
@@ -88,6 +89,26 @@ void testPrimalityTestFast() {
             assert(ans == gt);
         }
     }
+    {
+        vector<unsigned long long> in{ 0, 1, 2, 3, 4, 5, 9, 121, 341, 561, 2047, 3215031751ull, 2152302898747ull,
+                                       3474749660383ull, 341550071728321ull, 3825123056546413051ull,
+                                       18446744073709551557ull, 18446744073709551615ull, 4294967291ull * 4294967279ull };
+        for (int i = 0; i < 1000; i++)
+            in.push_back(RandUInt32::get());
+        for (int i = 0; i < 1000; i++)
+            in.push_back(RandUInt64::get() >> (RandInt32::get() % 64));
+        for (int i = 0; i < 1000; i++)
+            in.push_back(RandUInt64::get() | 1);
+
+        vector<bool> res;
+        FastPrimalityTest<unsigned long long>::isPrimeBatch(in, res);
+        for (int i = 0; i < int(in.size()); i++) {
+            auto gt = PrimalityTestInt64::isPrimeNumber(in[i]);
+            if (res[i] != gt)
+                cout << "Mismatch in [" << in[i] << "] : " << res[i] << ", " << gt << endl;
+            assert(res[i] == gt);
+        }
+    }
     cout << "*** Speed Test" << endl;
     {
         int T = 10000;
@@ -112,5 +133,33 @@ void testPrimalityTestFast() {
             cout << "Mismatch : " << cnt1 << ", " << cnt2 << endl;
         assert(cnt1 == cnt2);
     }
+    cout << "*** Throughput of isPrimeBatch()" << endl;
+    {
+        int T = 1000000;
+
+        // isPrimeNumber() works for x < 2^62
+        for (int bits = 32; bits <= 62; bits += 30) {
+            vector<unsigned long long> in(T);
+            for (int i = 0; i < T; i++)
+                in[i] = (RandUInt64::get() >> (64 - bits)) | 1ull;
+
+            cout << bits << "-bit odd numbers : isPrimeNumber(), isPrimeBatch()" << endl;
+            int cnt1 = 0;
+            PROFILE_START(0);
+            for (int i = 0; i < T; i++)
+                cnt1 += FastPrimalityTest<unsigned long long>::isPrimeNumber(in[i]);
+            PROFILE_STOP(0);
+
+            unique_ptr<bool[]> res(new bool[T]);
+            PROFILE_START(1);
+            FastPrimalityTest<unsigned long long>::isPrimeBatch(in.data(), in.size(), res.get());
+            PROFILE_STOP(1);
+            int cnt2 = int(count(res.get(), res.get() + T, true));
+
+            if (cnt1 != cnt2)
+                cout << "Mismatch : " << cnt1 << ", " << cnt2 << endl;
+            assert(cnt1 == cnt2);
+        }
+    }
     cout << "OK!" << endl;
 }
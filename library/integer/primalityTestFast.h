@@ -1,6 +1,10 @@
 #pragma once
 
-// 0 < x < 2^62 (~ 4.6 * 10^18)
+#include <memory>
+#include "montgomeryInt64.h"
+
+// isPrimeNumber() : 0 < x < 2^62 (~ 4.6 * 10^18)
+// isPrimeBatch()  : 0 <= x < 2^64, with Montgomery multiplication
 template <typename T>
 struct FastPrimalityTest {
     static bool isPrimeNumber(T x) {
@@ -16,7 +20,7 @@ struct FastPrimalityTest {
             d /= 2;
 
         // "Fast Primality Testing for Integers That Fit into a Machine Word"
-        int alist[]{ 2, 325, 9375, 28178, 450775, 9780504, 1795265022 };
+        static const T alist[]{ 2, 325, 9375, 28178, 450775, 9780504, 1795265022 };
         for (auto a : alist) {
             if (x <= a)
                 break;
@@ -34,6 +38,49 @@ struct FastPrimalityTest {
         return true;
     }
 
+    // res[i] = isPrimeNumber(values[i]), 0 <= values[i] < 2^64
+    //   the same tests with Montgomery multiplication, and MillerRabinInt64::LANES numbers are tested in lock step
+    static void isPrimeBatch(const unsigned long long* values, size_t count, bool* res) {
+        vector<size_t> index;
+        vector<unsigned long long> n;
+        for (size_t i = 0; i < count; i++) {
+            unsigned long long x = values[i];
+            if (x <= 2 || (x & 1) == 0) {
+                res[i] = (x == 2);
+            } else {
+                res[i] = true;
+                index.push_back(i);
+                n.push_back(x);
+            }
+        }
+
+        static const unsigned long long alist[]{ 2, 325, 9375, 28178, 450775, 9780504, 1795265022 };
+        vector<unsigned long long> a;
+        for (auto base : alist) {
+            // numbers <= base passed all tests
+            size_t m = 0;
+            for (size_t j = 0; j < n.size(); j++) {
+                if (n[j] > base) {
+                    index[m] = index[j];
+                    n[m++] = n[j];
+                }
+            }
+            index.resize(m);
+            n.resize(m);
+            if (m == 0)
+                break;
+
+            a.assign(m, base);
+            MillerRabinInt64::filter(index, n, a, res);
+        }
+    }
+
+    static void isPrimeBatch(const vector<unsigned long long>& values, vector<bool>& res) {
+        unique_ptr<bool[]> t(new bool[values.size()]);
+        isPrimeBatch(values.data(), values.size(), t.get());
+        res.assign(t.get(), t.get() + values.size());
+    }
+
 private:
     static T mulMod(T a, T b, T M) {
 #ifndef __GNUC__
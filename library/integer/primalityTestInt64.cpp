@@ -78,6 +78,26 @@ void testPrimalityTestInt64() {
             assert(ans == gt);
         }
     }
+    {
+        vector<unsigned long long> in{ 0, 1, 2, 3, 4, 5, 9, 121, 341, 561, 2047, 3215031751ull, 2152302898747ull,
+                                       3474749660383ull, 341550071728321ull, 3825123056546413051ull,
+                                       18446744073709551557ull, 18446744073709551615ull, 4294967291ull * 4294967279ull };
+        for (int i = 0; i < 1000; i++)
+            in.push_back(RandUInt32::get());
+        for (int i = 0; i < 1000; i++)
+            in.push_back(RandUInt64::get() >> (RandInt32::get() % 64));
+        for (int i = 0; i < 1000; i++)
+            in.push_back(RandUInt64::get() | 1);
+
+        vector<bool> res;
+        PrimalityTestInt64::isPrimeBatch(in, res);
+        for (int i = 0; i < int(in.size()); i++) {
+            auto gt = PrimalityTestInt64::isPrimeNumber(in[i]);
+            if (res[i] != gt)
+                cout << "Mismatch in [" << in[i] << "] : " << res[i] << ", " << gt << endl;
+            assert(res[i] == gt);
+        }
+    }
     cout << "*** Speed Test" << endl;
     {
         int T = 10000;
@@ -108,5 +128,32 @@ void testPrimalityTestInt64() {
             cout << "Mismatch : " << cnt1 << ", " << cnt2 << ", " << cnt3 << endl;
         assert(cnt1 == cnt2 && cnt1 == cnt3);
     }
+    cout << "*** Throughput of isPrimeBatch()" << endl;
+    {
+        int T = 1000000;
+
+        for (int bits = 32; bits <= 64; bits += 32) {
+            vector<unsigned long long> in(T);
+            for (int i = 0; i < T; i++)
+                in[i] = (bits == 32) ? RandUInt32::get() | 1u : RandUInt64::get() | 1ull;
+
+            cout << bits << "-bit odd numbers : isPrimeNumber(), isPrimeBatch()" << endl;
+            int cnt1 = 0;
+            PROFILE_START(0);
+            for (int i = 0; i < T; i++)
+                cnt1 += PrimalityTestInt64::isPrimeNumber(in[i]);
+            PROFILE_STOP(0);
+
+            unique_ptr<bool[]> res(new bool[T]);
+            PROFILE_START(1);
+            PrimalityTestInt64::isPrimeBatch(in.data(), in.size(), res.get());
+            PROFILE_STOP(1);
+            int cnt2 = int(count(res.get(), res.get() + T, true));
+
+            if (cnt1 != cnt2)
+                cout << "Mismatch : " << cnt1 << ", " << cnt2 << endl;
+            assert(cnt1 == cnt2);
+        }
+    }
     cout << "OK!" << endl;
 }
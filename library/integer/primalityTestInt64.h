@@ -1,5 +1,8 @@
 #pragma once
 
+#include <memory>
+#include "montgomeryInt64.h"
+
 // "Fast Primality Testing for Integers That Fit into a Machine Word"
 // https://people.ksp.sk/~misof/primes/FJ64_16k.cc
 struct PrimalityTestInt64 {
@@ -14,11 +17,7 @@ struct PrimalityTestInt64 {
         if (!isSPRP(x, 2))
             return false;
 
-        unsigned long long h = x;
-        h = ((h >> 32) ^ h) * 0x45d9f3b3335b369ull;
-        h = ((h >> 32) ^ h) * 0x3335b36945d9f3bull;
-        h = ((h >> 32) ^ h);
-        unsigned int b = getBase(static_cast<unsigned int>(h & 16383));
+        unsigned int b = hashBase(x);
         return isSPRP(x, b & 4095) && isSPRP(x, b >> 12);
     }
 
@@ -26,7 +25,52 @@ struct PrimalityTestInt64 {
         return isPrimeNumber(static_cast<unsigned long long>(x));
     }
 
+    // res[i] = isPrimeNumber(values[i])
+    //   the same tests with Montgomery multiplication, and MillerRabinInt64::LANES numbers are tested in lock step
+    static void isPrimeBatch(const unsigned long long* values, size_t count, bool* res) {
+        vector<size_t> index;
+        vector<unsigned long long> n, a;
+        for (size_t i = 0; i < count; i++) {
+            unsigned long long x = values[i];
+            if (x == 2 || x == 3 || x == 5 || x == 7)
+                res[i] = true;
+            else if (x % 2 == 0 || x % 3 == 0 || x % 5 == 0 || x % 7 == 0)
+                res[i] = false;
+            else if (x < 121)
+                res[i] = (x > 1);
+            else {
+                index.push_back(i);
+                n.push_back(x);
+                a.push_back(2);
+            }
+        }
+
+        MillerRabinInt64::filter(index, n, a, res);
+
+        for (size_t j = 0; j < n.size(); j++)
+            a[j] = hashBase(n[j]) & 4095;
+        MillerRabinInt64::filter(index, n, a, res);
+
+        for (size_t j = 0; j < n.size(); j++)
+            a[j] = hashBase(n[j]) >> 12;
+        MillerRabinInt64::filter(index, n, a, res);
+    }
+
+    static void isPrimeBatch(const vector<unsigned long long>& values, vector<bool>& res) {
+        unique_ptr<bool[]> t(new bool[values.size()]);
+        isPrimeBatch(values.data(), values.size(), t.get());
+        res.assign(t.get(), t.get() + values.size());
+    }
+
 private:
+    static unsigned int hashBase(unsigned long long x) {
+        unsigned long long h = x;
+        h = ((h >> 32) ^ h) * 0x45d9f3b3335b369ull;
+        h = ((h >> 32) ^ h) * 0x3335b36945d9f3bull;
+        h = ((h >> 32) ^ h);
+        return getBase(static_cast<unsigned int>(h & 16383));
+    }
+
     static unsigned int getBase(unsigned int h) {
         static unsigned int bases[] = {
             2404423, 3027617, 3715179, 3264583, 1593555, 5853461, 1552463, 1896881, 2904107, 5600043,
@@ -0,0 +1,153 @@
+#include <cmath>
+#include <numeric>
+#include <vector>
+#include <algorithm>
+
+using namespace std;
+
+#include "primeCounting.h"
+#include "multiplicativeSieve.h"
+
+/////////// For Testing ///////////////////////////////////////////////////////
+
+#include <time.h>
+#include <cassert>
+#include <string>
+#include <iostream>
+#include "../common/iostreamhelper.h"
+#include "../common/profile.h"
+#include "../common/rand.h"
+
+namespace {
+const int MOD = 1000000007;
+
+// the previous way, pi(n) with a full sieve
+long long countPrimesBySieve(int n) {
+    auto p = eratosthenes(n);
+    return count(p.begin(), p.end(), true);
+}
+}
+
+void testPrimeCounting() {
+    return; //TODO: if you want to test, make this line a comment.
+
+    cout << "--- Prime Counting ----------------------------------" << endl;
+    {
+        const int N = 1000000;
+        MultiplicativeSieve sieve(N);
+
+        vector<long long> pi(N + 1), sum1(N + 1), sum2Mod(N + 1);
+        for (int x = 1; x <= N; x++) {
+            bool prime = sieve.isPrimeNumber(x);
+            pi[x] = pi[x - 1] + prime;
+            sum1[x] = sum1[x - 1] + (prime ? x : 0);
+            sum2Mod[x] = (sum2Mod[x - 1] + (prime ? 1ll * x * x % MOD : 0)) % MOD;
+        }
+
+        for (int n = 0; n <= 3000; n++)
+            assert(PrimeCounting::countPrimes(n) == pi[n]);
+        for (int i = 0; i < 200; i++) {
+            int n = RandInt32::get() % N + 1;
+            assert(PrimeCounting::countPrimes(n) == pi[n]);
+
+            PrimePowerSumTable<long long> t0(n, 0), t1(n, 1);
+            PrimePowerSumTable<long long, MOD> t2(n, 2);
+            for (long long d = 1; d <= n; d = n / (n / d) + 1) {
+                long long v = n / d;
+                assert(t0.get(v) == pi[v]);
+                assert(t1.get(v) == sum1[v]);
+                assert(t2.get(v) == sum2Mod[v]);
+            }
+        }
+
+        // prefix sums of multiplicative functions
+        vector<long long> sumPhi(N + 1), sumMu(N + 1), sumD(N + 1), sumSigma(N + 1);
+        for (int x = 1; x <= N; x++) {
+            sumPhi[x] = sumPhi[x - 1] + sieve.phi[x];
+            sumMu[x] = sumMu[x - 1] + sieve.mu[x];
+            sumD[x] = sumD[x - 1] + sieve.divisorCount[x];
+            sumSigma[x] = (sumSigma[x - 1] + sieve.divisorSum[x]) % MOD;
+        }
+        for (int i = 0; i < 100; i++) {
+            int n = (i < 20) ? i : RandInt32::get() % N + 1;
+            auto phi = Min25Sieve<long long>::prefixSum(n, { -1, 1 }, [](long long p, int, long long pe) {
+                return pe - pe / p;
+            });
+            auto mu = Min25Sieve<long long>::prefixSum(n, { -1 }, [](long long, int e, long long) {
+                return e == 1 ? -1ll : 0ll;
+            });
+            auto d = Min25Sieve<long long>::prefixSum(n, { 2 }, [](long long, int e, long long) {
+                return (long long)e + 1;
+            });
+            auto sigma = Min25Sieve<long long, MOD>::prefixSum(n, { 1, 1 }, [](long long p, int, long long pe) {
+                return (pe * p - 1) / (p - 1) % MOD;
+            });
+            assert(phi == sumPhi[n]);
+            assert(mu == sumMu[n]);
+            assert(d == sumD[n]);
+            assert(sigma == sumSigma[n]);
+        }
+    }
+    {
+        long long gt[] = { 0, 4, 25, 168, 1229, 9592, 78498, 664579, 5761455, 50847534, 455052511, 4118054813ll,
+                           37607912018ll };
+        long long n = 1;
+        for (int k = 0; k <= 12; k++, n *= 10)
+            assert(PrimeCounting::countPrimes(n) == gt[k]);
+
+        // sums of primes
+        assert(PrimePowerSumTable<long long>(1000000000, 1).get(1000000000) == 24739512092254535ll);
+        // the sums and the intermediate values of 10^10 overflow 64-bit integers
+        assert(PrimePowerSumTable<__int128_t>(10000000000ll, 1).get(10000000000ll) == __int128_t(2220822432581729238ll));
+
+        // Mertens function
+        assert(Min25Sieve<long long>::prefixSum(1000000000, { -1 }, [](long long, int e, long long) {
+            return e == 1 ? -1ll : 0ll;
+        }) == -222);
+    }
+    cout << "OK!" << endl;
+
+    cout << "*** Speed test ***" << endl;
+    {
+        const int N = 200000000;
+        cout << "pi(" << N << ")" << endl;
+
+        PROFILE_START(0);
+        long long ans0 = countPrimesBySieve(N);
+        PROFILE_STOP(0);
+
+        PROFILE_START(1);
+        long long ans1 = PrimeCounting::countPrimes(N);
+        PROFILE_STOP(1);
+
+        PROFILE_START(2);
+        long long ans2 = PrimePowerSumTable<long long>(N, 0).get(N);
+        PROFILE_STOP(2);
+
+        assert(ans0 == ans1 && ans1 == ans2);
+    }
+    {
+        long long n = 10000000000000ll;
+        cout << "pi(" << n << ")" << endl;
+
+        PROFILE_START(0);
+        long long ans = PrimeCounting::countPrimes(n);
+        PROFILE_STOP(0);
+        assert(ans == 346065536839ll);
+    }
+    {
+        long long n = 100000000000ll;
+        cout << "the sum of primes <= " << n << " mod " << MOD << endl;
+
+        PROFILE_START(0);
+        auto ans = PrimePowerSumTable<long long, MOD>(n, 1).get(n);
+        PROFILE_STOP(0);
+
+        PROFILE_START(1);
+        auto sumPhi = Min25Sieve<long long, MOD>::prefixSum(n, { MOD - 1, 1 }, [](long long p, int, long long pe) {
+            return (pe - pe / p) % MOD;
+        });
+        PROFILE_STOP(1);
+        cout << ans << ", SUM phi(i) mod " << MOD << " = " << sumPhi << endl;
+    }
+}
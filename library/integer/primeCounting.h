@@ -0,0 +1,320 @@
+#pragma once
+
+#include <cmath>
+#include <algorithm>
+
+#include "primeNumberEratosthenes.h"
+#include "primeFactor.h"
+
+// Sublinear prime counting and prime sums
+//
+//   1) PrimeCounting::countPrimes(n) : pi(n)
+//      - Lucy_Hedgehog's recurrence on odd numbers only, and only for primes p <= n^(1/4),
+//        the rest (primes in (n^(1/4), n^(1/2)]) is added with a Meissel-like formula
+//      - rough numbers (not sieved yet) are compacted in every step, pi(10^13) takes about 0.75s
+//
+//   2) PrimePowerSumTable<T, mod> : S(v) = SUM p^k for all v = n / i, O(n^(3/4) / log(n))
+//                                       p <= v
+//      - Lucy_Hedgehog's recurrence, S(v, p) = S(v, p-1) - p^k * (S(v/p, p-1) - S(p-1, p-1))
+//      - k = 0 (pi(v)), 1 (sums of primes), 2, 3
+//
+//   3) Min25Sieve<T, mod>::prefixSum(n, ...) : SUM f(i) for a multiplicative function f, O(n^(3/4) / log(n))
+//                                             i <= n
+//      - f(p) must be a polynomial of p, and f(p^e) is given by a function
+//
+//   - mod == 0 : exact arithmetic of T, use a 128-bit T for sums of primes over 10^9
+//     mod > 0  : modulo 'mod' (mod < 2^31) with 64-bit T
+
+struct PrimeCounting {
+    // pi(n), the number of primes <= n
+    static long long countPrimes(long long n) {
+        if (n <= 1)
+            return 0;
+        if (n == 2)
+            return 1;
+
+        const int v = isqrt(n);
+        int s = (v + 1) / 2;
+
+        // smalls[i] : the number of odd numbers in [3, 2i+1] which are primes or not sieved yet
+        // roughs[k] : the k-th odd number which is not sieved yet, roughs[0] = 1
+        // larges[k] : the number of odd numbers in [3, n / roughs[k]] which are primes or not sieved yet
+        vector<int> smalls(s), roughs(s);
+        vector<long long> larges(s);
+        for (int i = 0; i < s; i++) {
+            smalls[i] = i;
+            roughs[i] = 2 * i + 1;
+            larges[i] = (n / (2 * i + 1) - 1) / 2;
+        }
+
+        vector<bool> skip(v + 1);
+        int pc = 0;
+        for (int p = 3; p <= v; p += 2) {
+            if (skip[p])
+                continue;
+
+            int q = p * p;
+            if (1ll * q * q > n)
+                break;
+
+            skip[p] = true;
+            for (int i = q; i <= v; i += 2 * p)
+                skip[i] = true;
+
+            int ns = 0;
+            for (int k = 0; k < s; k++) {
+                int i = roughs[k];
+                if (skip[i])
+                    continue;
+
+                long long d = 1ll * i * p;
+                larges[ns] = larges[k] - (d <= v ? larges[smalls[d >> 1] - pc] : smalls[half(divide(n, d))]) + pc;
+                roughs[ns++] = i;
+            }
+            s = ns;
+
+            for (int i = half(v), j = ((v / p) - 1) | 1; j >= p; j -= 2) {
+                int c = smalls[j >> 1] - pc;
+                for (int e = (j * p) >> 1; i >= e; i--)
+                    smalls[i] -= c;
+            }
+            pc++;
+        }
+
+        // primes in (n^(1/4), n^(1/2)]
+        larges[0] += 1ll * (s + 2 * (pc - 1)) * (s - 1) / 2;
+        for (int k = 1; k < s; k++)
+            larges[0] -= larges[k];
+
+        for (int l = 1; l < s; l++) {
+            int q = roughs[l];
+            long long m = n / q;
+            int e = smalls[half(int(m / q))] - pc;
+            if (e < l + 1)
+                break;
+
+            long long t = 0;
+            for (int k = l + 1; k <= e; k++)
+                t += smalls[half(divide(m, roughs[k]))];
+            larges[0] += t - 1ll * (e - l) * (pc + l - 1);
+        }
+
+        // + 2
+        return larges[0] + 1;
+    }
+
+    static int isqrt(long long n) {
+        long long r = (long long)sqrtl((long double)n);
+        while (r * r > n)
+            r--;
+        while ((r + 1) * (r + 1) <= n)
+            r++;
+        return int(r);
+    }
+
+private:
+    static int divide(long long n, long long d) {
+        return int(double(n) / d);
+    }
+
+    static int half(int n) {
+        return (n - 1) >> 1;
+    }
+};
+
+template <typename T, int mod = 0>
+struct PrimePowerSumTable {
+    long long n;
+    int root;
+    int k;
+    vector<T> lo;               // lo[v] = S(v), v <= root
+    vector<T> hi;               // hi[i] = S(n / i), i <= root
+
+    PrimePowerSumTable() : n(0), root(0), k(0) {
+    }
+
+    PrimePowerSumTable(long long n, int k) {
+        build(n, k);
+    }
+
+    // 0 <= k <= 3
+    void build(long long n, int k) {
+        this->n = n;
+        this->k = k;
+        root = PrimeCounting::isqrt(n);
+        lo.assign(root + 1, T(0));
+        hi.assign(root + 1, T(0));
+        for (int v = 1; v <= root; v++)
+            lo[v] = powerPrefixSum(v, k);
+        for (int i = 1; i <= root; i++)
+            hi[i] = powerPrefixSum(n / i, k);
+
+        vector<bool> isPrime = eratosthenes(max(root, 1));
+        for (int p = 2; p <= root; p++) {
+            if (!isPrime[p])
+                continue;
+
+            T sp = lo[p - 1];
+            T pk = power(p, k);
+            long long p2 = 1ll * p * p;
+
+            int lim = int(min<long long>(root, n / p2));
+            long long np = n / p;
+            for (int i = 1; i <= lim; i++) {
+                long long d = 1ll * i * p;
+                T s = (d <= root) ? hi[d] : lo[np / i];
+                hi[i] = sub(hi[i], mul(pk, sub(s, sp)));
+            }
+            for (long long v = root; v >= p2; v--)
+                lo[v] = sub(lo[v], mul(pk, sub(lo[v / p], sp)));
+        }
+    }
+
+    // S(v), v must be n / i for an integer i
+    T get(long long v) const {
+        return (v <= root) ? lo[v] : hi[n / v];
+    }
+
+    //--- arithmetic
+
+    static T fromLL(long long x) {
+        if (mod == 0)
+            return T(x);
+        return T(x % (mod == 0 ? 1 : mod));
+    }
+
+    static T add(T a, T b) {
+        if (mod == 0)
+            return a + b;
+        T r = a + b;
+        return (r >= mod) ? r - mod : r;
+    }
+
+    static T sub(T a, T b) {
+        if (mod == 0)
+            return a - b;
+        T r = a - b;
+        return (r < 0) ? r + mod : r;
+    }
+
+    static T mul(T a, T b) {
+        if (mod == 0)
+            return a * b;
+        return T((long long)a * b % (mod == 0 ? 1 : mod));
+    }
+
+    static T power(long long x, int k) {
+        T res = fromLL(1);
+        T t = fromLL(x);
+        for (int i = 0; i < k; i++)
+            res = mul(res, t);
+        return res;
+    }
+
+    // SUM x^k, 2 <= x <= v
+    static T powerPrefixSum(long long v, int k) {
+        long long a = v, b = v + 1;
+        if (a % 2 == 0)
+            a /= 2;
+        else
+            b /= 2;
+
+        switch (k) {
+        case 0:
+            return fromLL(v - 1);
+        case 1:
+            // v(v+1)/2
+            return sub(mul(fromLL(a), fromLL(b)), fromLL(1));
+        case 2: {
+            // v(v+1)(2v+1)/6
+            long long c = 2 * v + 1;
+            if (a % 3 == 0)
+                a /= 3;
+            else if (b % 3 == 0)
+                b /= 3;
+            else
+                c /= 3;
+            return sub(mul(mul(fromLL(a), fromLL(b)), fromLL(c)), fromLL(1));
+        }
+        default: {
+            // (v(v+1)/2)^2
+            T t = mul(fromLL(a), fromLL(b));
+            return sub(mul(t, t), fromLL(1));
+        }
+        }
+    }
+};
+
+// F(n) = SUM f(i), f is multiplicative
+//       i <= n
+//   coef : f(p) = coef[0] + coef[1] * p + coef[2] * p^2 + ..., for primes p (up to p^3)
+//   fpe  : T fpe(long long p, int e, long long pe), f(p^e) where pe = p^e
+template <typename T, int mod = 0>
+struct Min25Sieve {
+    typedef PrimePowerSumTable<T, mod> TableT;
+
+    template <typename FuncT>
+    static T prefixSum(long long n, const vector<T>& coef, const FuncT& fpe) {
+        if (n <= 0)
+            return T(0);
+
+        Min25Sieve<T, mod> sieve(n, coef);
+        return TableT::add(sieve.sum(n, 0, fpe), TableT::fromLL(1));
+    }
+
+    // the sum of f(p) for primes p <= v, v = n / i
+    T primeSum(long long v) const {
+        T res = T(0);
+        for (int j = 0; j < int(coef.size()); j++)
+            res = TableT::add(res, TableT::mul(coef[j], tables[j].get(v)));
+        return res;
+    }
+
+private:
+    long long n;
+    vector<T> coef;
+    vector<TableT> tables;
+    vector<int> primes;             // primes <= sqrt(n)
+    vector<T> primeSumPrefix;       // primeSumPrefix[j] = SUM f(primes[i]), i < j
+
+    Min25Sieve(long long n, const vector<T>& coef) : n(n), coef(coef), tables(coef.size()) {
+        for (int j = 0; j < int(coef.size()); j++)
+            tables[j].build(n, j);
+
+        int root = PrimeCounting::isqrt(n);
+        MinFactors minFactors(max(root, 1));
+        primeSumPrefix.push_back(T(0));
+        for (int p = 2; p <= root; p++) {
+            if (minFactors.isPrimeNumber(p)) {
+                primes.push_back(p);
+                T fp = T(0);
+                for (int j = int(coef.size()) - 1; j >= 0; j--)
+                    fp = TableT::add(TableT::mul(fp, TableT::fromLL(p)), coef[j]);
+                primeSumPrefix.push_back(TableT::add(primeSumPrefix.back(), fp));
+            }
+        }
+    }
+
+    // SUM f(i), 2 <= i <= v, the min prime factor of i >= primes[j]
+    template <typename FuncT>
+    T sum(long long v, int j, const FuncT& fpe) const {
+        if (j < int(primes.size()) && primes[j] > v)
+            return T(0);
+
+        // primes >= primes[j]
+        T res = TableT::sub(primeSum(v), primeSumPrefix[min(j, int(primes.size()))]);
+        if (j < int(primes.size()) && 1ll * primes[j] * primes[j] > v)
+            return res;
+
+        // composites
+        for (int i = j; i < int(primes.size()) && 1ll * primes[i] * primes[i] <= v; i++) {
+            long long p = primes[i];
+            long long pe = p;
+            for (int e = 1; pe * p <= v; e++, pe *= p) {
+                res = TableT::add(res, TableT::mul(fpe(p, e, pe), sum(v / pe, i + 1, fpe)));
+                res = TableT::add(res, fpe(p, e + 1, pe * p));
+            }
+        }
+        return res;
+    }
+};
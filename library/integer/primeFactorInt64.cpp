@@ -20,6 +20,7 @@ using namespace std;
 #include "../common/rand.h"
 
 #include "primalityTest.h"
+#include "primalityTestInt64.h"
 #include "primeNumberBasic.h"
 
 static bool isPrimeNumber(long long x, const vector<long long>& primes) {
@@ -33,6 +34,170 @@ static bool isPrimeNumber(long long x, const vector<long long>& primes) {
     return true;
 }
 
+// the previous implementation, for the speed test (mulMod with additions, Floyd's cycle detection)
+struct PrimeFactorizerInt64Old {
+    int N;
+    MinFactors minFactors;
+
+    void init(int n) {
+        N = n;
+        minFactors.build(N);
+    }
+
+    vector<pair<long long, int>> factorize(long long n) {
+        vector<pair<long long, int>> ans;
+        if (n <= 1)
+            return ans;
+
+        vector<long long> temp;
+        while (n % 2 == 0) {
+            temp.push_back(2);
+            n >>= 1;
+        }
+
+        int m = 0;
+        vector<long long> s(70);
+        pollardRho(n, m, s);
+        for (int i = 0; i < m; i++)
+            temp.push_back(s[i]);
+        sort(temp.begin(), temp.end());
+
+        for (int i = 0; i < int(temp.size()); ++i) {
+            int j = i, e = 0;
+            while (j < int(temp.size()) && temp[j] == temp[i]) {
+                e += 1;
+                j += 1;
+            }
+            ans.push_back({ temp[i], e });
+            i = j - 1;
+        }
+        return ans;
+    }
+
+private:
+    void pollardRho(long long n, int& m, vector<long long>& s) {
+        long long x;
+        if (n == 1)
+            return;
+
+        if (n <= N) {
+            while (n != 1) {
+                int p = minFactors.minFactors[int(n)];
+                while (n % p == 0) {
+                    n /= p;
+                    s[m++] = p;
+                }
+            }
+            return;
+        }
+
+        while (!millerRabin(n)) {
+            int c;
+            for (c = 1, x = n; x == n; c = 1 + randInt() % (n - 1))
+                x = go(n, c);
+            if (x < 0)
+                break;
+            n /= x;
+            pollardRho(x, m, s);
+        }
+        if (n > 1)
+            s[m++] = n;
+    }
+
+    bool millerRabin(long long n) {
+        if (n <= N)
+            return minFactors.minFactors[int(n)] == n;
+        return !witness(28087, n);
+    }
+
+    static long long func(long long x, long long n, int c) {
+        long long res = mulMod(x, x, n) + c;
+        return (res >= n ? res % n : res);
+    }
+
+    static long long go(long long n, int c) {
+        long long x, y, d = 1;
+        x = y = rand() & 0x7fff;
+        if (x >= n) {
+            x %= n;
+            y %= n;
+        }
+        while (d == 1) {
+            x = func(x, n, c);
+            y = func(func(y, n, c), n, c);
+            d = gcd(abs(y - x), n);
+        }
+        return d;
+    }
+
+    static int randInt() {
+        return (rand() & 0x7fff) * (rand() & 0x7fff);
+    }
+
+    static long long gcd(long long p, long long q) {
+        return q == 0 ? p : gcd(q, p % q);
+    }
+
+    static long long mulMod(long long a, long long b, long long M) {
+        long long x = 0, y = a % M;
+        while (b > 0) {
+            if (b & 1)
+                x = (x + y) % M;
+            y = (y << 1) % M;
+            b >>= 1;
+        }
+        return x % M;
+    }
+
+    static long long power(long long a, long long x, long long M) {
+        long long res = 1;
+        a = a % M;
+        while (x > 0) {
+            if (x & 1)
+                res = mulMod(res, a, M);
+            x >>= 1;
+            a = mulMod(a, a, M);
+        }
+        return res;
+    }
+
+    static bool witness(long long a, long long n) {
+        long long x, y, u = n - 1, t = 0;
+        while (u % 2 == 0) {
+            u >>= 1;
+            t += 1;
+        }
+        x = power(a, u, n);
+        while (t--) {
+            y = x;
+            x = power(x, 2, n);
+            if (x == 1 && y != 1 && y != n - 1)
+                return 1;
+        }
+        return x != 1;
+    }
+};
+
+template <typename T>
+static bool checkFactors(T x, const vector<pair<T, int>>& factors) {
+    unsigned long long prod = 1;
+    for (auto& it : factors) {
+        if (!PrimalityTestInt64::isPrimeNumber(static_cast<unsigned long long>(it.first)))
+            return false;
+        for (int i = 0; i < it.second; i++)
+            prod *= static_cast<unsigned long long>(it.first);
+    }
+    return prod == static_cast<unsigned long long>(x);
+}
+
+static unsigned long long randomPrime(int bits) {
+    while (true) {
+        unsigned long long x = (RandUInt64::get() >> (64 - bits)) | (1ull << (bits - 1)) | 1;
+        if (PrimalityTestInt64::isPrimeNumber(x))
+            return x;
+    }
+}
+
 void testPrimeFactorInt64() {
     return; //TODO: if you want to test, make this line a comment.
 
@@ -93,24 +258,114 @@ void testPrimeFactorInt64() {
             assert(gt == ans);
         }
     }
+    {
+        cout << "-- factorBatch() ---" << endl;
+
+        PrimeFactorizerInt64 pfLL;
+        pfLL.init(1000000);
+
+        vector<unsigned long long> in{ 0, 1, 2, 3, 4, 1024, 1021ull * 1021, 1031ull * 1031, 1031ull * 1033 * 1039,
+                                       18446744073709551615ull, 18446744073709551557ull,
+                                       4294967291ull * 4294967279ull, 4294967291ull * 4294967291ull,
+                                       1000000007ull * 1000000007ull * 7, 999999999999999989ull };
+        for (int i = 0; i < 300; i++)
+            in.push_back(RandUInt64::get());
+        for (int i = 0; i < 100; i++) {
+            int bits = 8 + RandInt32::get() % 25;
+            in.push_back(randomPrime(bits) * randomPrime(64 - bits));
+        }
+        for (int i = 0; i < 30; i++) {
+            unsigned long long p = randomPrime(21);
+            in.push_back(p * p * p);
+        }
+
+        auto res = pfLL.factorBatch(in);
+        for (int i = 0; i < int(in.size()); i++) {
+            if (in[i] <= 1) {
+                assert(res[i].empty());
+                continue;
+            }
+            bool ok = checkFactors(in[i], res[i]);
+            if (!ok)
+                cout << "Mismatch in [" << in[i] << "]" << endl;
+            assert(ok);
+
+            if (in[i] < (1ull << 63)) {
+                auto t = pfLL.factorize(static_cast<long long>(in[i]));
+                assert(t.size() == res[i].size());
+                for (int j = 0; j < int(t.size()); j++)
+                    assert(static_cast<unsigned long long>(t[j].first) == res[i][j].first && t[j].second == res[i][j].second);
+            }
+        }
+
+        PrimeFactorizerInt64 pf0;
+        for (int i = 0; i < 300; i++) {
+            unsigned long long x = RandUInt64::get() >> (RandInt32::get() % 64);
+            auto t = pf0.factorBatch(&x, 1);
+            if (x > 1)
+                assert(checkFactors(x, t[0]));
+        }
+    }
     // speed test
     {
         cout << "-- Speed Test ---" << endl;
 
         int N = 1000000;
+        PrimeFactorizerInt64Old pfOld;
+        pfOld.init(N);
         PrimeFactorizerInt64 pfLL;
         pfLL.init(N);
 
+#ifdef _DEBUG
         int T = 1000;
+#else
+        int T = 10000;
+#endif
+        vector<unsigned long long> in(T);
+        for (int i = 0; i < T; i++)
+            in[i] = RandInt64::get() + 1;
+
+        // semiprimes of two 31-bit primes, the worst case of Pollard's rho
+        vector<unsigned long long> semiprimes(T / 100);
+        for (auto& x : semiprimes)
+            x = randomPrime(31) * randomPrime(31);
 
+        cout << "random 63-bit numbers : factorize(), factorBatch()" << endl;
+        long long sum1 = 0, sum2 = 0;
         PROFILE_START(0);
-        while (T-- > 0) {
-            long long x = RandInt64::get() + 1;
-            auto t = pfLL.factorize(x);
-            if (x > 1 && t.empty())
-                cout << "ERROR!" << endl;
-        }
+        for (int i = 0; i < T; i++)
+            sum1 += int(pfLL.factorize(static_cast<long long>(in[i])).size());
         PROFILE_STOP(0);
+
+        PROFILE_START(1);
+        for (auto& f : pfLL.factorBatch(in))
+            sum2 += int(f.size());
+        PROFILE_STOP(1);
+        if (sum1 != sum2)
+            cout << "Mismatch : " << sum1 << ", " << sum2 << endl;
+        assert(sum1 == sum2);
+
+        // the old one is too slow for random numbers (it takes minutes for some numbers with large prime factors)
+        cout << "62-bit semiprimes : old, factorize(), factorBatch()" << endl;
+        long long sum0 = 0;
+        sum1 = sum2 = 0;
+        PROFILE_START(2);
+        for (auto x : semiprimes)
+            sum0 += int(pfOld.factorize(static_cast<long long>(x)).size());
+        PROFILE_STOP(2);
+
+        PROFILE_START(3);
+        for (auto x : semiprimes)
+            sum1 += int(pfLL.factorize(static_cast<long long>(x)).size());
+        PROFILE_STOP(3);
+
+        PROFILE_START(4);
+        for (auto& f : pfLL.factorBatch(semiprimes))
+            sum2 += int(f.size());
+        PROFILE_STOP(4);
+        if (sum0 != sum1 || sum1 != sum2)
+            cout << "Mismatch : " << sum0 << ", " << sum1 << ", " << sum2 << endl;
+        assert(sum1 == sum2);
     }
 
     cout << "OK!" << endl;
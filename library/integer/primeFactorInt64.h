@@ -1,11 +1,28 @@
 #pragma once
 
 #include "primeFactor.h"
+#include "montgomeryInt64.h"
 
+// Prime factorization of 64-bit integers
+//   1) trial division by primes < TRIAL_LIMIT, with multiplications by inverses (mod 2^64) instead of divisions
+//   2) a cofactor <= N is factorized with MinFactors, and a cofactor < TRIAL_LIMIT^2 is a prime
+//   3) deterministic Miller-Rabin test with 7 bases
+//   4) Pollard's rho with Brent's cycle detection, it takes one gcd per GCD_BATCH steps
+//   - all modular multiplications are Montgomery multiplications (see MontgomeryInt64)
+//   - factorBatch() runs Pollard's rho of LANES numbers in lock step,
+//     so the multiplications of different numbers overlap in the pipeline
 struct PrimeFactorizerInt64 {
+    static const int TRIAL_LIMIT = 1 << 10;
+    static const int LANES = 4;
+    static const int GCD_BATCH = 128;
+
     int N;
     MinFactors minFactors;
 
+    PrimeFactorizerInt64() : N(0) {
+        buildTrialDivisors();
+    }
+
     void init(int n) {
         N = n;
         minFactors.build(N);
@@ -13,152 +30,285 @@ struct PrimeFactorizerInt64 {
 
     vector<pair<long long, int>> factorize(long long n) {
         vector<pair<long long, int>> ans;
-
         if (n <= 1)
             return ans;
 
-        vector<long long> temp;
-        while (n % 2 == 0) {
-            temp.push_back(2);
-            n >>= 1;
-        }
-
-        int m = 0;
-        vector<long long> s(70);
+        unsigned long long x = static_cast<unsigned long long>(n);
+        auto res = factorBatch(&x, 1);
+        for (auto& it : res[0])
+            ans.emplace_back(static_cast<long long>(it.first), it.second);
+        return ans;
+    }
 
-        pollardRho(n, m, s);
-        for (int i = 0; i < m; i++) {
-            temp.push_back(s[i]);
+    // res[i] = { (p, e) }, prime factors of values[i] in ascending order (empty for 0 and 1)
+    vector<vector<pair<unsigned long long, int>>> factorBatch(const unsigned long long* values, int count) {
+        vector<vector<unsigned long long>> factors(count);
+        vector<pair<int, unsigned long long>> composites;
+        for (int i = 0; i < count; i++) {
+            if (values[i] > 1)
+                addFactor(i, trialDivide(values[i], factors[i]), factors, composites);
         }
-        sort(temp.begin(), temp.end());
 
-        for (int i = 0; i < int(temp.size()); ++i) {
-            int j = i, e = 0;
-            while (j < int(temp.size()) && temp[j] == temp[i]) {
-                e += 1;
-                j += 1;
+        pollardRho(factors, composites);
+
+        vector<vector<pair<unsigned long long, int>>> res(count);
+        for (int i = 0; i < count; i++) {
+            auto& f = factors[i];
+            sort(f.begin(), f.end());
+            for (int j = 0; j < int(f.size()); j++) {
+                if (j > 0 && f[j] == f[j - 1])
+                    res[i].back().second++;
+                else
+                    res[i].emplace_back(f[j], 1);
             }
-            ans.push_back({ temp[i], e });
-            i = j - 1;
         }
-        return ans;
+        return res;
     }
 
-protected:
-    void pollardRho(long long n, int& m, vector<long long>& s) {
-        long long x;
-        if (n == 1)
-            return;
+    vector<vector<pair<unsigned long long, int>>> factorBatch(const vector<unsigned long long>& values) {
+        return factorBatch(values.data(), int(values.size()));
+    }
 
-        if (n <= N) {
-            while (n != 1) {
-                int p = minFactors.minFactors[int(n)];
-                while (n % p == 0) {
-                    n /= p;
-                    s[m++] = p;
-                }
-            }
-            return;
-        }
+    // x has no prime factors less than TRIAL_LIMIT
+    static bool isPrimeNumberRough(unsigned long long x) {
+        if (x < 1ull * TRIAL_LIMIT * TRIAL_LIMIT)
+            return x > 1;
+
+        MontgomeryInt64 mont(x);
+        unsigned long long d = x - 1;
+        int s = ctz(d);
+        d >>= s;
+
+        unsigned long long minusOne = x - mont.one;
+        // "Fast Primality Testing for Integers That Fit into a Machine Word"
+        static const unsigned long long bases[] = { 2, 325, 9375, 28178, 450775, 9780504, 1795265022 };
+        for (auto a : bases) {
+            unsigned long long y = mont.toMont(a);
+            if (y == 0)
+                continue;
 
-        while (!millerRabin(n)) {
-            int c;
-            for (c = 1, x = n; x == n; c = 1 + randInt() % (n - 1)) {
-                x = go(n, c);
+            y = mont.power(y, d);
+            if (y == mont.one || y == minusOne)
+                continue;
+
+            int r = 1;
+            for (; r < s; r++) {
+                y = mont.mul(y, y);
+                if (y == minusOne)
+                    break;
             }
-            if (x < 0)
-                break;
-            n /= x;
-            pollardRho(x, m, s);
+            if (r >= s)
+                return false;
         }
-        if (n > 1)
-            s[m++] = n;
+        return true;
     }
 
-    bool millerRabin(long long n) {
-        if (n <= N)
-            return minFactors.minFactors[int(n)] == n;
-        return !witness(28087, n);
-    }
+private:
+    // divisibility by an odd prime p : x is a multiple of p iff x * inv <= lim, and then x * inv = x / p
+    struct TrialDivisor {
+        unsigned long long p;
+        unsigned long long inv;     // p * inv = 1 (mod 2^64)
+        unsigned long long lim;     // (2^64 - 1) / p
+    };
+    vector<TrialDivisor> trialDivisors;
+
+    // the state of Pollard's rho on one number
+    struct Lane {
+        int index;
+        MontgomeryInt64 mont;
+        unsigned long long c;
+        unsigned long long x, y;    // x = f^(r - GCD_BATCH)(x0), y = f^(r - GCD_BATCH + k)(x0)
+        unsigned long long q;       // the product of |x - y| since the last gcd
+        unsigned long long r, k;    // r = GCD_BATCH * 2^j, 0 <= k < r
+        unsigned long long savedX;  // x at the start of the current batch
+        unsigned long long savedY;  // y at the start of the current batch
+    };
 
-    static long long func(long long x, long long n, int c) {
-        long long res = mulMod(x, x, n) + c;
-        return (res >= n ? res % n : res);
+    void buildTrialDivisors() {
+        vector<bool> composite(TRIAL_LIMIT);
+        for (int p = 3; p < TRIAL_LIMIT; p += 2) {
+            if (composite[p])
+                continue;
+            for (int j = p * p; j < TRIAL_LIMIT; j += 2 * p)
+                composite[j] = true;
+
+            MontgomeryInt64 mont(p);
+            trialDivisors.push_back(TrialDivisor{ (unsigned long long)p, mont.nInv, ~0ull / p });
+        }
     }
 
-    static long long go(long long n, int c) {
-        long long x, y, d = 1;
-        x = y = rand() & 0x7fff;
-        if (x >= n) {
-            x %= n;
-            y %= n;
+    // returns the cofactor which has no prime factors less than TRIAL_LIMIT
+    unsigned long long trialDivide(unsigned long long x, vector<unsigned long long>& out) const {
+        int e = ctz(x);
+        out.insert(out.end(), e, 2ull);
+        x >>= e;
+
+        for (auto& t : trialDivisors) {
+            if (t.p * t.p > x)
+                break;
+            while (x * t.inv <= t.lim) {
+                x *= t.inv;
+                out.push_back(t.p);
+            }
         }
-        while (d == 1) {
-            x = func(x, n, c);
-            y = func(func(y, n, c), n, c);
-            d = gcd(abs(y - x), n);
+        // x is 1 or a prime
+        if (x > 1 && x < trialDivisors.back().p * trialDivisors.back().p) {
+            out.push_back(x);
+            x = 1;
         }
-        if (d != n)
-            return d;
-        return d;
+        return x;
     }
 
-private:
-    static long long randLL() {
-        return (rand() & 0x7fff) * (1ll << 48)
-             + (rand() & 0x7fff) * (1ll << 32)
-             + (rand() & 0x7fff) * (1ll << 16)
-             + (rand() & 0x7fff);
-    }
+    // adds a factor x which has no prime factors less than TRIAL_LIMIT
+    void addFactor(int index, unsigned long long x, vector<vector<unsigned long long>>& factors,
+                   vector<pair<int, unsigned long long>>& composites) const {
+        if (x <= 1)
+            return;
 
-    static int randInt() {
-        return (rand() & 0x7fff) * (rand() & 0x7fff);
+        if (x <= static_cast<unsigned long long>(N)) {
+            int v = int(x);
+            while (v > 1) {
+                int p = minFactors.minFactors[v];
+                factors[index].push_back(p);
+                v /= p;
+            }
+        } else if (isPrimeNumberRough(x)) {
+            factors[index].push_back(x);
+        } else {
+            composites.emplace_back(index, x);
+        }
     }
 
-    static long long gcd(long long p, long long q) {
-        return q == 0 ? p : gcd(q, p % q);
-    }
+    void pollardRho(vector<vector<unsigned long long>>& factors, vector<pair<int, unsigned long long>>& composites) const {
+        Lane lanes[LANES];
+        int active = 0;
+        int next = 0;
+        while (true) {
+            while (active < LANES && next < int(composites.size())) {
+                startLane(lanes[active++], composites[next].first, composites[next].second, 1);
+                next++;
+            }
+            if (active == 0)
+                break;
 
-    static long long mulMod(long long a, long long b, long long M) {
-        long long x = 0, y = a % M;
-        while (b > 0) {
-            if (b & 1)
-                x = (x + y) % M;
+            runBlock<LANES>(lanes, active);
 
-            y = (y << 1) % M;
-            b >>= 1;
+            for (int l = active - 1; l >= 0; l--) {
+                Lane& L = lanes[l];
+                unsigned long long n = L.mont.n;
+                unsigned long long g = gcd(L.q, n);
+                if (g == 1)
+                    continue;
+
+                if (g == n)
+                    g = backtrack(L);
+                if (g == n) {
+                    // failed, retry with another polynomial
+                    startLane(L, L.index, n, L.c + 1);
+                    continue;
+                }
+
+                addFactor(L.index, g, factors, composites);
+                addFactor(L.index, n / g, factors, composites);
+                lanes[l] = lanes[--active];
+            }
         }
-        return x % M;
     }
 
-    static long long power(long long a, long long x, long long M) {
-        long long res = 1;
+    static void startLane(Lane& L, int index, unsigned long long n, unsigned long long c) {
+        L.index = index;
+        L.mont.init(n);
+        L.c = c;
+        L.x = L.y = L.savedX = L.savedY = L.mont.toMont(2);
+        L.q = L.mont.one;
+        L.r = GCD_BATCH;
+        L.k = 0;
+    }
 
-        a = a % M;
-        while (x > 0) {
-            if (x & 1)
-                res = static_cast<long long>(mulMod(res, a, M));
+    // f(y) = y^2 + c
+    static unsigned long long func(const MontgomeryInt64& mont, unsigned long long y, unsigned long long c) {
+        return mont.add(mont.mul(y, y), c);
+    }
 
-            x >>= 1;
-            a = static_cast<long long>(mulMod(a, a, M));
+    // GCD_BATCH steps of K lanes (K >= active), the states are in registers and the K chains are independent
+    //   r is a multiple of GCD_BATCH, so x changes only at the end of a batch
+    template <int K>
+    static void runBlock(Lane* lanes, int active) {
+        if (K > 1 && active < K) {
+            runBlock<(K > 1 ? K - 1 : 1)>(lanes, active);
+            return;
         }
 
-        return res;
-    }
+        MontgomeryInt64 mont[K];
+        unsigned long long c[K], x[K], y[K], q[K];
+        for (int l = 0; l < K; l++) {
+            mont[l] = lanes[l].mont;
+            c[l] = lanes[l].c;
+            x[l] = lanes[l].savedX = lanes[l].x;
+            y[l] = lanes[l].savedY = lanes[l].y;
+            q[l] = lanes[l].q;
+        }
 
-    static bool witness(long long a, long long n) {
-        long long x, y, u = n - 1, t = 0;
-        while (u % 2 == 0) {
-            u >>= 1;
-            t += 1;
+        for (int s = 0; s < GCD_BATCH; s++) {
+            for (int l = 0; l < K; l++) {
+                y[l] = func(mont[l], y[l], c[l]);
+                q[l] = mont[l].mul(q[l], x[l] > y[l] ? x[l] - y[l] : y[l] - x[l]);
+            }
+        }
+
+        for (int l = 0; l < K; l++) {
+            Lane& L = lanes[l];
+            L.y = y[l];
+            L.q = q[l];
+            L.k += GCD_BATCH;
+            if (L.k == L.r) {
+                L.x = L.y;
+                L.r <<= 1;
+                L.k = 0;
+            }
         }
-        x = power(a, u, n);
-        while (t--) {
-            y = x;
-            x = power(x, 2, n);
-            if (x == 1 && y != 1 && y != n - 1)
-                return 1;
+    }
+
+    // replays the last batch with a gcd in each step
+    //   x is taken from the start of the batch, because runBlock() moves it at the end of a cycle
+    static unsigned long long backtrack(Lane& L) {
+        unsigned long long n = L.mont.n;
+        unsigned long long x = L.savedX;
+        unsigned long long y = L.savedY;
+        for (int s = 0; s < GCD_BATCH; s++) {
+            y = func(L.mont, y, L.c);
+            unsigned long long g = gcd(x > y ? x - y : y - x, n);
+            if (g != 1)
+                return g;
         }
-        return x != 1;
+        return n;
+    }
+
+    static int ctz(unsigned long long x) {
+#ifndef __GNUC__
+        unsigned long index;
+        _BitScanForward64(&index, x);
+        return int(index);
+#else
+        return __builtin_ctzll(x);
+#endif
+    }
+
+    // binary GCD
+    static unsigned long long gcd(unsigned long long a, unsigned long long b) {
+        if (a == 0)
+            return b;
+        if (b == 0)
+            return a;
+
+        int shift = ctz(a | b);
+        a >>= ctz(a);
+        do {
+            b >>= ctz(b);
+            if (a > b)
+                swap(a, b);
+            b -= a;
+        } while (b != 0);
+        return a << shift;
     }
 };
@@ -0,0 +1,129 @@
+#include <cmath>
+#include <vector>
+#include <string>
+#include <algorithm>
+
+using namespace std;
+
+#include "primeNumberSegmentedSieve.h"
+
+/////////// For Testing ///////////////////////////////////////////////////////
+
+#include <time.h>
+#include <cassert>
+#include <string>
+#include <iostream>
+#include "../common/iostreamhelper.h"
+#include "../common/profile.h"
+#include "../common/rand.h"
+
+void testPrimeNumberSegmentedSieve() {
+    return; //TODO: if you want to test, make this line a comment.
+
+    cout << "--- Segmented Wheel Sieve ---------------------------" << endl;
+    {
+        const int N = 3000000;
+        auto gt = eratosthenes2(N);
+
+        auto ans = SegmentedWheelSieve::primes(0, N);
+        assert(vector<int>(ans.begin(), ans.end()) == gt);
+        assert(SegmentedWheelSieve::countPrimes(0, N) == (long long)gt.size());
+        assert(SegmentedWheelSieve::primes(0, N, 3) == ans);
+
+        // windows
+        for (int i = 0; i < 1000; i++) {
+            int L = RandInt32::get() % N;
+            int R = L + RandInt32::get() % (i < 500 ? 100 : N - L);
+            R = min(R, N);
+            long long cnt = upper_bound(gt.begin(), gt.end(), R) - lower_bound(gt.begin(), gt.end(), L);
+            assert(SegmentedWheelSieve::countPrimes(L, R) == cnt);
+        }
+        for (int L = 0; L <= 40; L++) {
+            for (int R = L; R <= 100; R++) {
+                long long cnt = upper_bound(gt.begin(), gt.end(), R) - lower_bound(gt.begin(), gt.end(), L);
+                assert(SegmentedWheelSieve::countPrimes(L, R) == cnt);
+            }
+        }
+
+        // iterator
+        SegmentedWheelSieve::Iterator it(1000, N);
+        auto p = lower_bound(gt.begin(), gt.end(), 1000);
+        for (auto x = it.next(); x; x = it.next())
+            assert(x == (unsigned long long)*p++);
+        assert(p == gt.end());
+
+        size_t idx = 0;
+        SegmentedWheelSieve::forEachPrime(0, N, [&](unsigned long long x) {
+            assert(x == (unsigned long long)gt[idx++]);
+        });
+        assert(idx == gt.size());
+    }
+    {
+        // pi(10^k), and a window beyond 2^32 with a plain segmented sieve of Eratosthenes as a reference
+        assert(SegmentedWheelSieve::countPrimes(0, 1000000000, 2) == 50847534);
+
+        unsigned long long lo = 100000000000ull - 1000000;
+        unsigned long long hi = 100000000000ull;
+        auto ans = SegmentedWheelSieve::primes(lo, hi, 2);
+
+        vector<bool> composite(hi - lo + 1);
+        for (int p : eratosthenes2(int(sqrt(double(hi))) + 1)) {
+            unsigned long long first = max(1ull * p * p, (lo + p - 1) / p * p);
+            for (unsigned long long x = first; x <= hi; x += p)
+                composite[x - lo] = true;
+        }
+        vector<unsigned long long> gt;
+        for (unsigned long long x = lo; x <= hi; x++) {
+            if (!composite[x - lo])
+                gt.push_back(x);
+        }
+        assert(ans == gt);
+        assert(SegmentedWheelSieve::countPrimes(lo, hi) == (long long)ans.size());
+    }
+    cout << "OK!" << endl;
+
+    cout << "*** Speed test ***" << endl;
+    {
+        int N = 200000000;
+        cout << "N = " << N << endl;
+
+        PROFILE_START(0);
+        auto p = eratosthenes(N);
+        long long cnt0 = count(p.begin(), p.end(), true);
+        PROFILE_STOP(0);
+
+        PROFILE_START(1);
+        auto v = eratosthenes(N / 2, N);
+        long long cnt1 = count(v.begin(), v.end(), true);
+        PROFILE_STOP(1);
+
+        PROFILE_START(2);
+        long long cnt2 = SegmentedWheelSieve::countPrimes(0, N);
+        PROFILE_STOP(2);
+
+        PROFILE_START(3);
+        long long cnt3 = SegmentedWheelSieve::countPrimes(N / 2, N);
+        PROFILE_STOP(3);
+
+        cout << "pi(N) = " << cnt0 << ", " << cnt2 << ", pi(N) - pi(N/2) = " << cnt1 << ", " << cnt3 << endl;
+        assert(cnt0 == cnt2 && cnt1 == cnt3);
+    }
+    {
+        // primes up to 10^11 in the original measurement, it's reduced to run faster
+        unsigned long long N = 10000000000ull;
+        cout << "N = " << N << endl;
+
+        int maxThreadN = max(1, int(thread::hardware_concurrency()));
+        for (int T = 1; ; T = min(T * 2, maxThreadN)) {
+            AccumulateTimer timer;
+            timer.start();
+            long long cnt = SegmentedWheelSieve::countPrimes(0, N, T);
+            timer.stop();
+            cout << "  threads = " << T << " : pi(N) = " << cnt << ", " << timer.getMillisec() << " ms, "
+                 << (long long)(cnt / (timer.getMillisec() / 1000.0)) << " primes/sec" << endl;
+            assert(cnt == 455052511);
+            if (T >= maxThreadN)
+                break;
+        }
+    }
+}
@@ -0,0 +1,425 @@
+#pragma once
+
+#include <cmath>
+#include <cstring>
+#include <atomic>
+#include <thread>
+
+#ifndef __GNUC__
+#include <intrin.h>
+#endif
+
+#include "primeNumberEratosthenes.h"
+
+// Segmented sieve of Eratosthenes with a mod-30 wheel
+//   - a byte has 8 bits of 30*k + { 1, 7, 11, 13, 17, 19, 23, 29 }, so 30 numbers per byte
+//   - segments of SEGMENT_BYTES (32KB, L1 cache) cover 983,040 numbers
+//   - each sieving prime p keeps the next multiple p*q (q is coprime to 30) as a byte index and a wheel index,
+//     and the bit and the next byte offset of each (p % 30, q % 30) come from tables without divisions
+//   - countPrimes() and primes() split the range into chunks of CHUNK_SEGMENTS segments, threads take chunks in order
+//
+//   primes up to 10^11 : the sieving primes are up to 316,228, and memory is O(sqrt(N) + SEGMENT_BYTES) per thread
+struct SegmentedWheelSieve {
+    static const int SEGMENT_BYTES = 32 * 1024;
+    static const int CHUNK_SEGMENTS = 64;
+
+    // the number of primes in [lo, hi]
+    static long long countPrimes(unsigned long long lo, unsigned long long hi, int threadN = 1) {
+        if (lo > hi)
+            return 0;
+
+        std::atomic<long long> total(0);
+        forEachChunk(lo, hi, threadN, [&total](Segmenter& seg, int) {
+            long long cnt = 0;
+            while (seg.sieveNext())
+                cnt += seg.count();
+            total += cnt;
+        });
+        return total + countSmall(lo, hi);
+    }
+
+    // all primes in [lo, hi]
+    static vector<unsigned long long> primes(unsigned long long lo, unsigned long long hi, int threadN = 1) {
+        vector<unsigned long long> res;
+        if (lo > hi)
+            return res;
+
+        for (unsigned long long p : { 2, 3, 5 }) {
+            if (lo <= p && p <= hi)
+                res.push_back(p);
+        }
+
+        vector<vector<unsigned long long>> chunks(chunkCount(lo, hi));
+        forEachChunk(lo, hi, threadN, [&chunks](Segmenter& seg, int chunk) {
+            auto& out = chunks[chunk];
+            while (seg.sieveNext())
+                seg.forEach([&out](unsigned long long p) { out.push_back(p); });
+        });
+
+        for (auto& v : chunks)
+            res.insert(res.end(), v.begin(), v.end());
+        return res;
+    }
+
+    // f(p) for all primes in [lo, hi], in ascending order
+    template <typename FuncT>
+    static void forEachPrime(unsigned long long lo, unsigned long long hi, FuncT f) {
+        if (lo > hi)
+            return;
+
+        for (unsigned long long p : { 2, 3, 5 }) {
+            if (lo <= p && p <= hi)
+                f(p);
+        }
+
+        auto base = basePrimes(hi);
+        Segmenter seg(base, lo, hi);
+        while (seg.sieveNext())
+            seg.forEach(f);
+    }
+
+private:
+    // { 1, 7, 11, 13, 17, 19, 23, 29 }
+    static int residue(int k) {
+        static const int R[8] = { 1, 7, 11, 13, 17, 19, 23, 29 };
+        return R[k];
+    }
+
+    // residue(k + 1) - residue(k), residue(8) = 31
+    static int delta(int k) {
+        static const int D[8] = { 6, 4, 2, 4, 2, 4, 6, 2 };
+        return D[k];
+    }
+
+    static int residueIndex(int r) {
+        // -1 if r is not coprime to 30
+        static const signed char idx[30] = {
+            -1,  0, -1, -1, -1, -1, -1,  1, -1, -1, -1,  2, -1,  3, -1,
+            -1, -1,  4, -1,  5, -1, -1, -1,  6, -1, -1, -1, -1, -1,  7
+        };
+        return idx[r];
+    }
+
+    struct Tables {
+        // for p % 30 = residue(i) and q % 30 = residue(j),
+        //   mask[i][j] : a mask to clear the bit of p * q
+        //   inc[i][j]  : the byte distance from p * q to p * (q + delta(j)), minus (p / 30) * delta(j)
+        unsigned char mask[8][8];
+        unsigned char inc[8][8];
+
+        Tables() {
+            for (int i = 0; i < 8; i++) {
+                for (int j = 0; j < 8; j++) {
+                    int r = residue(i) * residue(j) % 30;
+                    mask[i][j] = static_cast<unsigned char>(~(1 << residueIndex(r)));
+                    inc[i][j] = static_cast<unsigned char>((r + residue(i) * delta(j)) / 30);
+                }
+            }
+        }
+    };
+
+    static const Tables& tables() {
+        static Tables t;
+        return t;
+    }
+
+    static int ctz(unsigned long long x) {
+#ifndef __GNUC__
+        unsigned long index;
+        _BitScanForward64(&index, x);
+        return int(index);
+#else
+        return __builtin_ctzll(x);
+#endif
+    }
+
+    static int popcount(unsigned long long x) {
+#ifndef __GNUC__
+        return int(__popcnt64(x));
+#else
+        return __builtin_popcountll(x);
+#endif
+    }
+
+    static unsigned long long readWord(const unsigned char* p) {
+        unsigned long long x;
+        memcpy(&x, p, sizeof(x));
+        return x;
+    }
+
+    // primes in [7, sqrt(hi)]
+    static vector<unsigned> basePrimes(unsigned long long hi) {
+        unsigned long long root = (unsigned long long)sqrtl((long double)hi);
+        while (root * root > hi)
+            root--;
+        while ((root + 1) * (root + 1) <= hi)
+            root++;
+
+        vector<unsigned> res;
+        if (root < 7)
+            return res;
+        for (int p : eratosthenes2(int(root))) {
+            if (p >= 7)
+                res.push_back(unsigned(p));
+        }
+        return res;
+    }
+
+    static long long countSmall(unsigned long long lo, unsigned long long hi) {
+        long long cnt = 0;
+        for (unsigned long long p : { 2, 3, 5 }) {
+            if (lo <= p && p <= hi)
+                cnt++;
+        }
+        return cnt;
+    }
+
+    // sieves bytes [first, last) of segments, the numbers outside of [lo, hi] are cleared
+    struct Segmenter {
+        vector<unsigned char> buffer;
+        unsigned long long first;           // the first byte of the current segment
+        int bytes;                          // the number of bytes of the current segment, a multiple of 8
+
+        Segmenter(const vector<unsigned>& base, unsigned long long lo, unsigned long long hi)
+            : buffer(SEGMENT_BYTES), first(0), bytes(0), base(base), lo(lo), hi(hi),
+              nextByte(lo / 30), endByte(hi / 30 + 1) {
+            init();
+        }
+
+        Segmenter(const vector<unsigned>& base, unsigned long long lo, unsigned long long hi,
+                  unsigned long long firstByte, unsigned long long lastByte)
+            : buffer(SEGMENT_BYTES), first(0), bytes(0), base(base), lo(lo), hi(hi),
+              nextByte(firstByte), endByte(lastByte) {
+            init();
+        }
+
+        // false at the end
+        bool sieveNext() {
+            if (nextByte >= endByte)
+                return false;
+
+            first = nextByte;
+            int n = int(min<unsigned long long>(SEGMENT_BYTES, endByte - first));
+            nextByte += n;
+            bytes = (n + 7) & ~7;
+
+            memset(buffer.data(), 0xFF, n);
+            memset(buffer.data() + n, 0, bytes - n);
+            crossOff(n);
+
+            // 1 and the numbers out of [lo, hi]
+            if (first == 0)
+                buffer[0] &= ~1;
+            if (first == lo / 30)
+                buffer[0] &= lowMask(lo);
+            if (first + n == hi / 30 + 1)
+                buffer[n - 1] &= highMask(hi);
+            return true;
+        }
+
+        long long count() const {
+            long long cnt = 0;
+            for (int i = 0; i < bytes; i += 8)
+                cnt += popcount(readWord(buffer.data() + i));
+            return cnt;
+        }
+
+        template <typename FuncT>
+        void forEach(FuncT&& f) const {
+            for (int i = 0; i < bytes; i += 8) {
+                unsigned long long bits = readWord(buffer.data() + i);
+                while (bits) {
+                    int bit = ctz(bits);
+                    bits &= bits - 1;
+                    f(30 * (first + i + (bit >> 3)) + residue(bit & 7));
+                }
+            }
+        }
+
+    private:
+        struct PrimeState {
+            unsigned long long byte;        // the byte of the next multiple
+            unsigned step;                  // p / 30
+            unsigned char i;                // the residue index of p
+            unsigned char j;                // the residue index of q
+        };
+
+        const vector<unsigned>& base;
+        unsigned long long lo, hi;
+        unsigned long long nextByte, endByte;
+        vector<PrimeState> states;
+
+        // the first multiple p * q >= max(p^2, 30 * nextByte), q is coprime to 30
+        void init() {
+            unsigned long long start = 30 * nextByte;
+            states.reserve(base.size());
+            for (unsigned p : base) {
+                unsigned long long q = max<unsigned long long>(p, (start + p - 1) / p);
+                while (residueIndex(int(q % 30)) < 0)
+                    q++;
+                if (q > hi / p)
+                    continue;
+
+                unsigned long long m = p * q;
+                states.push_back(PrimeState{ m / 30, p / 30, (unsigned char)residueIndex(p % 30),
+                                             (unsigned char)residueIndex(int(q % 30)) });
+            }
+        }
+
+        void crossOff(int n) {
+            const Tables& t = tables();
+            unsigned char* seg = buffer.data();
+            unsigned long long last = first + n;
+            for (auto& s : states) {
+                unsigned long long byte = s.byte;
+                if (byte >= last)
+                    continue;
+
+                const unsigned char* mask = t.mask[s.i];
+                const unsigned char* inc = t.inc[s.i];
+                unsigned step = s.step;
+                int j = s.j;
+
+                // to the start of a wheel cycle
+                while (j != 0 && byte < last) {
+                    seg[byte - first] &= mask[j];
+                    byte += step * delta(j) + inc[j];
+                    j = (j + 1) & 7;
+                }
+
+                // 8 multiples in a cycle of p bytes
+                if (j == 0) {
+                    unsigned p = step * 30 + residue(s.i);
+                    unsigned o1 = step * 6 + inc[0];
+                    unsigned o2 = o1 + step * 4 + inc[1];
+                    unsigned o3 = o2 + step * 2 + inc[2];
+                    unsigned o4 = o3 + step * 4 + inc[3];
+                    unsigned o5 = o4 + step * 2 + inc[4];
+                    unsigned o6 = o5 + step * 4 + inc[5];
+                    unsigned o7 = o6 + step * 6 + inc[6];
+                    for (; byte + o7 < last; byte += p) {
+                        unsigned char* b = seg + (byte - first);
+                        b[0] &= mask[0];
+                        b[o1] &= mask[1];
+                        b[o2] &= mask[2];
+                        b[o3] &= mask[3];
+                        b[o4] &= mask[4];
+                        b[o5] &= mask[5];
+                        b[o6] &= mask[6];
+                        b[o7] &= mask[7];
+                    }
+                }
+
+                while (byte < last) {
+                    seg[byte - first] &= mask[j];
+                    byte += step * delta(j) + inc[j];
+                    j = (j + 1) & 7;
+                }
+
+                s.byte = byte;
+                s.j = (unsigned char)j;
+            }
+        }
+
+        // bits of numbers >= lo in the byte of lo
+        static unsigned char lowMask(unsigned long long lo) {
+            int r = int(lo % 30);
+            unsigned char m = 0;
+            for (int k = 0; k < 8; k++) {
+                if (residue(k) >= r)
+                    m |= 1 << k;
+            }
+            return m;
+        }
+
+        // bits of numbers <= hi in the byte of hi
+        static unsigned char highMask(unsigned long long hi) {
+            int r = int(hi % 30);
+            unsigned char m = 0;
+            for (int k = 0; k < 8; k++) {
+                if (residue(k) <= r)
+                    m |= 1 << k;
+            }
+            return m;
+        }
+    };
+
+    static int chunkCount(unsigned long long lo, unsigned long long hi) {
+        unsigned long long bytes = hi / 30 + 1 - lo / 30;
+        unsigned long long chunkBytes = 1ull * SEGMENT_BYTES * CHUNK_SEGMENTS;
+        return int((bytes + chunkBytes - 1) / chunkBytes);
+    }
+
+    // f(segmenter, chunk index) on each chunk, threads take chunks in order
+    template <typename FuncT>
+    static void forEachChunk(unsigned long long lo, unsigned long long hi, int threadN, const FuncT& f) {
+        auto base = basePrimes(hi);
+        int chunkN = chunkCount(lo, hi);
+        unsigned long long chunkBytes = 1ull * SEGMENT_BYTES * CHUNK_SEGMENTS;
+        unsigned long long firstByte = lo / 30, endByte = hi / 30 + 1;
+
+        std::atomic<int> next(0);
+        auto worker = [&]() {
+            for (int c = next++; c < chunkN; c = next++) {
+                unsigned long long b = firstByte + c * chunkBytes;
+                Segmenter seg(base, lo, hi, b, min(endByte, b + chunkBytes));
+                f(seg, c);
+            }
+        };
+
+        vector<thread> threads;
+        for (int t = 1; t < threadN; t++)
+            threads.emplace_back(worker);
+        worker();
+        for (auto& th : threads)
+            th.join();
+    }
+public:
+    // streaming primes in [lo, hi], in ascending order
+    //   SegmentedWheelSieve::Iterator it(lo, hi);
+    //   for (auto p = it.next(); p; p = it.next()) { ... }
+    struct Iterator {
+        Iterator(unsigned long long lo, unsigned long long hi)
+            : lo(lo), hi(hi), base(basePrimes(hi)), seg(base, lo, hi), small(0), bytePos(0), wordPos(0), bits(0) {
+            seg.bytes = 0;
+        }
+
+        // 'seg' refers to 'base'
+        Iterator(const Iterator&) = delete;
+        Iterator& operator =(const Iterator&) = delete;
+
+        // returns 0 at the end
+        unsigned long long next() {
+            while (small < 3) {
+                unsigned long long p = (small == 0) ? 2 : (small == 1) ? 3 : 5;
+                small++;
+                if (lo <= p && p <= hi)
+                    return p;
+            }
+
+            while (bits == 0) {
+                if (bytePos >= seg.bytes) {
+                    if (!seg.sieveNext())
+                        return 0;
+                    bytePos = 0;
+                }
+                bits = readWord(seg.buffer.data() + bytePos);
+                wordPos = bytePos;
+                bytePos += 8;
+            }
+
+            int bit = ctz(bits);
+            bits &= bits - 1;
+            return 30 * (seg.first + wordPos + (bit >> 3)) + residue(bit & 7);
+        }
+
+    private:
+        unsigned long long lo, hi;
+        vector<unsigned> base;
+        Segmenter seg;
+        int small;
+        int bytePos;
+        int wordPos;
+        unsigned long long bits;
+    };
+};
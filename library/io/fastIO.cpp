@@ -0,0 +1,239 @@
+#include <stdio.h>
+#include <vector>
+#include <string>
+#include <limits>
+#include <memory>
+#include <chrono>
+#include <thread>
+
+using namespace std;
+
+#include "fastIO.h"
+
+/////////// For Testing ///////////////////////////////////////////////////////
+
+#include <time.h>
+#include <cassert>
+#include <iostream>
+#include "../common/iostreamhelper.h"
+#include "../common/profile.h"
+#include "../common/rand.h"
+
+namespace {
+// writes more than FastIO::SIZE bytes, so tokens straddle chunk boundaries
+FILE* makeFastIOTestFile(vector<long long>& nums, vector<string>& strs) {
+    FILE* fp = tmpfile();
+    assert(fp != nullptr);
+
+    long long written = 0;
+    while (written < 2ll * FastIO::SIZE + 12345) {
+        long long x = (long long)RandInt32::get() * RandInt32::get() - 1234567;
+        if (RandInt32::get() % 3 == 0)
+            x = -x;
+        nums.push_back(x);
+        written += fprintf(fp, "%lld%s", x, (nums.size() % 10) ? " " : "\n");
+    }
+
+    // a string token longer than MARGIN
+    for (int i = 0; i < 1000; i++) {
+        string s(1 + RandInt32::get() % 200, 'a' + i % 26);
+        strs.push_back(s);
+        fprintf(fp, "%s\n", s.c_str());
+    }
+
+    fflush(fp);
+    return fp;
+}
+
+void checkFastIOInput(const vector<long long>& nums, const vector<string>& strs) {
+    for (auto x : nums) {
+        if (FastIO::readSLL() != x) {
+            cout << "Mismatched at " << x << endl;
+            assert(false);
+        }
+    }
+    for (auto& s : strs)
+        assert(FastIO::readString() == s);
+    assert(FastIO::readString().empty());
+}
+}
+
+void testFastIO() {
+    return; //TODO: if you want to test, make this line a comment.
+
+    cout << "--- FastIO ------------------------------------------" << endl;
+    {
+        vector<long long> nums;
+        vector<string> strs;
+        FILE* fp = makeFastIOTestFile(nums, strs);
+
+#ifdef FASTIO_MMAP_AVAILABLE
+        fseek(fp, 0, SEEK_SET);
+        assert(FastIO::initMmap(fp));
+        checkFastIOInput(nums, strs);
+
+        // scanf() before init(), the FILE buffer has input which isn't read yet
+        fseek(fp, 0, SEEK_SET);
+        long long first = 0;
+        int cnt = fscanf(fp, "%lld", &first);
+        assert(cnt == 1 && first == nums[0]);
+        assert(FastIO::initMmap(fp));
+        for (int i = 1; i < int(nums.size()); i++)
+            assert(FastIO::readSLL() == nums[i]);
+#endif
+
+        fseek(fp, 0, SEEK_SET);
+        FastIO::initStream(fp, false);
+        checkFastIOInput(nums, strs);
+
+        fseek(fp, 0, SEEK_SET);
+        FastIO::initStream(fp, true);
+        checkFastIOInput(nums, strs);
+
+        // re-initialization before the end of input
+        fseek(fp, 0, SEEK_SET);
+        FastIO::initStream(fp, true);
+        for (int i = 0; i < 100; i++)
+            assert(FastIO::readSLL() == nums[i]);
+        std::weak_ptr<FastIO::AsyncReader> oldReader = FastIO::gReader;
+        FastIO::stopReader();
+        fseek(fp, 0, SEEK_SET);
+        FastIO::initStream(fp, true);
+        checkFastIOInput(nums, strs);
+
+        // the previous reader is deleted when its thread exits
+        for (int i = 0; i < 1000 && !oldReader.expired(); i++)
+            this_thread::sleep_for(chrono::milliseconds(1));
+        assert(oldReader.expired());
+
+        fclose(fp);
+    }
+#ifdef FASTIO_MMAP_AVAILABLE
+    {
+        // "3\n1 2 3" redirected from a file, and n is read by scanf()
+        FILE* fp = tmpfile();
+        assert(fp != nullptr);
+        fputs("3\n1 2 3\n", fp);
+        fflush(fp);
+        fseek(fp, 0, SEEK_SET);
+
+        int n = 0;
+        int cnt = fscanf(fp, "%d", &n);
+        assert(cnt == 1 && n == 3);
+        assert(FastIO::initMmap(fp));
+        int sum = 0;
+        for (int i = 0; i < n; i++)
+            sum += FastIO::readInt();
+        assert(sum == 6);
+
+        fclose(fp);
+    }
+#endif
+    {
+        // digit kernels
+        char buf[64 + 16];
+        for (int i = 0; i < 100000; i++) {
+            int len = RandInt32::get() % 25;
+            for (int j = 0; j < len; j++)
+                buf[j] = '0' + RandInt32::get() % 10;
+            buf[len] = " \n-+a/:\0"[RandInt32::get() % 8];
+            for (int j = len + 1; j < int(sizeof(buf)); j++)
+                buf[j] = '0' + RandInt32::get() % 10;
+
+            const char* p1 = buf;
+            const char* p2 = buf;
+            auto gt = FastIO::parseDigitsScalar(p1);
+            auto ans = FastIO::parseDigits(p2);
+            if (ans != gt || p1 != p2) {
+                cout << "Mismatched at \"" << string(buf, len) << "\" : " << ans << ", " << gt << endl;
+                assert(false);
+            }
+        }
+    }
+    {
+        // batch readers
+        FILE* fp = tmpfile();
+        int N = 100000;
+        vector<int> nums(N);
+        vector<pair<int, int>> edges(N);
+        for (int i = 0; i < N; i++) {
+            nums[i] = RandInt32::get() - (1 << 30);
+            fprintf(fp, "%d%c", nums[i], (i % 7) ? ' ' : '\n');
+        }
+        nums.push_back(numeric_limits<int>::min());
+        nums.push_back(numeric_limits<int>::max());
+        fprintf(fp, "%d %d\n", numeric_limits<int>::min(), numeric_limits<int>::max());
+        for (int i = 0; i < N; i++) {
+            edges[i].first = RandInt32::get() % N;
+            edges[i].second = -(RandInt32::get() % N);
+            fprintf(fp, "%d %d\n", edges[i].first, edges[i].second);
+        }
+        fflush(fp);
+        fseek(fp, 0, SEEK_SET);
+
+        FastIO::initStream(fp, false);
+        assert(FastIO::readInts(nums.size()) == nums);
+        assert(FastIO::readPairs(N) == edges);
+        fclose(fp);
+    }
+    cout << "OK!" << endl;
+
+    cout << "*** Speed test ***" << endl;
+    {
+        // 10^8 integers (about 1GB) in the original measurement, it's reduced to run faster
+        const int N = 10000000;
+
+        FILE* fp = tmpfile();
+        vector<int> nums(N);
+        for (int i = 0; i < N; i++) {
+            nums[i] = RandInt32::get() - (1 << 30);
+            fprintf(fp, "%d\n", nums[i]);
+        }
+        fflush(fp);
+
+        vector<int> out(N);
+        long long sum0 = 0, sum1 = 0, sum2 = 0;
+
+        cout << "N = " << N << endl;
+        {
+            fseek(fp, 0, SEEK_SET);
+            PROFILE_START(0);
+            for (int i = 0; i < N; i++) {
+                if (fscanf(fp, "%d", &out[i]) != 1)
+                    break;
+            }
+            PROFILE_STOP(0);
+            for (int i = 0; i < N; i++)
+                sum0 += out[i];
+        }
+        {
+            fseek(fp, 0, SEEK_SET);
+            PROFILE_START(1);
+            FastIO::initStream(fp);
+            for (int i = 0; i < N; i++) {
+                // the original scalar loop
+                FastIO::skipSpaces();
+                bool neg = (*FastIO::gInPtr == '-');
+                FastIO::gInPtr += neg;
+                int x = int(FastIO::parseDigitsScalar(FastIO::gInPtr));
+                out[i] = neg ? -x : x;
+            }
+            PROFILE_STOP(1);
+            for (int i = 0; i < N; i++)
+                sum1 += out[i];
+        }
+        {
+            fseek(fp, 0, SEEK_SET);
+            PROFILE_START(2);
+            FastIO::initStream(fp);
+            FastIO::readInts(out.data(), N);
+            PROFILE_STOP(2);
+            for (int i = 0; i < N; i++)
+                sum2 += out[i];
+        }
+        cout << "scanf, scalar, SIMD : " << sum0 << ", " << sum1 << ", " << sum2 << endl;
+        assert(sum0 == sum1 && sum1 == sum2);
+
+        fclose(fp);
+    }
+}
@@ -1,93 +1,470 @@
 #pragma once
 
 #include <stdio.h>
+#include <string.h>
 #include <string>
-
+#include <algorithm>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <memory>
+#include <utility>
+#include <type_traits>
+#include <vector>
+
+#if defined(__SSE4_1__)
+#include <immintrin.h>
+#endif
+
+#ifndef __GNUC__
+#include <intrin.h>
+#endif
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#define FASTIO_MMAP_AVAILABLE
+#endif
+
+// Input modes
+//  - mmap   : a regular file is mapped into memory and parsed in place (no copy, no size limit)
+//  - stream : input is read in chunks of SIZE bytes, and the next chunk is read by a background thread
+//             while the current chunk is parsed (double buffering)
+// init() uses mmap if stdin is a regular file, otherwise stream.
+//
+// The input ends with '\0' at gInEnd, and at least MARGIN bytes are available after a token starts,
+//   so the parsing loops don't check buffer boundaries. (a number must be shorter than MARGIN characters)
+// Digits are parsed 16 at a time with SSE4.1, or 8 at a time with SWAR if SSE4.1 is not available.
 namespace FastIO {
-    const int SIZE = (1 << 24);
+    const int SIZE = (1 << 24);     // chunk size of stream mode
+    const int MARGIN = 64;          // unread bytes carried over to the next chunk
+
+    enum ModeT {
+        modeStream,
+        modeAsyncStream,
+        modeMmap
+    };
+
+    // [MARGIN bytes for carried over data][SIZE bytes chunk]['\0' and padding for 16-byte loads]
+    char gInBuff[2][MARGIN + SIZE + MARGIN];
+    int gInBuffIndex;
 
-    char gInBuff[SIZE];
     const char* gInPtr;
+    const char* gInEnd;
+    bool gInEof;            // true if all input is in the buffer
 
-    void init() {
-        gInPtr = gInBuff;
-        auto sz = fread(gInBuff, 1, SIZE - 1, stdin);
-        gInBuff[sz] = 0;
+    ModeT gMode;
+    FILE* gInFile;
+
+    char* gMapPtr = nullptr;    // the mapped region of mmap mode
+    size_t gMapSize = 0;        //
+
+    //--- background reader ---
+
+    struct AsyncReader {
+        FILE* fp;
+        std::mutex mutex;
+        std::condition_variable cv;
+
+        char* target;       // requested buffer
+        size_t length;      // the length of the last read
+        bool requested;
+        bool ready;
+
+        explicit AsyncReader(FILE* fp) : fp(fp), target(nullptr), length(0), requested(false), ready(false) {
+        }
+
+        // 'dst' is nullptr to stop the reader
+        void request(char* dst) {
+            std::lock_guard<std::mutex> lock(mutex);
+            target = dst;
+            requested = true;
+            ready = false;
+            cv.notify_all();
+        }
+
+        size_t wait() {
+            std::unique_lock<std::mutex> lock(mutex);
+            cv.wait(lock, [this]() { return ready; });
+            return length;
+        }
+
+        void run() {
+            while (true) {
+                std::unique_lock<std::mutex> lock(mutex);
+                cv.wait(lock, [this]() { return requested; });
+                requested = false;
+                char* dst = target;
+                if (!dst)
+                    break;
+                lock.unlock();
+
+                size_t n = fread(dst, 1, SIZE, fp);
+
+                lock.lock();
+                length = n;
+                ready = true;
+                cv.notify_all();
+                if (n < size_t(SIZE))
+                    break;
+            }
+        }
+    };
+
+    // the detached thread keeps its own reference, because it can be blocked in fread() at exit,
+    //   so a reader is deleted when both initStream() / stopReader() and the thread release it
+    std::shared_ptr<AsyncReader> gReader;
+
+    //--- buffer management ---
+
+    // waits for the running read and stops the background reader,
+    //   call it before repositioning the stream which is being read (the buffered input can still be read)
+    void stopReader() {
+        if (gReader && gMode == modeAsyncStream) {
+            if (!gInEof)
+                gReader->wait();
+            gReader->request(nullptr);
+            gReader.reset();
+            gInEof = true;
+        }
     }
 
-    // with sign
-    int readSInt() {
-        unsigned int u = 0, s = 0;
+    // moves unread bytes in front of the next chunk, O(MARGIN)
+    void refill() {
+        if (gInEof)
+            return;
+
+        size_t rem = gInEnd - gInPtr;
+        int next = (gMode == modeAsyncStream) ? (gInBuffIndex ^ 1) : gInBuffIndex;
+        char* chunk = gInBuff[next] + MARGIN;
+
+        size_t len;
+        if (gMode == modeAsyncStream) {
+            len = gReader->wait();
+            memcpy(chunk - rem, gInPtr, rem);
+            if (len == size_t(SIZE))
+                gReader->request(gInBuff[gInBuffIndex] + MARGIN);
+        } else {
+            memmove(chunk - rem, gInPtr, rem);
+            len = fread(chunk, 1, SIZE, gInFile);
+        }
+
+        gInBuffIndex = next;
+        gInPtr = chunk - rem;
+        gInEnd = chunk + len;
+        gInBuff[next][MARGIN + len] = 0;
+        gInEof = (len < size_t(SIZE));
+    }
+
+    void releaseMap() {
+#ifdef FASTIO_MMAP_AVAILABLE
+        if (gMapPtr) {
+            munmap(gMapPtr, gMapSize);
+            gMapPtr = nullptr;
+            gMapSize = 0;
+        }
+#endif
+    }
 
-        while (*gInPtr && *gInPtr <= 32)
-            ++gInPtr;
+    void initStream(FILE* fp = stdin, bool background = true) {
+        stopReader();
+        releaseMap();
+        gInFile = fp;
+        gMode = background ? modeAsyncStream : modeStream;
+        gInBuffIndex = 0;
+        gInPtr = gInEnd = gInBuff[0] + MARGIN;
+        gInEof = false;
+
+        if (background) {
+            gReader = std::make_shared<AsyncReader>(fp);
+            std::thread(&AsyncReader::run, gReader).detach();
+            gReader->request(gInBuff[1] + MARGIN);
+        }
+        refill();
+    }
 
-        if (*gInPtr == '-') {
-            s = ~s;
-            ++gInPtr;
-        } else if (*gInPtr == '+') {
-            ++gInPtr;
+    // maps a regular file, returns false if it's not possible
+    //  - it starts at ftell(fp), so input already read by scanf() or getchar() isn't read again
+    bool initMmap(FILE* fp) {
+#ifdef FASTIO_MMAP_AVAILABLE
+        stopReader();
+        releaseMap();
+
+        int fd = fileno(fp);
+        struct stat st;
+        if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode))
+            return false;
+
+        // not lseek(), the FILE buffer of 'fp' can have unread bytes after the position of 'fd'
+        long offset = ftell(fp);
+        if (offset < 0)
+            return false;
+
+        size_t size = size_t(st.st_size);
+        size_t page = size_t(sysconf(_SC_PAGESIZE));
+
+        // zero pages for '\0' and padding after the last byte
+        size_t mapSize = ((size + MARGIN) / page + 1) * page;
+        char* p = reinterpret_cast<char*>(mmap(nullptr, mapSize, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+        if (p == MAP_FAILED)
+            return false;
+        if (size > 0 && mmap(p, size, PROT_READ, MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED) {
+            munmap(p, mapSize);
+            return false;
         }
+        madvise(p, size, MADV_SEQUENTIAL);
+        gMapPtr = p;
+        gMapSize = mapSize;
+
+        gMode = modeMmap;
+        gInFile = nullptr;
+        gInPtr = p + std::min(size_t(offset), size);
+        gInEnd = p + size;
+        gInEof = true;
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    void init() {
+#ifdef FASTIO_MMAP_AVAILABLE
+        if (initMmap(stdin))
+            return;
+#endif
+        initStream(stdin, true);
+    }
 
-        while (*gInPtr >= '0' && *gInPtr <= '9')
-            u = u * 10 + (*gInPtr++ - '0');
+    //--- digit parsing ---
 
-        return static_cast<int>((u ^ s) + !!s);
+    // parses digits one by one, and moves 'p' to the first non-digit character
+    inline unsigned long long parseDigitsScalar(const char*& p) {
+        unsigned long long res = 0;
+        while (*p >= '0' && *p <= '9')
+            res = res * 10 + (*p++ - '0');
+        return res;
     }
 
-    int readInt() {
-        int res = 0;
+#if defined(__SSE4_1__)
+    // 16 x 0x80 followed by 0..15, loading 16 bytes from (gShuffleTable + k) makes a mask
+    //   which moves the first k bytes to the end and fills the front with zeros
+    alignas(32) const signed char gShuffleTable[32] = {
+        -128, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128, -128,
+        0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15
+    };
+
+    // parses at most 16 digits, returns the number of digits
+    // PRECONDITION: 16 bytes from 'p' are readable
+    inline int parseDigits16(const char* p, unsigned long long& value) {
+        __m128i v = _mm_sub_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)), _mm_set1_epi8('0'));
+
+        // a byte is a digit if (unsigned)(c - '0') <= 9
+        unsigned digitMask = unsigned(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_min_epu8(v, _mm_set1_epi8(9)), v)));
+        int k = __builtin_ctz(~digitMask);
+        if (k == 0) {
+            value = 0;
+            return 0;
+        }
 
-        while (*gInPtr && *gInPtr <= 32)
-            ++gInPtr;
+        // right-align digits, ex) "123" -> 0000000000000123
+        v = _mm_shuffle_epi8(v, _mm_loadu_si128(reinterpret_cast<const __m128i*>(gShuffleTable + k)));
+
+        v = _mm_maddubs_epi16(v, _mm_setr_epi8(10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1));    // 2 digits
+        v = _mm_madd_epi16(v, _mm_setr_epi16(100, 1, 100, 1, 100, 1, 100, 1));                              // 4 digits
+        v = _mm_packus_epi32(v, v);
+        v = _mm_madd_epi16(v, _mm_setr_epi16(10000, 1, 10000, 1, 10000, 1, 10000, 1));                      // 8 digits
+
+        value = static_cast<unsigned long long>(unsigned(_mm_cvtsi128_si32(v))) * 100000000ull
+              + unsigned(_mm_extract_epi32(v, 1));
+        return k;
+    }
+#else
+    // parses at most 8 digits with SWAR (8 bytes in a 64-bit integer), returns the number of digits
+    // PRECONDITION: 8 bytes from 'p' are readable
+    inline int parseDigits8(const char* p, unsigned long long& value) {
+        unsigned long long v;
+        memcpy(&v, p, sizeof(v));               // little endian
+        v ^= 0x3030303030303030ull;             // digits become 0..9
+
+        // the high bit of each byte is set if the byte is not a digit (> 9)
+        unsigned long long nonDigit = (((v & 0x7F7F7F7F7F7F7F7Full) + 0x7676767676767676ull) | v) & 0x8080808080808080ull;
+#ifndef __GNUC__
+        unsigned long index;
+        int k = _BitScanForward64(&index, nonDigit) ? int(index >> 3) : 8;
+#else
+        int k = nonDigit ? (__builtin_ctzll(nonDigit) >> 3) : 8;
+#endif
+        if (k == 0) {
+            value = 0;
+            return 0;
+        }
 
-        while (*gInPtr >= '0' && *gInPtr <= '9')
-            res = res * 10 + (*gInPtr++ - '0');
+        // right-align digits
+        v <<= (8 - k) * 8;
 
+        v = (v * 10) + (v >> 8);                // 2 digits
+        v = (((v & 0x000000FF000000FFull) * (100 + (1000000ull << 32)))
+            + (((v >> 16) & 0x000000FF000000FFull) * (1 + (10000ull << 32)))) >> 32;
+        value = v;
+        return k;
+    }
+#endif
+
+    // parses all digits, and moves 'p' to the first non-digit character
+    // PRECONDITION: 16 bytes from 'p' are readable
+    inline unsigned long long parseDigits(const char*& p) {
+        unsigned long long res;
+#if defined(__SSE4_1__)
+        p += parseDigits16(p, res);
+#else
+        int k = parseDigits8(p, res);
+        p += k;
+        if (k == 8) {
+            unsigned long long x;
+            k = parseDigits8(p, x);
+            p += k;
+            static const unsigned long long pow10[9] = { 1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000 };
+            res = res * pow10[k] + x;
+        }
+#endif
+        while (*p >= '0' && *p <= '9')
+            res = res * 10 + (*p++ - '0');
         return res;
     }
 
-    // with sign
-    long long readSLL() {
-        unsigned long long u = 0, s = 0;
+    //--- parsing ---
 
-        while (*gInPtr && *gInPtr <= 32)
-            ++gInPtr;
+    // skips white spaces and makes at least MARGIN bytes available
+    void skipSpaces() {
+        while (true) {
+            while (*gInPtr && *gInPtr <= 32)
+                ++gInPtr;
+            if (gInPtr < gInEnd || gInEof)
+                break;
+            refill();
+        }
+        if (gInEnd - gInPtr < MARGIN)
+            refill();
+    }
 
-        if (*gInPtr == '-') {
-            s = ~s;
-            ++gInPtr;
-        } else if (*gInPtr == '+') {
-            ++gInPtr;
+    // the same as skipSpaces() with a local pointer, for batch parsing loops
+    inline void skipSpaces(const char*& p) {
+        while (*p && *p <= 32)
+            ++p;
+        if (gInEnd - p < MARGIN) {
+            gInPtr = p;
+            skipSpaces();
+            p = gInPtr;
         }
+    }
+
+    // parses an integer with sign without branches on the sign
+    template <typename T>
+    inline T parseSigned(const char*& p) {
+        typedef typename std::make_unsigned<T>::type U;
 
-        while (*gInPtr >= '0' && *gInPtr <= '9')
-            u = u * 10 + (*gInPtr++ - '0');
+        char c = *p;
+        U s = U(0) - U(c == '-');
+        p += (c == '-') | (c == '+');
 
-        return static_cast<long long>((u ^ s) + !!s);
+        U u = static_cast<U>(parseDigits(p));
+
+        return static_cast<T>((u ^ s) - s);
     }
 
-    long long readLL() {
-        long long res = 0;
+    // with sign
+    int readSInt() {
+        skipSpaces();
+        return parseSigned<int>(gInPtr);
+    }
+
+    int readInt() {
+        skipSpaces();
+        return static_cast<int>(parseDigits(gInPtr));
+    }
+
+    // with sign
+    long long readSLL() {
+        skipSpaces();
+        return parseSigned<long long>(gInPtr);
+    }
 
-        while (*gInPtr && *gInPtr <= 32)
-            ++gInPtr;
+    long long readLL() {
+        skipSpaces();
+        return static_cast<long long>(parseDigits(gInPtr));
+    }
 
-        while (*gInPtr >= '0' && *gInPtr <= '9')
-            res = res * 10 + (*gInPtr++ - '0');
+    std::string readString() {
+        skipSpaces();
+
+        std::string res;
+        while (true) {
+            auto* start = gInPtr;
+            while (*gInPtr && *gInPtr > 32)
+                ++gInPtr;
+            res.append(start, gInPtr - start);
+
+            if (gInPtr < gInEnd || gInEof)
+                break;
+            refill();
+        }
 
         return res;
     }
 
-    std::string readString() {
-        while (*gInPtr && *gInPtr <= 32)
-            ++gInPtr;
+    //--- batch parsing ---
+
+    // The input pointer is kept in a register during the loop, it's faster than calling readSInt() n times.
+
+    // reads n integers with sign
+    void readInts(int* out, size_t n) {
+        const char* p = gInPtr;
+        for (size_t i = 0; i < n; i++) {
+            skipSpaces(p);
+            out[i] = parseSigned<int>(p);
+        }
+        gInPtr = p;
+    }
 
-        auto* start = gInPtr;
-        while (*gInPtr && *gInPtr > 32)
-            ++gInPtr;
+    void readLLs(long long* out, size_t n) {
+        const char* p = gInPtr;
+        for (size_t i = 0; i < n; i++) {
+            skipSpaces(p);
+            out[i] = parseSigned<long long>(p);
+        }
+        gInPtr = p;
+    }
+
+    // reads n pairs of integers with sign, ex) edge lists
+    void readPairs(std::pair<int, int>* out, size_t n) {
+        const char* p = gInPtr;
+        for (size_t i = 0; i < n; i++) {
+            skipSpaces(p);
+            out[i].first = parseSigned<int>(p);
+            skipSpaces(p);
+            out[i].second = parseSigned<int>(p);
+        }
+        gInPtr = p;
+    }
+
+    std::vector<int> readInts(size_t n) {
+        std::vector<int> res(n);
+        readInts(res.data(), n);
+        return res;
+    }
+
+    std::vector<long long> readLLs(size_t n) {
+        std::vector<long long> res(n);
+        readLLs(res.data(), n);
+        return res;
+    }
 
-        return std::string(start, gInPtr - start);
+    std::vector<std::pair<int, int>> readPairs(size_t n) {
+        std::vector<std::pair<int, int>> res(n);
+        readPairs(res.data(), n);
+        return res;
     }
 
     struct Stream {
@@ -133,4 +510,24 @@ int main() {
     // ...
 }
 
+OR (batch)
+
+int main() {
+    FastIO::init();
+
+    int N = FastIO::readInt(), M = FastIO::readInt();
+    vector<int> A = FastIO::readInts(N);
+    vector<pair<int, int>> edges = FastIO::readPairs(M);
+    // ...
+}
+
+OR (a large file)
+
+int main() {
+    FILE* fp = fopen("edges.txt", "rb");
+    if (!FastIO::initMmap(fp))
+        FastIO::initStream(fp);
+    // ...
+}
+
 */
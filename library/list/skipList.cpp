@@ -6,6 +6,8 @@
 using namespace std;
 
 #include "skipList.h"
+#include "../memory/simpleTypeAllocator.h"
+#include "../memory/newTypeAllocator.h"
 
 /////////// For Testing ///////////////////////////////////////////////////////
 
@@ -104,6 +106,25 @@ void testSkipList() {
             }
         }
     }
+    {
+        // move-only with a pooled allocator
+        vector<int> in(100);
+        iota(in.begin(), in.end(), 0);
+
+        vector<SkipList<int>> v;
+        v.emplace_back(16);
+        for (int x : in)
+            v.back().insert(x);
+        v.emplace_back(16);
+
+        SkipList<int> skl(std::move(v[0]));
+        assert(skl.size() == int(in.size()));
+        checkSearch(skl, in);
+
+        v[1] = std::move(skl);
+        assert(v[1].size() == int(in.size()));
+        checkSearch(v[1], in);
+    }
     cout << "OK!" << endl;
 
     cout << "*** Speed test BST vs RBTree vs SkipList ***" << endl;
@@ -264,5 +285,48 @@ void testSkipList() {
             PROFILE_STOP(3);
         }
     }
+    cout << "*** Speed test of node allocators ***" << endl;
+    {
+#ifdef _DEBUG
+        vector<int> in(300000);
+#else
+        vector<int> in(3000000);
+#endif
+        iota(in.begin(), in.end(), 0);
+        random_shuffle(in.begin(), in.end());
+
+        cout << "NewTypeAllocator : ";
+        PROFILE_START(0);
+        {
+            SkipList<int, NewTypeAllocator> skl(28);
+            for (auto x : in)
+                skl.insert(x);
+            for (auto x : in)
+                skl.erase(x);
+        }
+        PROFILE_STOP(0);
+
+        cout << "TypeAllocator : ";
+        PROFILE_START(1);
+        {
+            SkipList<int, TypeAllocator> skl(28);
+            for (auto x : in)
+                skl.insert(x);
+            for (auto x : in)
+                skl.erase(x);
+        }
+        PROFILE_STOP(1);
+
+        cout << "SimpleTypeAllocator : ";
+        PROFILE_START(2);
+        {
+            SkipList<int, SimpleTypeAllocator> skl(28);
+            for (auto x : in)
+                skl.insert(x);
+            for (auto x : in)
+                skl.erase(x);
+        }
+        PROFILE_STOP(2);
+    }
     cout << "OK!" << endl;
 }
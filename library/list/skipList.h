@@ -1,6 +1,11 @@
 #pragma once
 
-template <typename T>
+#include "../memory/fixedSizeAllocator.h"
+
+//  - AllocatorT : node allocator (TypeAllocator, SimpleTypeAllocator, NewTypeAllocator, ...)
+//      [CAUTION] the skip list is move-only because it owns its nodes (see memory/fixedSizeAllocator.h),
+//                a moved-from skip list can be destroyed or assigned only
+template <typename T, template <typename> class AllocatorT = TypeAllocator>
 struct SkipList {
     struct Node {
         T               value;
@@ -14,25 +19,56 @@ struct SkipList {
     int     maxHeight;      // 
     int     currHeight;     // 
 
+    AllocatorT<Node> allocator;
+
     explicit SkipList(int maxHeight = 30) : maxHeight(maxHeight) {
         head = createNode(T(), maxHeight);
         N = 0;
         currHeight = 0;
     }
 
+    SkipList(const SkipList&) = delete;
+    SkipList& operator =(const SkipList&) = delete;
+
+    SkipList(SkipList&& rhs)
+        : head(rhs.head), N(rhs.N), maxHeight(rhs.maxHeight), currHeight(rhs.currHeight),
+          allocator(std::move(rhs.allocator)) {
+        rhs.head = nullptr;
+        rhs.N = 0;
+        rhs.currHeight = 0;
+    }
+
+    SkipList& operator =(SkipList&& rhs) {
+        if (this != &rhs) {
+            release();
+
+            head = rhs.head;
+            N = rhs.N;
+            maxHeight = rhs.maxHeight;
+            currHeight = rhs.currHeight;
+            allocator = std::move(rhs.allocator);
+
+            rhs.head = nullptr;
+            rhs.N = 0;
+            rhs.currHeight = 0;
+        }
+        return *this;
+    }
+
     ~SkipList() {
-        clear();
-        delete head;
+        release();
     }
 
     void clear() {
         Node* it = head->next[0];
         while (it) {
             auto* next = it->next[0];
-            delete it;
+            destroy(it);
             it = next;
         }
         head->next.assign(maxHeight, nullptr);
+        N = 0;
+        currHeight = 0;
     }
 
     bool empty() const {
@@ -134,8 +170,8 @@ struct SkipList {
     }
 
 private:
-    static Node* createNode(const T& value, int height) {
-        Node* node = new Node;
+    Node* createNode(const T& value, int height) {
+        Node* node = allocator.construct();
         if (!node)
             return nullptr;
 
@@ -146,8 +182,16 @@ private:
         return node;
     }
 
-    static void destroy(Node* p) {
-        delete p;
+    void destroy(Node* p) {
+        allocator.destroy(p);
+    }
+
+    void release() {
+        if (head) {
+            clear();
+            destroy(head);
+            head = nullptr;
+        }
     }
 
     int getRandomLevel() {
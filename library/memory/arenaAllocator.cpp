@@ -0,0 +1,203 @@
+#include <cstring>
+#include <vector>
+#include <set>
+#include <thread>
+#include <algorithm>
+
+using namespace std;
+
+#include "arenaAllocator.h"
+
+/////////// For Testing ///////////////////////////////////////////////////////
+
+#include <time.h>
+#include <cassert>
+#include <string>
+#include <iostream>
+#include "../common/iostreamhelper.h"
+#include "../common/profile.h"
+#include "../common/rand.h"
+
+namespace {
+struct TestNode {
+    TestNode* left;
+    TestNode* right;
+    int value;
+
+    TestNode(int value, TestNode* left = nullptr, TestNode* right = nullptr)
+        : left(left), right(right), value(value) {
+    }
+};
+}
+
+void testArenaAllocator() {
+    //return; //TODO: if you want to test, make this line a comment.
+
+    cout << "--- Arena Allocator ----------------------------------" << endl;
+    {
+        ArenaAllocator arena(4096);
+
+        int N = 10000;
+        vector<long long*> v(N);
+        for (int i = 0; i < N; i++)
+            v[i] = arena.construct<long long>(i);
+
+        for (int i = 0; i < N; i++)
+            assert(*v[i] == i);
+
+        auto reserved = arena.stats().reservedBytes;
+        assert(arena.stats().allocCount == size_t(N));
+        assert(arena.stats().usedBytes == sizeof(long long) * N);
+
+        // reset() keeps blocks
+        arena.reset();
+        assert(arena.stats().usedBytes == 0);
+        for (int i = 0; i < N; i++)
+            v[i] = arena.construct<long long>(-i);
+        for (int i = 0; i < N; i++)
+            assert(*v[i] == -i);
+        assert(arena.stats().reservedBytes == reserved);
+
+        arena.release();
+        assert(arena.stats().reservedBytes == 0);
+    }
+    {
+        ArenaAllocator arena(1024);
+
+        // alignment and large allocations
+        for (int i = 0; i < 1000; i++) {
+            size_t align = size_t(1) << (RandInt32::get() % 8);
+            size_t size = RandInt32::get() % 3000 + 1;
+            auto* p = reinterpret_cast<unsigned char*>(arena.allocate(size, align));
+            assert(reinterpret_cast<uintptr_t>(p) % align == 0);
+            memset(p, 0xcc, size);
+        }
+    }
+    {
+        ArenaAllocator arena(ArenaAllocator::DEFAULT_BLOCK_SIZE, true);
+
+        int N = 1000000;
+        int* p = arena.allocate<int>(N);
+        for (int i = 0; i < N; i++)
+            p[i] = i;
+        for (int i = 0; i < N; i++)
+            assert(p[i] == i);
+    }
+    cout << "*** Concurrent arena" << endl;
+    {
+        ConcurrentArenaAllocator arena(4096);
+
+        int T = 4;
+        int N = 100000;
+        vector<vector<int*>> res(T);
+
+        for (int step = 0; step < 2; step++) {
+            vector<thread> threads;
+            for (int t = 0; t < T; t++) {
+                threads.emplace_back([&arena, &res, t, N]() {
+                    res[t].resize(N);
+                    for (int i = 0; i < N; i++)
+                        res[t][i] = arena.construct<int>(t * N + i);
+                });
+            }
+            for (auto& th : threads)
+                th.join();
+
+            for (int t = 0; t < T; t++) {
+                for (int i = 0; i < N; i++)
+                    assert(*res[t][i] == t * N + i);
+            }
+
+            auto st = arena.stats();
+            assert(st.allocCount == size_t(T) * N);
+            assert(st.usedBytes == sizeof(int) * T * N);
+
+            arena.reset();
+            assert(arena.stats().usedBytes == 0);
+        }
+    }
+    {
+        ArenaTypeAllocator<TestNode> allocator(128);
+
+        int N = 1000;
+        vector<TestNode*> v(N);
+        for (int i = 0; i < N; i++)
+            v[i] = allocator.construct(i, i ? v[i - 1] : nullptr);
+
+        for (int i = 0; i < N; i++) {
+            assert(v[i]->value == i);
+            assert(v[i]->left == (i ? v[i - 1] : nullptr));
+        }
+    }
+    cout << "OK!" << endl;
+
+    cout << "--- Arena Allocator Performance Test -----------------" << endl;
+    {
+        int N = 10000000;
+#ifdef _DEBUG
+        N = 100000;
+#endif
+        // build and drop a linked structure of N nodes, 3 times
+
+        cout << "*** new / delete" << endl;
+        PROFILE_START(0);
+        for (int step = 0; step < 3; step++) {
+            vector<TestNode*> v(N);
+            TestNode* last = nullptr;
+            for (int i = 0; i < N; i++)
+                v[i] = last = new TestNode(i, last);
+            for (auto* p : v)
+                delete p;
+        }
+        PROFILE_STOP(0);
+
+        cout << "*** ArenaAllocator" << endl;
+        PROFILE_START(1);
+        {
+            ArenaAllocator arena;
+            for (int step = 0; step < 3; step++) {
+                TestNode* last = nullptr;
+                for (int i = 0; i < N; i++)
+                    last = arena.construct<TestNode>(i, last);
+                arena.reset();
+            }
+            auto st = arena.stats();
+            cout << "reserved = " << st.reservedBytes << ", peak = " << st.peakUsedBytes << endl;
+        }
+        PROFILE_STOP(1);
+
+        cout << "*** ArenaAllocator with huge pages" << endl;
+        PROFILE_START(2);
+        {
+            ArenaAllocator arena(ArenaAllocator::HUGE_PAGE_SIZE * 16, true);
+            for (int step = 0; step < 3; step++) {
+                TestNode* last = nullptr;
+                for (int i = 0; i < N; i++)
+                    last = arena.construct<TestNode>(i, last);
+                arena.reset();
+            }
+        }
+        PROFILE_STOP(2);
+
+        cout << "*** ConcurrentArenaAllocator (4 threads)" << endl;
+        PROFILE_START(3);
+        {
+            ConcurrentArenaAllocator arena;
+            for (int step = 0; step < 3; step++) {
+                vector<thread> threads;
+                for (int t = 0; t < 4; t++) {
+                    threads.emplace_back([&arena, N]() {
+                        TestNode* last = nullptr;
+                        for (int i = 0; i < N / 4; i++)
+                            last = arena.construct<TestNode>(i, last);
+                    });
+                }
+                for (auto& th : threads)
+                    th.join();
+                arena.reset();
+            }
+        }
+        PROFILE_STOP(3);
+    }
+    cout << "OK!" << endl;
+}
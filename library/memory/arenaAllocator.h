@@ -0,0 +1,398 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdlib>
+#include <cstdint>
+#include <new>
+#include <memory>
+#include <vector>
+#include <utility>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <algorithm>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+//--------- Arena Allocator ---------------------------------------------------
+
+// Bump allocator over a list of blocks.
+//  - allocate() is a pointer increment in the common case
+//  - reset() releases all allocations in O(1), blocks are kept and reused
+//  - release() returns all blocks to the system
+//  - destructors of constructed objects are never called
+//  - if 'useHugePage' is true, blocks are aligned to 2MB and madvise(MADV_HUGEPAGE) is called (Linux only)
+// It's not thread-safe, use ConcurrentArenaAllocator to share an arena between threads.
+
+struct ArenaStats {
+    size_t allocCount;      // the number of allocate() calls since the last reset()
+    size_t usedBytes;       // requested bytes since the last reset()
+    size_t peakUsedBytes;   // max 'usedBytes' since construction
+    size_t reservedBytes;   // the total size of blocks
+    size_t blockCount;      //
+    size_t resetCount;      //
+
+    ArenaStats()
+        : allocCount(0), usedBytes(0), peakUsedBytes(0), reservedBytes(0), blockCount(0), resetCount(0) {
+    }
+
+    ArenaStats& operator +=(const ArenaStats& rhs) {
+        allocCount += rhs.allocCount;
+        usedBytes += rhs.usedBytes;
+        peakUsedBytes += rhs.peakUsedBytes;
+        reservedBytes += rhs.reservedBytes;
+        blockCount += rhs.blockCount;
+        resetCount = std::max(resetCount, rhs.resetCount);
+        return *this;
+    }
+};
+
+// counters of ArenaAllocator
+//   only the owner thread writes them, and other threads can read them (ConcurrentArenaAllocator::stats()),
+//   so they are atomic with relaxed ordering, and an update is a load and a store instead of a locked instruction
+struct ArenaCounters {
+    std::atomic<size_t> allocCount;
+    std::atomic<size_t> usedBytes;
+    std::atomic<size_t> peakUsedBytes;
+    std::atomic<size_t> reservedBytes;
+    std::atomic<size_t> blockCount;
+    std::atomic<size_t> resetCount;
+
+    ArenaCounters()
+        : allocCount(0), usedBytes(0), peakUsedBytes(0), reservedBytes(0), blockCount(0), resetCount(0) {
+    }
+
+    static size_t get(const std::atomic<size_t>& x) {
+        return x.load(std::memory_order_relaxed);
+    }
+
+    static void set(std::atomic<size_t>& x, size_t value) {
+        x.store(value, std::memory_order_relaxed);
+    }
+
+    static void add(std::atomic<size_t>& x, size_t value) {
+        x.store(x.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    }
+
+    ArenaStats load() const {
+        ArenaStats res;
+        res.allocCount = get(allocCount);
+        res.usedBytes = get(usedBytes);
+        res.peakUsedBytes = get(peakUsedBytes);
+        res.reservedBytes = get(reservedBytes);
+        res.blockCount = get(blockCount);
+        res.resetCount = get(resetCount);
+        return res;
+    }
+};
+
+struct ArenaAllocator {
+    static const size_t DEFAULT_BLOCK_SIZE = 1 << 20;
+    static const size_t HUGE_PAGE_SIZE = 2 << 20;
+    static const size_t DEFAULT_ALIGNMENT = alignof(std::max_align_t);
+
+    struct BlockT {
+        unsigned char* ptr;
+        size_t size;
+        bool hugePage;
+    };
+
+    size_t blockSize;
+    bool useHugePage;
+
+    std::vector<BlockT> blocks;
+    int currBlock;          // index of the current block, -1 if there is no block
+    unsigned char* curr;    // bump pointer in the current block
+    unsigned char* end;     //
+
+    ArenaCounters stat;
+
+    explicit ArenaAllocator(size_t blockSize = DEFAULT_BLOCK_SIZE, bool useHugePage = false)
+        : blockSize(blockSize), useHugePage(useHugePage), currBlock(-1), curr(nullptr), end(nullptr) {
+        if (useHugePage)
+            this->blockSize = (blockSize + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+    }
+
+    ~ArenaAllocator() {
+        release();
+    }
+
+    ArenaAllocator(const ArenaAllocator&) = delete;
+    ArenaAllocator& operator =(const ArenaAllocator&) = delete;
+
+
+    // PRECONDITION: 'align' is a power of 2
+    void* allocate(size_t size, size_t align = DEFAULT_ALIGNMENT) {
+        unsigned char* p = alignUp(curr, align);
+        if (!curr || size_t(end - curr) < size_t(p - curr) + size)
+            p = nextBlock(size, align);
+
+        curr = p + size;
+
+        size_t used = ArenaCounters::get(stat.usedBytes) + size;
+        ArenaCounters::add(stat.allocCount, 1);
+        ArenaCounters::set(stat.usedBytes, used);
+        if (used > ArenaCounters::get(stat.peakUsedBytes))
+            ArenaCounters::set(stat.peakUsedBytes, used);
+
+        return p;
+    }
+
+    template <typename T>
+    T* allocate(size_t n = 1) {
+        return reinterpret_cast<T*>(allocate(sizeof(T) * n, alignof(T)));
+    }
+
+    template <typename T, typename... Args>
+    T* construct(Args&&... args) {
+        return ::new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    }
+
+    // O(1), all pointers allocated by this arena become invalid
+    void reset() {
+        currBlock = -1;
+        curr = end = nullptr;
+
+        ArenaCounters::set(stat.allocCount, 0);
+        ArenaCounters::set(stat.usedBytes, 0);
+        ArenaCounters::add(stat.resetCount, 1);
+    }
+
+    // O(#blocks)
+    void release() {
+        for (auto& blk : blocks)
+            freeBlock(blk);
+        blocks.clear();
+
+        reset();
+        ArenaCounters::set(stat.reservedBytes, 0);
+        ArenaCounters::set(stat.blockCount, 0);
+    }
+
+    // a snapshot of the counters
+    ArenaStats stats() const {
+        return stat.load();
+    }
+
+private:
+    static unsigned char* alignUp(unsigned char* p, size_t align) {
+        return reinterpret_cast<unsigned char*>((reinterpret_cast<uintptr_t>(p) + align - 1) & ~uintptr_t(align - 1));
+    }
+
+    unsigned char* nextBlock(size_t size, size_t align) {
+        // reuse blocks kept by reset()
+        while (++currBlock < int(blocks.size())) {
+            auto& blk = blocks[currBlock];
+            unsigned char* p = alignUp(blk.ptr, align);
+            if (size_t(blk.ptr + blk.size - p) >= size) {
+                end = blk.ptr + blk.size;
+                return p;
+            }
+        }
+
+        BlockT blk = allocateBlock(std::max(blockSize, size + align));
+        blocks.push_back(blk);
+        currBlock = int(blocks.size()) - 1;
+
+        ArenaCounters::add(stat.reservedBytes, blk.size);
+        ArenaCounters::add(stat.blockCount, 1);
+
+        end = blk.ptr + blk.size;
+        return alignUp(blk.ptr, align);
+    }
+
+    BlockT allocateBlock(size_t size) {
+        BlockT blk;
+        blk.size = size;
+        blk.hugePage = false;
+#if defined(__linux__)
+        if (useHugePage) {
+            size = (size + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+
+            void* p = nullptr;
+            if (posix_memalign(&p, HUGE_PAGE_SIZE, size) == 0) {
+                madvise(p, size, MADV_HUGEPAGE);
+                blk.ptr = reinterpret_cast<unsigned char*>(p);
+                blk.size = size;
+                blk.hugePage = true;
+                return blk;
+            }
+        }
+#endif
+        blk.ptr = reinterpret_cast<unsigned char*>(::operator new(size));
+        return blk;
+    }
+
+    static void freeBlock(BlockT& blk) {
+        if (blk.hugePage)
+            free(blk.ptr);
+        else
+            ::operator delete(blk.ptr);
+    }
+};
+
+//--------- Concurrent Arena Allocator ----------------------------------------
+
+// Thread-safe arena with a bump arena per thread.
+//  - allocate() takes no lock after the first call in each thread
+//  - reset() is O(1), each thread arena is rewound lazily at its next allocation
+//    (PRECONDITION: no allocation is running during reset())
+//  - memory allocated by a thread can be used and kept by other threads until reset()
+struct ConcurrentArenaAllocator {
+    struct ThreadArenaT {
+        std::thread::id tid;
+        std::atomic<unsigned long long> epoch;  // written by the owner thread, read by stats()
+        ArenaAllocator arena;
+
+        ThreadArenaT(std::thread::id tid, unsigned long long epoch, size_t blockSize, bool useHugePage)
+            : tid(tid), epoch(epoch), arena(blockSize, useHugePage) {
+        }
+    };
+
+    size_t blockSize;
+    bool useHugePage;
+
+    unsigned long long id;                      // unique id of this allocator, never reused
+    std::atomic<unsigned long long> epoch;      // incremented by reset()
+
+    std::mutex mutex;
+    std::vector<std::unique_ptr<ThreadArenaT>> arenas;
+
+    explicit ConcurrentArenaAllocator(size_t blockSize = ArenaAllocator::DEFAULT_BLOCK_SIZE, bool useHugePage = false)
+        : blockSize(blockSize), useHugePage(useHugePage), id(newId()), epoch(0) {
+    }
+
+    ConcurrentArenaAllocator(const ConcurrentArenaAllocator&) = delete;
+    ConcurrentArenaAllocator& operator =(const ConcurrentArenaAllocator&) = delete;
+
+
+    void* allocate(size_t size, size_t align = ArenaAllocator::DEFAULT_ALIGNMENT) {
+        return threadArena().allocate(size, align);
+    }
+
+    template <typename T>
+    T* allocate(size_t n = 1) {
+        return threadArena().allocate<T>(n);
+    }
+
+    template <typename T, typename... Args>
+    T* construct(Args&&... args) {
+        return threadArena().construct<T>(std::forward<Args>(args)...);
+    }
+
+    // O(1)
+    void reset() {
+        epoch.fetch_add(1, std::memory_order_release);
+    }
+
+    // O(#threads + #blocks)
+    void release() {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto& it : arenas)
+            it->arena.release();
+    }
+
+    // the sum of all thread arenas
+    ArenaStats stats() {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        unsigned long long e = epoch.load(std::memory_order_acquire);
+
+        ArenaStats res;
+        for (auto& it : arenas) {
+            ArenaStats s = it->arena.stats();
+            if (it->epoch.load(std::memory_order_relaxed) != e) {
+                s.allocCount = 0;
+                s.usedBytes = 0;
+            }
+            res += s;
+        }
+        return res;
+    }
+
+    int threadCount() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return int(arenas.size());
+    }
+
+    // the arena of the current thread
+    ArenaAllocator& threadArena() {
+        static const int CACHE_SIZE = 4;    // power of 2
+        struct CacheT {
+            unsigned long long ownerId;
+            ThreadArenaT* arena;
+        };
+        static thread_local CacheT cache[CACHE_SIZE];
+
+        CacheT& c = cache[id & (CACHE_SIZE - 1)];
+        if (c.ownerId != id) {
+            c.arena = findThreadArena();
+            c.ownerId = id;
+        }
+
+        unsigned long long e = epoch.load(std::memory_order_acquire);
+        if (c.arena->epoch.load(std::memory_order_relaxed) != e) {
+            c.arena->arena.reset();
+            c.arena->epoch.store(e, std::memory_order_relaxed);
+        }
+
+        return c.arena->arena;
+    }
+
+private:
+    static unsigned long long newId() {
+        static std::atomic<unsigned long long> counter(1);
+        return counter.fetch_add(1);
+    }
+
+    ThreadArenaT* findThreadArena() {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        auto tid = std::this_thread::get_id();
+        for (auto& it : arenas) {
+            if (it->tid == tid)
+                return it.get();
+        }
+
+        arenas.push_back(std::unique_ptr<ThreadArenaT>(
+            new ThreadArenaT(tid, epoch.load(std::memory_order_acquire), blockSize, useHugePage)));
+        return arenas.back().get();
+    }
+};
+
+//--------- Arena Type Allocator ----------------------------------------------
+
+// It has the same interface as TypeAllocator, so it can be used as a node allocator of containers.
+//  - destroy() calls the destructor only, memory is reclaimed by reset()
+template <typename T>
+struct ArenaTypeAllocator {
+    ArenaAllocator arena;
+
+    explicit ArenaTypeAllocator(unsigned int chunkSize = 1024, bool useHugePage = false)
+        : arena(std::max(size_t(chunkSize) * sizeof(T), size_t(4096)), useHugePage) {
+    }
+
+    T* allocate() {
+        return arena.allocate<T>();
+    }
+
+    template <typename... Args>
+    T* construct(Args&&... args) {
+        return arena.construct<T>(std::forward<Args>(args)...);
+    }
+
+    void destroy(T* obj) {
+        obj->~T();
+    }
+
+    // O(1), PRECONDITION: all objects were destroyed or don't need destruction
+    void reset() {
+        arena.reset();
+    }
+
+    ArenaStats stats() const {
+        return arena.stats();
+    }
+};
@@ -22,6 +22,32 @@ struct FixedSizeAllocator {
           unusedCount(0), firstFreeBlock(nullptr) {
     }
 
+    FixedSizeAllocator(const FixedSizeAllocator&) = delete;
+    FixedSizeAllocator& operator =(const FixedSizeAllocator&) = delete;
+
+    FixedSizeAllocator(FixedSizeAllocator&& rhs)
+        : blockSize(rhs.blockSize), blockCountInChunk(rhs.blockCountInChunk),
+          unusedCount(rhs.unusedCount), firstFreeBlock(rhs.firstFreeBlock), groups(std::move(rhs.groups)) {
+        rhs.unusedCount = 0;
+        rhs.firstFreeBlock = nullptr;
+        rhs.groups.clear();
+    }
+
+    FixedSizeAllocator& operator =(FixedSizeAllocator&& rhs) {
+        if (this != &rhs) {
+            blockSize = rhs.blockSize;
+            blockCountInChunk = rhs.blockCountInChunk;
+            unusedCount = rhs.unusedCount;
+            firstFreeBlock = rhs.firstFreeBlock;
+            groups = std::move(rhs.groups);
+
+            rhs.unusedCount = 0;
+            rhs.firstFreeBlock = nullptr;
+            rhs.groups.clear();
+        }
+        return *this;
+    }
+
     ~FixedSizeAllocator() {
     }
 
@@ -47,12 +73,25 @@ struct FixedSizeAllocator {
     }
 };
 
+// [CAUTION] pooled allocators (TypeAllocator, SimpleTypeAllocator)
+//  - they own their chunks and are move-only, so a container which keeps one as a member is move-only too
+//  - chunks are returned to the system only when the allocator is destroyed,
+//    TypeAllocator reuses freed nodes and SimpleTypeAllocator never reuses them
+//  - NewTypeAllocator has the same interface with plain new / delete
 template <typename T>
 struct TypeAllocator : public FixedSizeAllocator {
-    explicit TypeAllocator(unsigned int chunkSize)
+    static const unsigned int DEFAULT_CHUNK_SIZE = 1024;
+
+    explicit TypeAllocator(unsigned int chunkSize = DEFAULT_CHUNK_SIZE)
         : FixedSizeAllocator(sizeof(T), chunkSize) {
     }
 
+    TypeAllocator(const TypeAllocator&) = delete;
+    TypeAllocator& operator =(const TypeAllocator&) = delete;
+
+    TypeAllocator(TypeAllocator&&) = default;
+    TypeAllocator& operator =(TypeAllocator&&) = default;
+
     ~TypeAllocator() {
     }
 
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <utility>
+
+// plain new / delete, it has the same interface as TypeAllocator and SimpleTypeAllocator (without chunk size)
+//  - every node is freed by destroy()
+template <typename T>
+struct NewTypeAllocator {
+    NewTypeAllocator() = default;
+
+    NewTypeAllocator(const NewTypeAllocator&) = delete;
+    NewTypeAllocator& operator =(const NewTypeAllocator&) = delete;
+
+    NewTypeAllocator(NewTypeAllocator&&) = default;
+    NewTypeAllocator& operator =(NewTypeAllocator&&) = default;
+
+    T* allocate() {
+        return reinterpret_cast<T*>(::operator new(sizeof(T)));
+    }
+
+    template <typename... Args>
+    T* construct(Args&&... args) {
+        return new T(std::forward<Args>(args)...);
+    }
+
+    void destroy(T* obj) {
+        delete obj;
+    }
+};
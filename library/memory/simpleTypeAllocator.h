@@ -1,33 +1,41 @@
 #pragma once
 
-#include <stack>
+#include <vector>
 #include <memory>
 
-// no free
+// no free, see the caveats of pooled allocators in fixedSizeAllocator.h
 template <typename T>
 struct SimpleTypeAllocator {
     struct ChunkT {
         int n;
-        std::unique_ptr<unsigned char> values;
+        std::unique_ptr<unsigned char[]> values;
 
         explicit ChunkT(size_t size) : n(0), values(new unsigned char[sizeof(T) * size]) {
         }
     };
 
     int chunkSize;
-    std::stack<std::unique_ptr<ChunkT>> chunks;
+    std::vector<std::unique_ptr<ChunkT>> chunks;
 
-    explicit SimpleTypeAllocator(int chunkSize) : chunkSize(chunkSize) {
+    static const int DEFAULT_CHUNK_SIZE = 1024;
+
+    explicit SimpleTypeAllocator(int chunkSize = DEFAULT_CHUNK_SIZE) : chunkSize(chunkSize) {
     }
 
+    SimpleTypeAllocator(const SimpleTypeAllocator&) = delete;
+    SimpleTypeAllocator& operator =(const SimpleTypeAllocator&) = delete;
+
+    SimpleTypeAllocator(SimpleTypeAllocator&&) = default;
+    SimpleTypeAllocator& operator =(SimpleTypeAllocator&&) = default;
+
     ~SimpleTypeAllocator() {
     }
 
     T* allocate() {
-        if (chunks.empty() || chunks.top()->n >= chunkSize)
-            chunks.push(std::make_unique<ChunkT>(chunkSize));
+        if (chunks.empty() || chunks.back()->n >= chunkSize)
+            chunks.push_back(std::make_unique<ChunkT>(chunkSize));
 
-        return reinterpret_cast<T*>(chunks.top()->values.get() + sizeof(T) * chunks.top()->n++);
+        return reinterpret_cast<T*>(chunks.back()->values.get() + sizeof(T) * chunks.back()->n++);
     }
 
     template <typename... Args>
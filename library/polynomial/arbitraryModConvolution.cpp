@@ -0,0 +1,131 @@
+#include <vector>
+#include <algorithm>
+
+using namespace std;
+
+#include "arbitraryModConvolution.h"
+#include "polyFFTMod.h"
+#include "convolutionMod.h"
+
+/////////// For Testing ///////////////////////////////////////////////////////
+
+#include <time.h>
+#include <cassert>
+#include <string>
+#include <iostream>
+#include <iomanip>
+#include <functional>
+#include "../common/iostreamhelper.h"
+#include "../common/profile.h"
+#include "../common/rand.h"
+
+namespace {
+template <int mod>
+vector<int> makeArbitraryModInput(int n) {
+    vector<int> res(n);
+    for (auto& x : res)
+        x = RandInt32::get() % mod;
+    return res;
+}
+
+template <int mod>
+void checkArbitraryModConvolution() {
+    typedef ArbitraryModConvolution<mod> ConvT;
+
+    for (int n : { 1, 2, 255, 256, 1000, 4097, 30000 }) {
+        for (int m : { 1, 255, 256, 3000 }) {
+            auto A = makeArbitraryModInput<mod>(n);
+            auto B = makeArbitraryModInput<mod>(m);
+
+            auto gt = ConvT::multiplyNaive(A, B);
+            assert(ConvT::multiply(A, B) == gt);
+            assert(ConvT::multiply(A, B, ConvT::methodNTT) == gt);
+            assert(ConvT::multiply(A, B, ConvT::methodFFT) == gt);
+            assert(ConvT::multiply(A, B, ConvT::methodNTT3) == gt);
+            assert(ConvT::multiply(A, B, ConvT::methodAuto, 3) == gt);
+        }
+
+        auto A = makeArbitraryModInput<mod>(n);
+        auto gt = ConvT::multiply(A, A, ConvT::methodNTT3);
+        assert(ConvT::square(A) == gt);
+        assert(ConvT::square(A, ConvT::methodFFT) == gt);
+        assert(ConvT::square(A, ConvT::methodNTT) == gt);
+        assert(ConvT::square(A, ConvT::methodNTT, 3) == gt);
+        assert(ConvT::square(A, ConvT::methodAuto, 3) == gt);
+    }
+
+    // the worst case of the split FFT
+    {
+        vector<int> A(1 << 17, mod / 2);
+        auto gt = ConvT::multiply(A, A, ConvT::methodNTT3);
+        assert(ConvT::multiply(A, A, ConvT::methodFFT) == gt);
+        assert(ConvT::square(A, ConvT::methodFFT) == gt);
+    }
+}
+
+template <int mod>
+void benchmarkArbitraryModConvolution(int maxLogN) {
+    typedef ArbitraryModConvolution<mod> ConvT;
+
+    cout << "mod = " << mod << (ConvT::nttFriendly ? " (NTT-friendly)" : "") << endl;
+    cout << "        N     naive       FFT       NTT      NTT3 PolyFFTMod   ConvMod      auto | FFT error (random, worst)" << endl;
+    for (int logN = 6; logN <= maxLogN; logN++) {
+        int n = 1 << logN;
+        auto A = makeArbitraryModInput<mod>(n / 2);
+        auto B = makeArbitraryModInput<mod>(n / 2);
+
+        int repeat = max(1, (1 << 20) / n);
+        auto measure = [repeat](const function<vector<int>()>& f) {
+            AccumulateTimer timer;
+            timer.start();
+            for (int i = 0; i < repeat; i++)
+                f();
+            timer.stop();
+            return timer.getMillisec() / repeat;
+        };
+
+        // builds twiddle tables
+        ConvT::multiply(A, B, ConvT::methodNTT);
+        ConvT::multiply(A, B, ConvT::methodNTT3);
+
+        cout << setw(9) << n << fixed << setprecision(3);
+        if (n <= (1 << 13))
+            cout << setw(10) << measure([&]() { return ConvT::multiply(A, B, ConvT::methodNaive); });
+        else
+            cout << setw(10) << "-";
+        cout << setw(10) << measure([&]() { return ConvT::multiplyFFT(A, B); });
+        if (ConvT::nttFriendly)
+            cout << setw(10) << measure([&]() { return ConvT::multiply(A, B, ConvT::methodNTT); });
+        else
+            cout << setw(10) << "-";
+        cout << setw(10) << measure([&]() { return ConvT::multiply(A, B, ConvT::methodNTT3); });
+        cout << setw(11) << measure([&]() { return PolyFFTMod<mod>::multiply(A, B); });
+        cout << setw(10) << measure([&]() { return ConvolutionMod<mod>::convolute(A, B); });
+        cout << setw(10) << measure([&]() { return ConvT::multiply(A, B); });
+
+        // rounding errors of random inputs and the worst case
+        double err = 0.0, worstErr = 0.0;
+        ConvT::multiplyFFT(A, B, &err);
+        ConvT::multiplyFFT(vector<int>(n / 2, mod / 2), vector<int>(n / 2, mod / 2), &worstErr);
+        cout << " | " << setprecision(6) << err << ", " << worstErr << endl;
+    }
+    cout.unsetf(ios::fixed);
+}
+}
+
+void testArbitraryModConvolution() {
+    return; //TODO: if you want to test, make this line a comment.
+
+    cout << "--- Arbitrary Modulus Convolution ----------------" << endl;
+
+    checkArbitraryModConvolution<1000000007>();
+    checkArbitraryModConvolution<998244353>();
+    checkArbitraryModConvolution<2147483647>();
+
+    cout << "OK!" << endl;
+
+    // time (ms) per multiplication of two polynomials of size N / 2
+    cout << "*** Speed test ***" << endl;
+    benchmarkArbitraryModConvolution<1000000007>(22);
+    benchmarkArbitraryModConvolution<998244353>(22);
+}
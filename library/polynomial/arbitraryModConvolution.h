@@ -0,0 +1,311 @@
+#pragma once
+
+#include <cmath>
+#include <type_traits>
+
+#include "fft.h"
+#include "ntt_fast.h"
+#include "polyNTT.h"
+
+// Convolution modulo an arbitrary modulus (mod < 2^31)
+//
+//   ArbitraryModConvolution<mod>::multiply(a, b) chooses a method by the sizes and the modulus.
+//     1) methodNaive : O(N*M), when min(sizeA, sizeB) < NAIVE_THRESHOLD
+//     2) methodNTT   : one FastNTT convolution, when 'mod' is an NTT-friendly prime (see NTTPrimeTraits)
+//     3) methodFFT   : split FFT with 4 FFTs (PolyFFTMod and ConvolutionMod use 7), without AVX2,
+//                      the result size must be <= FFT_MAX_SIZE to keep rounding errors below 0.5, or methodNTT3 is used
+//     4) methodNTT3  : three NTT primes + Garner (PolyNTT::multiplyParallel), exact for any size <= 2^23
+//
+//   The thresholds come from the benchmark matrix in arbitraryModConvolution.cpp, and the ranking depends on the target.
+//     - NTT methods fall back to O(N*M) when min(sizeA, sizeB) < 256, and methodNaive is faster than that
+//     - methodNTT is the fastest when 'mod' is NTT-friendly, about 2x faster than methodFFT without AVX2
+//     - with AVX2 (g++ -O2 -march=haswell), methodNTT3 is faster than methodFFT from N = 2^11 and 2.5x faster at 2^20
+//     - without AVX2 (g++ -O2), methodFFT is 1.2~1.6x faster than methodNTT3 from N = 2^9 to 2^22,
+//       so methodAuto chooses methodFFT up to FFT_MAX_SIZE
+//
+// PRECONDITION: 0 <= a[i], b[i] < mod
+
+// NTT-friendly primes (mod = c * 2^k + 1, k >= 23)
+template <int mod>
+struct NTTPrimeTraits {
+    static const int root = 0;      // 0 if 'mod' is not a known NTT-friendly prime
+};
+
+template <>
+struct NTTPrimeTraits<998244353> {
+    static const int root = 3;      // 119 * 2^23 + 1
+};
+
+template <>
+struct NTTPrimeTraits<167772161> {
+    static const int root = 3;      // 5 * 2^25 + 1
+};
+
+template <>
+struct NTTPrimeTraits<469762049> {
+    static const int root = 3;      // 7 * 2^26 + 1
+};
+
+template <>
+struct NTTPrimeTraits<754974721> {
+    static const int root = 11;     // 45 * 2^24 + 1
+};
+
+template <int mod>
+struct ArbitraryModConvolution {
+    static const int SCALE = 32768;
+    static const int NAIVE_THRESHOLD = 256;
+    static const int NTT_MAX_BIT_SIZE = 23;
+    // the max rounding error of the worst case (all a[i] = b[i] = mod / 2)
+    //   - mod < 2^30 : about 0.22 at 2^21 and 0.25~0.31 at 2^22
+    //   - mod < 2^31 : about 0.31 at 2^20 and 0.5 (wrong results) at 2^21
+    static const int FFT_MAX_SIZE = (mod < (1 << 30)) ? (1 << 21) : (1 << 20);
+
+    enum MethodT {
+        methodAuto,
+        methodNaive,
+        methodNTT,      // methodNTT3 if 'mod' is not NTT-friendly
+        methodFFT,
+        methodNTT3
+    };
+
+    static const bool nttFriendly = NTTPrimeTraits<mod>::root != 0;
+
+    static MethodT chooseMethod(int sizeA, int sizeB) {
+        if (min(sizeA, sizeB) < NAIVE_THRESHOLD)
+            return methodNaive;
+
+        int size = ceilPow2(sizeA + sizeB - 1);
+        if (nttFriendly && size <= (1 << NTT_MAX_BIT_SIZE))
+            return methodNTT;
+#if !defined(__AVX2__)
+        if (size <= FFT_MAX_SIZE)
+            return methodFFT;
+#endif
+        return methodNTT3;
+    }
+
+    // 'threadN' is used by NTT methods only
+    static vector<int> multiply(const vector<int>& a, const vector<int>& b, MethodT method = methodAuto, int threadN = 1) {
+        if (a.empty() || b.empty())
+            return vector<int>();
+
+        if (method == methodAuto)
+            method = chooseMethod(int(a.size()), int(b.size()));
+
+        switch (method) {
+        case methodNaive:
+            return multiplyNaive(a, b);
+        case methodNTT:
+            return multiplyNTT(a, b, threadN, std::integral_constant<bool, nttFriendly>());
+        case methodFFT:
+            if (ceilPow2(int(a.size()) + int(b.size()) - 1) <= FFT_MAX_SIZE)
+                return multiplyFFT(a, b);
+            // fall through
+        default:
+            return PolyNTT<mod, 3>::multiplyParallel(a, b, threadN);
+        }
+    }
+
+    // 'threadN' is used by NTT methods only
+    static vector<int> square(const vector<int>& a, MethodT method = methodAuto, int threadN = 1) {
+        if (a.empty())
+            return vector<int>();
+
+        if (method == methodAuto)
+            method = chooseMethod(int(a.size()), int(a.size()));
+
+        switch (method) {
+        case methodNaive:
+            return multiplyNaive(a, a);
+        case methodNTT:
+            return squareNTT(a, threadN, std::integral_constant<bool, nttFriendly>());
+        case methodFFT:
+            if (ceilPow2(int(a.size()) + int(a.size()) - 1) <= FFT_MAX_SIZE)
+                return squareFFT(a);
+            // fall through
+        default:
+            return PolyNTT<mod, 3>::multiplyParallel(a, a, threadN);
+        }
+    }
+
+    //--- methods
+
+    static vector<int> multiplyNaive(const vector<int>& a, const vector<int>& b) {
+        // x * y < mod^2 < 2^62, so a sum of two terms doesn't overflow
+        const unsigned long long MOD_SQ = 1ull * mod * mod;
+
+        vector<unsigned long long> acc(a.size() + b.size() - 1);
+        for (int i = 0; i < int(a.size()); i++) {
+            unsigned long long x = unsigned(a[i]);
+            unsigned long long* dst = acc.data() + i;
+            for (int j = 0; j < int(b.size()); j++) {
+                unsigned long long t = dst[j] + x * unsigned(b[j]);
+                dst[j] = t >= MOD_SQ ? t - MOD_SQ : t;
+            }
+        }
+
+        vector<int> res(acc.size());
+        for (int i = 0; i < int(res.size()); i++)
+            res[i] = int(acc[i] % mod);
+        return res;
+    }
+
+    // a[i] = a1[i] * SCALE + a2[i], b[i] = b1[i] * SCALE + b2[i]
+    //   P = FFT(a1 + i*a2), Q = FFT(b1 + i*b2)
+    //   A1 = (P[k] + conj(P[-k])) / 2, A2 = (P[k] - conj(P[-k])) / 2i
+    //   IFFT(A1 * Q) = a1*b1 + i*a1*b2, IFFT(A2 * Q) = a2*b1 + i*a2*b2
+    // transforms are in struct-of-arrays and bit-reversed order (FFT::transform())
+    // 'maxError' is the max distance from outputs of IFFT to the nearest integers, if it's not null
+    static vector<int> multiplyFFT(const vector<int>& a, const vector<int>& b, double* maxError = nullptr) {
+        int n = int(a.size() + b.size()) - 1;
+        int size = ceilPow2(n);
+
+        ComplexArray P(size), Q(size);
+        split(a, P);
+        split(b, Q);
+        FFT::transform(P.re.data(), P.im.data(), size);
+        FFT::transform(Q.re.data(), Q.im.data(), size);
+
+        ComplexArray U(size), V(size);
+        for (int k = 0; k < size; k++) {
+            int j = FFT::conjugatePosition(k);
+            pair<double, double> a1, a2;
+            extract(P.at(k), P.at(j), a1, a2);
+            U.set(k, mul(a1, Q.at(k)));
+            V.set(k, mul(a2, Q.at(k)));
+        }
+        FFT::transformInv(U.re.data(), U.im.data(), size);
+        FFT::transformInv(V.re.data(), V.im.data(), size);
+
+        return merge(U, V, n, size, maxError);
+    }
+
+    // 3 FFTs
+    static vector<int> squareFFT(const vector<int>& a, double* maxError = nullptr) {
+        int n = int(a.size()) * 2 - 1;
+        int size = ceilPow2(n);
+
+        ComplexArray P(size);
+        split(a, P);
+        FFT::transform(P.re.data(), P.im.data(), size);
+
+        ComplexArray U(size), V(size);
+        for (int k = 0; k < size; k++) {
+            int j = FFT::conjugatePosition(k);
+            pair<double, double> a1, a2;
+            extract(P.at(k), P.at(j), a1, a2);
+            U.set(k, mul(a1, P.at(k)));
+            V.set(k, mul(a2, P.at(k)));
+        }
+        FFT::transformInv(U.re.data(), U.im.data(), size);
+        FFT::transformInv(V.re.data(), V.im.data(), size);
+
+        return merge(U, V, n, size, maxError);
+    }
+
+//private:
+    static int ceilPow2(int n) {
+        int size = 1;
+        while (size < n)
+            size <<= 1;
+        return size;
+    }
+
+    static vector<int> multiplyNTT(const vector<int>& a, const vector<int>& b, int threadN, std::true_type) {
+        return FastNTT<mod, NTTPrimeTraits<mod>::root, NTT_MAX_BIT_SIZE>::multiplyParallel(a, b, threadN);
+    }
+
+    static vector<int> multiplyNTT(const vector<int>& a, const vector<int>& b, int threadN, std::false_type) {
+        return PolyNTT<mod, 3>::multiplyParallel(a, b, threadN);
+    }
+
+    static vector<int> squareNTT(const vector<int>& a, int threadN, std::true_type) {
+        return FastNTT<mod, NTTPrimeTraits<mod>::root, NTT_MAX_BIT_SIZE>::squareParallel(a, threadN);
+    }
+
+    static vector<int> squareNTT(const vector<int>& a, int threadN, std::false_type) {
+        return PolyNTT<mod, 3>::multiplyParallel(a, a, threadN);
+    }
+
+    struct ComplexArray {
+        vector<double> re, im;
+
+        explicit ComplexArray(int n) : re(n), im(n) {
+        }
+
+        pair<double, double> at(int i) const {
+            return make_pair(re[i], im[i]);
+        }
+
+        void set(int i, const pair<double, double>& x) {
+            re[i] = x.first;
+            im[i] = x.second;
+        }
+    };
+
+    // a[i] = hi * SCALE + lo, with balanced digits to reduce rounding errors
+    //   a[i] is moved into (-mod/2, mod/2], so |hi| <= 2^15 and -2^14 <= lo < 2^14
+    static void split(const vector<int>& a, ComplexArray& out) {
+        for (int i = 0; i < int(a.size()); i++) {
+            int v = a[i] > mod / 2 ? a[i] - mod : a[i];
+            int lo = v & (SCALE - 1);
+            if (lo >= SCALE / 2)
+                lo -= SCALE;
+            out.re[i] = (v - lo) / SCALE;
+            out.im[i] = lo;
+        }
+    }
+
+    // the FFTs of real and imaginary parts from p = P[k] and q = P[-k]
+    static void extract(const pair<double, double>& p, const pair<double, double>& q,
+                        pair<double, double>& re, pair<double, double>& im) {
+        re.first = (p.first + q.first) * 0.5;
+        re.second = (p.second - q.second) * 0.5;
+        im.first = (p.second + q.second) * 0.5;
+        im.second = (q.first - p.first) * 0.5;
+    }
+
+    static pair<double, double> mul(const pair<double, double>& x, const pair<double, double>& y) {
+        return make_pair(x.first * y.first - x.second * y.second, x.first * y.second + x.second * y.first);
+    }
+
+    static int toMod(double x) {
+        long long v = llround(x) % mod;
+        return int(v < 0 ? v + mod : v);
+    }
+
+    // U and V are outputs of FFT::transformInv() without scaling by 1/size
+    static vector<int> merge(ComplexArray& U, ComplexArray& V, int n, int size, double* maxError) {
+        const long long SCALE_MOD = SCALE % mod;
+        const long long SCALE2_MOD = 1ll * SCALE * SCALE % mod;
+
+        double inv = 1.0 / size;
+        for (int i = 0; i < n; i++) {
+            U.re[i] *= inv;
+            U.im[i] *= inv;
+            V.re[i] *= inv;
+            V.im[i] *= inv;
+        }
+
+        vector<int> res(n);
+        for (int i = 0; i < n; i++) {
+            long long hi = toMod(U.re[i]);
+            long long mid = (long long)toMod(U.im[i]) + toMod(V.re[i]);
+            long long lo = toMod(V.im[i]);
+            res[i] = int((hi * SCALE2_MOD + mid * SCALE_MOD + lo) % mod);
+        }
+
+        if (maxError) {
+            double err = 0.0;
+            for (int i = 0; i < n; i++) {
+                err = max(err, fabs(U.re[i] - nearbyint(U.re[i])));
+                err = max(err, fabs(U.im[i] - nearbyint(U.im[i])));
+                err = max(err, fabs(V.re[i] - nearbyint(V.re[i])));
+                err = max(err, fabs(V.im[i] - nearbyint(V.im[i])));
+            }
+            *maxError = err;
+        }
+        return res;
+    }
+};
@@ -148,6 +148,22 @@ void testConvolution() {
             cout << "ERROR at " << __LINE__ << endl;
         assert(v == v2);
     }
+    {
+        // real-input convolution with negative values
+        for (int n : { 1, 5, 100, 1000 }) {
+            vector<int> x(n), h(n / 3 + 1);
+            for (auto& v : x)
+                v = int(RandInt32::get() % 65536) - 32768;
+            for (auto& v : h)
+                v = int(RandInt32::get() % 65536) - 32768;
+
+            for (bool reverseH : { true, false }) {
+                auto gt = Convolution::convoluteSlow(x, h, reverseH);
+                assert(Convolution::convolute(x, h, reverseH) == gt);
+                assert(conv.convolute(x, h, reverseH) == gt);
+            }
+        }
+    }
     cout << "*** Speed test ***" << endl;
     {
         for (int n = 32; n <= 2048; n <<= 1) {
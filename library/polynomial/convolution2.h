@@ -32,42 +32,25 @@ struct Convolution2 : public FFT2 {
     }
 
     // It's better performance than convoluteSlow() when N >= 128
+    // real-input convolution, two inputs are packed into one complex FFT (see FFT2::multiplyReal())
     vector<int> convolute(const vector<int>& x, const vector<int>& h, bool reverseH = true) {
-        int sizeL = int(x.size());
         int sizeR = int(h.size());
-        int sizeDst = sizeL + sizeR - 1;
 
-        int size = 1;
-        while (size < sizeDst)
-            size <<= 1;
-
-        vector<pair<double,double>> A(size);
-        vector<pair<double,double>> B(size);
-        for (int i = 0; i < sizeL; i++)
-            A[i].first = x[i];
+        vector<double> A(x.begin(), x.end());
+        vector<double> B(sizeR);
         if (reverseH) {
             for (int i = 0; i < sizeR; i++)
-                B[i].first = h[i];
+                B[i] = h[i];
         } else {
             for (int i = 0, j = sizeR - 1; j >= 0; i++, j--)
-                B[i].first = h[j];
-        }
-
-        fft(A);
-        fft(B);
-
-        vector<pair<double,double>> C(size);
-        for (int i = 0; i < size; i++) {
-            //C[i] = A[i] * B[i];
-            C[i].first = A[i].first * B[i].first - A[i].second * B[i].second;
-            C[i].second = A[i].first * B[i].second + A[i].second * B[i].first;
+                B[i] = h[j];
         }
 
-        fft(C, true);
+        auto C = multiplyReal(A, B);
 
-        vector<int> res(sizeDst);
-        for (int i = 0; i < sizeDst; i++)
-            res[i] = int(C[i].first + 0.5);
+        vector<int> res(C.size());
+        for (int i = 0; i < int(C.size()); i++)
+            res[i] = int(llround(C[i]));
 
         return res;
     }
@@ -12,6 +12,7 @@ using namespace std;
 #include <cassert>
 #include <string>
 #include <iostream>
+#include <iomanip>
 #include "../common/iostreamhelper.h"
 #include "../common/profile.h"
 #include "../common/rand.h"
@@ -34,6 +35,49 @@ static bool check2(const vector<pair<double,double>>& l, const vector<pair<doubl
     return true;
 }
 
+namespace {
+// the previous convolution with three complex transforms of FFT::fft()
+vector<double> multiplyWithComplexFFT(const vector<double>& a, const vector<double>& b) {
+    int n = int(a.size() + b.size()) - 1;
+    int size = 1;
+    while (size < n)
+        size <<= 1;
+
+    vector<pair<double,double>> A(size), B(size);
+    for (int i = 0; i < int(a.size()); i++)
+        A[i].first = a[i];
+    for (int i = 0; i < int(b.size()); i++)
+        B[i].first = b[i];
+    FFT::fft(A);
+    FFT::fft(B);
+    for (int i = 0; i < size; i++)
+        A[i] = make_pair(A[i].first * B[i].first - A[i].second * B[i].second,
+                         A[i].first * B[i].second + A[i].second * B[i].first);
+    FFT::fft(A, true);
+
+    vector<double> res(n);
+    for (int i = 0; i < n; i++)
+        res[i] = A[i].first;
+    return res;
+}
+
+vector<long long> multiplyExact(const vector<double>& a, const vector<double>& b) {
+    vector<long long> res(a.size() + b.size() - 1);
+    for (int i = 0; i < int(a.size()); i++) {
+        for (int j = 0; j < int(b.size()); j++)
+            res[i + j] += (long long)a[i] * (long long)b[j];
+    }
+    return res;
+}
+
+double maxError(const vector<double>& c, const vector<long long>& gt) {
+    double err = 0.0;
+    for (int i = 0; i < int(c.size()); i++)
+        err = max(err, fabs(c[i] - double(gt[i])));
+    return err;
+}
+}
+
 void testFFT() {
     return; //TODO: if you want to test, make this line a comment.
 
@@ -60,6 +104,72 @@ void testFFT() {
     FFT::fft(out1);
     assert(out1 == out2);
 
+    // struct-of-arrays FFT
+    for (int n = 1; n <= (1 << 12); n <<= 1) {
+        vector<pair<double,double>> in(n), out(n);
+        vector<double> re(n), im(n);
+        for (int i = 0; i < n; i++) {
+            in[i].first = re[i] = RandInt32::get() % 1024;
+            in[i].second = im[i] = RandInt32::get() % 1024;
+        }
+
+        // the fallback of transforms larger than MAXN
+        vector<double> re2(re), im2(im);
+        FFT::transformLarge(re2.data(), im2.data(), n, false);
+
+        FFT::fft(in, out);
+        FFT::transform(re.data(), im.data(), n);
+        for (int i = 0, j = 0; i < n; i++) {
+            assert(fabs(re[j] - out[i].first) < EPSILON2 && fabs(im[j] - out[i].second) < EPSILON2);
+            assert(fabs(re2[j] - out[i].first) < EPSILON2 && fabs(im2[j] - out[i].second) < EPSILON2);
+
+            int mask = n;
+            while (j & (mask >>= 1))
+                j &= ~mask;
+            j |= mask;
+        }
+
+        FFT::transformInv(re.data(), im.data(), n);
+        FFT::transformLarge(re2.data(), im2.data(), n, true);
+        for (int i = 0; i < n; i++) {
+            assert(fabs(re[i] / n - in[i].first) < EPSILON2 && fabs(im[i] / n - in[i].second) < EPSILON2);
+            assert(fabs(re2[i] / n - in[i].first) < EPSILON2 && fabs(im2[i] / n - in[i].second) < EPSILON2);
+        }
+    }
+
+    // precision of real-input convolution, it must be as good as three complex transforms
+    {
+        cout << "  bits       N | error (3 complex FFTs, real-input FFT)" << endl;
+        for (int bits : { 10, 15 }) {
+            for (int n : { 1, 2, 3, 100, 1000, 10000 }) {
+                vector<double> A(n), B(n + 7);
+                for (auto& x : A)
+                    x = RandInt32::get() % (1 << bits);
+                for (auto& x : B)
+                    x = RandInt32::get() % (1 << bits);
+                auto gt = multiplyExact(A, B);
+
+                double err1 = maxError(multiplyWithComplexFFT(A, B), gt);
+                double err2 = maxError(FFT::multiplyReal(A, B), gt);
+                cout << setw(6) << bits << setw(8) << n << " | " << err1 << ", " << err2 << endl;
+                assert(err2 < 0.1 && err2 <= 4.0 * err1 + 1e-6);
+            }
+        }
+
+        // the worst case, all values are the max
+        for (int n : { 1 << 16, 1 << 19 }) {
+            vector<double> A(n, (1 << 15) - 1);
+            vector<long long> gt(2 * n - 1);
+            for (int i = 0; i < 2 * n - 1; i++)
+                gt[i] = 1ll * ((1 << 15) - 1) * ((1 << 15) - 1) * min(i + 1, 2 * n - 1 - i);
+
+            double err1 = maxError(multiplyWithComplexFFT(A, A), gt);
+            double err2 = maxError(FFT::multiplyReal(A, A), gt);
+            cout << setw(6) << 15 << setw(8) << n << " | " << err1 << ", " << err2 << endl;
+            assert(err2 < 0.5 && err2 <= 4.0 * err1);
+        }
+    }
+
     cout << "*** Speed test ***" << endl;
     for (int n = 32; n <= 2048; n <<= 1) {
         vector<pair<double,double>> in(n);
@@ -88,6 +198,32 @@ void testFFT() {
             cout << "ERROR at " << __LINE__ << endl;
         assert(check2(out1, out2));
     }
+    for (int n = (1 << 16); n <= (1 << 20); n <<= 2) {
+        vector<double> A(n / 2), B(n / 2);
+        for (int i = 0; i < n / 2; i++) {
+            A[i] = RandInt32::get() % 1024;
+            B[i] = RandInt32::get() % 1024;
+        }
+
+        vector<double> out1, out2;
+
+        cout << "N = " << n << endl;
+
+        cout << "  convolution with 3 complex FFTs : ";
+        PROFILE_START(0);
+        for (int i = 0; i < 10; i++)
+            out1 = multiplyWithComplexFFT(A, B);
+        PROFILE_STOP(0);
+
+        cout << "  convolution with real-input FFT : ";
+        PROFILE_START(1);
+        for (int i = 0; i < 10; i++)
+            out2 = FFT::multiplyReal(A, B);
+        PROFILE_STOP(1);
+
+        for (int i = 0; i < n - 1; i++)
+            assert(llround(out1[i]) == llround(out2[i]));
+    }
 
     cout << "OK!" << endl;
 }
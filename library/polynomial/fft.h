@@ -1,5 +1,14 @@
 #pragma once
 
+#include <cmath>
+#include <cstring>
+#include <mutex>
+#include <atomic>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
 #ifndef M_PI
 #define M_PI       3.14159265358979323846   // pi
 #endif
@@ -89,4 +98,414 @@ struct FFT {
 
         return true;
     }
+
+    //--- struct-of-arrays FFT ---
+    // Iterative radix-4 FFT on separate arrays of real and imaginary parts,
+    //   butterflies run on 4 lanes with AVX2 (-mavx2, -march=native, /arch:AVX2), otherwise scalar.
+    //  - transform()    : natural order -> bit-reversed order, X[k] = SUM x[j] * e^(-2*pi*i*j*k/n)
+    //  - transformInv() : bit-reversed order -> natural order, without scaling by 1/n
+    // The layout of blocks and twiddles is the same as FastNTT (ntt_fast.h).
+    // Twiddle factors are built incrementally and thread-safe.
+    // Transforms larger than MAXN fall back to fft() without twiddle tables, it's much slower.
+    // PRECONDITION: n is a power of 2
+
+    static const int MAX_BIT_SIZE = 23;
+    static const int MAXN = 1 << MAX_BIT_SIZE;
+
+    // twiddle factors in bit-reversed order
+    //   w[s] = e^(-2*pi*i * t(s)), t(0) = 0, t(2^k + j) = t(j) + 1 / 2^(k+2)
+    //   so w[1] = -i, and w[s] = e^(-2*pi*i * s'/n) when s < n/2 and s' is the bit-reversed s in log2(n/2) bits
+    struct Twiddles {
+        double re[MAXN / 2], im[MAXN / 2];
+        std::atomic<int> n;         // [0, n) are built
+        std::mutex mutex;
+    };
+
+    static Twiddles& twiddles() {
+        static Twiddles tw;
+        return tw;
+    }
+
+    static void init(int n) {
+        Twiddles& tw = twiddles();
+
+        int need = min(MAXN / 2, max(2, n / 2));
+        if (tw.n.load(std::memory_order_acquire) >= need)
+            return;
+
+        std::lock_guard<std::mutex> lock(tw.mutex);
+        int built = tw.n.load(std::memory_order_relaxed);
+        if (built == 0) {
+            tw.re[0] = 1.0;
+            tw.im[0] = 0.0;
+            built = 1;
+        }
+        for (; built < need; built++) {
+            // t(s) is exact in double
+            double t = 0.0;
+            for (int k = 0; (1 << k) <= built; k++) {
+                if (built & (1 << k))
+                    t += 1.0 / (4 << k);
+            }
+            tw.re[built] = cos(2.0 * M_PI * t);
+            tw.im[built] = -sin(2.0 * M_PI * t);
+        }
+        tw.n.store(built, std::memory_order_release);
+    }
+
+    // counting trailing zeros
+    static int ctz(int x) {
+        int res = 0;
+        while (!(x & 1)) {
+            x >>= 1;
+            res++;
+        }
+        return res;
+    }
+
+    static void transform(double* re, double* im, int n) {
+        if (n > MAXN) {
+            transformLarge(re, im, n, false);
+            return;
+        }
+        init(n);
+
+        int levels = ctz(n);
+        int len = 0;
+        if (levels & 1) {
+            radix2Level0(re, im, n);
+            len = 1;
+        }
+        for (; len < levels; len += 2)
+            radix4Level<false>(re, im, n, len);
+    }
+
+    static void transformInv(double* re, double* im, int n) {
+        if (n > MAXN) {
+            transformLarge(re, im, n, true);
+            return;
+        }
+        init(n);
+
+        int levels = ctz(n);
+        for (int len = levels - 2; len >= (levels & 1); len -= 2)
+            radix4Level<true>(re, im, n, len);
+        if (levels & 1)
+            radix2Level0(re, im, n);
+    }
+
+    //--- real-input convolution ---
+    // Two real inputs are packed into one complex transform.
+    //  1) P = FFT(a + i*b)
+    //  2) C[k] = A[k] * B[k] = (P[k]^2 - conj(P[-k])^2) / 4i
+    //  3) c is real, so FFT(c[2m] + i*c[2m+1]) of size n/2 is made from C[k] and C[k + n/2],
+    //     and c comes from one inverse transform of size n/2
+    // It's 1.5 transforms of size n, instead of 3.
+    //
+    // In bit-reversed order, -k of the position p in [2^m, 2^(m+1)) is at 3 * 2^m - 1 - p,
+    //   and k, k + n/2 are at 2j, 2j + 1 (j is the position of k in bit-reversed order of size n/2).
+
+    // returns a * b, the result has exactly sizeA + sizeB - 1 terms
+    static vector<double> multiplyReal(const vector<double>& a, const vector<double>& b) {
+        int sizeA = int(a.size());
+        int sizeB = int(b.size());
+        if (sizeA == 0 || sizeB == 0)
+            return vector<double>();
+
+        int n = sizeA + sizeB - 1;
+        int size = 4;
+        while (size < n)
+            size <<= 1;
+
+        if (size > MAXN)
+            return multiplyRealLarge(a, b);
+
+        vector<double> re(size), im(size);
+        memcpy(re.data(), a.data(), sizeof(double) * sizeA);
+        memcpy(im.data(), b.data(), sizeof(double) * sizeB);
+        transform(re.data(), im.data(), size);
+
+        // C[k] for k = 0, n/2 and other pairs
+        for (int p = 0; p < 2; p++) {
+            re[p] *= im[p];
+            im[p] = 0.0;
+        }
+        for (int m = 1; (2 << m) <= size; m++) {
+            for (int p = 1 << m, q = (2 << m) - 1; p < q; p++, q--) {
+                // x = P[k], y = P[-k]
+                double xr = re[p], xi = im[p], yr = re[q], yi = im[q];
+                // (x^2 - conj(y)^2) / 4i and (y^2 - conj(x)^2) / 4i
+                double sr = (xr * xr - xi * xi) - (yr * yr - yi * yi);
+                double si = (xr * xi + yr * yi) * 2.0;
+                re[p] = 0.25 * si;
+                im[p] = -0.25 * sr;
+                re[q] = 0.25 * si;
+                im[q] = 0.25 * sr;
+            }
+        }
+
+        // Z[k] = (C[k] + C[k + n/2]) / 2 + i * (C[k] - C[k + n/2]) / (2 * w^k)
+        const Twiddles& tw = twiddles();
+        int half = size >> 1;
+        for (int j = 0; j < half; j++) {
+            double c0r = re[2 * j], c0i = im[2 * j], c1r = re[2 * j + 1], c1i = im[2 * j + 1];
+            double er = c0r + c1r, ei = c0i + c1i;
+            double dr = c0r - c1r, di = c0i - c1i;
+            // o = d * conj(w)
+            double wr = tw.re[j], wi = tw.im[j];
+            double orr = dr * wr + di * wi, oi = di * wr - dr * wi;
+            re[j] = er - oi;
+            im[j] = ei + orr;
+        }
+        transformInv(re.data(), im.data(), half);
+
+        vector<double> res(n);
+        double scale = 1.0 / size;
+        for (int i = 0; i < n; i++)
+            res[i] = ((i & 1) ? im[i >> 1] : re[i >> 1]) * scale;
+        return res;
+    }
+
+    // the position of X[-k] in bit-reversed order, when X[k] is at the position p
+    static int conjugatePosition(int p) {
+        if (p < 2)
+            return p;
+
+        int h = p;
+        while (h & (h - 1))
+            h &= h - 1;
+        return 3 * h - 1 - p;
+    }
+
+//private:
+    // transform() and transformInv() larger than MAXN, with fft()
+    static void transformLarge(double* re, double* im, int n, bool inverse) {
+        vector<pair<double,double>> data(n);
+        for (int i = 0, j = 0; i < n; i++) {
+            // j is the bit-reversed i
+            if (!inverse)
+                data[i] = make_pair(re[i], im[i]);
+            else
+                data[i] = make_pair(re[j], im[j]);
+
+            int mask = n;
+            while (j & (mask >>= 1))
+                j &= ~mask;
+            j |= mask;
+        }
+
+        fft(data, inverse);
+
+        for (int i = 0, j = 0; i < n; i++) {
+            if (!inverse) {
+                re[j] = data[i].first;
+                im[j] = data[i].second;
+            } else {
+                // fft() scales by 1/n
+                re[i] = data[i].first * n;
+                im[i] = data[i].second * n;
+            }
+
+            int mask = n;
+            while (j & (mask >>= 1))
+                j &= ~mask;
+            j |= mask;
+        }
+    }
+
+    // multiplyReal() larger than MAXN, with three transforms of fft()
+    static vector<double> multiplyRealLarge(const vector<double>& a, const vector<double>& b) {
+        int n = int(a.size() + b.size()) - 1;
+        int size = 1;
+        while (size < n)
+            size <<= 1;
+
+        vector<pair<double,double>> A(size), B(size);
+        for (int i = 0; i < int(a.size()); i++)
+            A[i].first = a[i];
+        for (int i = 0; i < int(b.size()); i++)
+            B[i].first = b[i];
+        fft(A);
+        fft(B);
+        for (int i = 0; i < size; i++)
+            A[i] = make_pair(A[i].first * B[i].first - A[i].second * B[i].second,
+                             A[i].first * B[i].second + A[i].second * B[i].first);
+        fft(A, true);
+
+        vector<double> res(n);
+        for (int i = 0; i < n; i++)
+            res[i] = A[i].first;
+        return res;
+    }
+
+    // radix-2 level 0 (twiddle = 1)
+    static void radix2Level0(double* re, double* im, int n) {
+        int p = n >> 1;
+        for (int i = 0; i < p; i++) {
+            double xr = re[i], xi = im[i], yr = re[i + p], yi = im[i + p];
+            re[i] = xr + yr;
+            im[i] = xi + yi;
+            re[i + p] = xr - yr;
+            im[i + p] = xi - yi;
+        }
+    }
+
+    // forward radix-4 butterfly, (ur, ui) = w[2s], (u2r, u2i) = w[s]
+    //   x1 * u, x2 * u^2, x3 * u^3, and the multiplication by w[1] = -i is a swap
+    template <bool Inverse>
+    static void butterfly4(double& x0r, double& x0i, double& x1r, double& x1i,
+                           double& x2r, double& x2i, double& x3r, double& x3i,
+                           double ur, double ui, double u2r, double u2i) {
+        double u3r = ur * u2r - ui * u2i, u3i = ur * u2i + ui * u2r;
+        if (!Inverse) {
+            double y1r = x1r * ur - x1i * ui, y1i = x1r * ui + x1i * ur;
+            double y2r = x2r * u2r - x2i * u2i, y2i = x2r * u2i + x2i * u2r;
+            double y3r = x3r * u3r - x3i * u3i, y3i = x3r * u3i + x3i * u3r;
+
+            double s02r = x0r + y2r, s02i = x0i + y2i, d02r = x0r - y2r, d02i = x0i - y2i;
+            double s13r = y1r + y3r, s13i = y1i + y3i;
+            double d13r = y1i - y3i, d13i = y3r - y1r;      // (y1 - y3) * -i
+
+            x0r = s02r + s13r; x0i = s02i + s13i;
+            x1r = s02r - s13r; x1i = s02i - s13i;
+            x2r = d02r + d13r; x2i = d02i + d13i;
+            x3r = d02r - d13r; x3i = d02i - d13i;
+        } else {
+            // conjugate twiddles
+            double s01r = x0r + x1r, s01i = x0i + x1i, d01r = x0r - x1r, d01i = x0i - x1i;
+            double s23r = x2r + x3r, s23i = x2i + x3i;
+            double d23r = x3i - x2i, d23i = x2r - x3r;      // (x2 - x3) * i
+
+            double t1r = d01r + d23r, t1i = d01i + d23i;
+            double t2r = s01r - s23r, t2i = s01i - s23i;
+            double t3r = d01r - d23r, t3i = d01i - d23i;
+
+            x0r = s01r + s23r; x0i = s01i + s23i;
+            x1r = t1r * ur + t1i * ui; x1i = t1i * ur - t1r * ui;
+            x2r = t2r * u2r + t2i * u2i; x2i = t2i * u2r - t2r * u2i;
+            x3r = t3r * u3r + t3i * u3i; x3i = t3i * u3r - t3r * u3i;
+        }
+    }
+
+#if defined(__AVX2__)
+    static __m256d cmulRe(__m256d ar, __m256d ai, __m256d br, __m256d bi) {
+        return _mm256_sub_pd(_mm256_mul_pd(ar, br), _mm256_mul_pd(ai, bi));
+    }
+
+    static __m256d cmulIm(__m256d ar, __m256d ai, __m256d br, __m256d bi) {
+        return _mm256_add_pd(_mm256_mul_pd(ar, bi), _mm256_mul_pd(ai, br));
+    }
+
+    template <bool Inverse>
+    static void butterfly4(__m256d& x0r, __m256d& x0i, __m256d& x1r, __m256d& x1i,
+                           __m256d& x2r, __m256d& x2i, __m256d& x3r, __m256d& x3i,
+                           __m256d ur, __m256d ui, __m256d u2r, __m256d u2i) {
+        __m256d u3r = cmulRe(ur, ui, u2r, u2i), u3i = cmulIm(ur, ui, u2r, u2i);
+        if (!Inverse) {
+            __m256d y1r = cmulRe(x1r, x1i, ur, ui), y1i = cmulIm(x1r, x1i, ur, ui);
+            __m256d y2r = cmulRe(x2r, x2i, u2r, u2i), y2i = cmulIm(x2r, x2i, u2r, u2i);
+            __m256d y3r = cmulRe(x3r, x3i, u3r, u3i), y3i = cmulIm(x3r, x3i, u3r, u3i);
+
+            __m256d s02r = _mm256_add_pd(x0r, y2r), s02i = _mm256_add_pd(x0i, y2i);
+            __m256d d02r = _mm256_sub_pd(x0r, y2r), d02i = _mm256_sub_pd(x0i, y2i);
+            __m256d s13r = _mm256_add_pd(y1r, y3r), s13i = _mm256_add_pd(y1i, y3i);
+            __m256d d13r = _mm256_sub_pd(y1i, y3i), d13i = _mm256_sub_pd(y3r, y1r);
+
+            x0r = _mm256_add_pd(s02r, s13r); x0i = _mm256_add_pd(s02i, s13i);
+            x1r = _mm256_sub_pd(s02r, s13r); x1i = _mm256_sub_pd(s02i, s13i);
+            x2r = _mm256_add_pd(d02r, d13r); x2i = _mm256_add_pd(d02i, d13i);
+            x3r = _mm256_sub_pd(d02r, d13r); x3i = _mm256_sub_pd(d02i, d13i);
+        } else {
+            __m256d s01r = _mm256_add_pd(x0r, x1r), s01i = _mm256_add_pd(x0i, x1i);
+            __m256d d01r = _mm256_sub_pd(x0r, x1r), d01i = _mm256_sub_pd(x0i, x1i);
+            __m256d s23r = _mm256_add_pd(x2r, x3r), s23i = _mm256_add_pd(x2i, x3i);
+            __m256d d23r = _mm256_sub_pd(x3i, x2i), d23i = _mm256_sub_pd(x2r, x3r);
+
+            __m256d t1r = _mm256_add_pd(d01r, d23r), t1i = _mm256_add_pd(d01i, d23i);
+            __m256d t2r = _mm256_sub_pd(s01r, s23r), t2i = _mm256_sub_pd(s01i, s23i);
+            __m256d t3r = _mm256_sub_pd(d01r, d23r), t3i = _mm256_sub_pd(d01i, d23i);
+
+            // t * conj(u) = (tr*ur + ti*ui) + i(ti*ur - tr*ui)
+            x0r = _mm256_add_pd(s01r, s23r); x0i = _mm256_add_pd(s01i, s23i);
+            x1r = _mm256_add_pd(_mm256_mul_pd(t1r, ur), _mm256_mul_pd(t1i, ui));
+            x1i = _mm256_sub_pd(_mm256_mul_pd(t1i, ur), _mm256_mul_pd(t1r, ui));
+            x2r = _mm256_add_pd(_mm256_mul_pd(t2r, u2r), _mm256_mul_pd(t2i, u2i));
+            x2i = _mm256_sub_pd(_mm256_mul_pd(t2i, u2r), _mm256_mul_pd(t2r, u2i));
+            x3r = _mm256_add_pd(_mm256_mul_pd(t3r, u3r), _mm256_mul_pd(t3i, u3i));
+            x3i = _mm256_sub_pd(_mm256_mul_pd(t3i, u3r), _mm256_mul_pd(t3r, u3i));
+        }
+    }
+
+    // 4x4 transpose, it's an involution
+    static void transpose4x4(__m256d& v0, __m256d& v1, __m256d& v2, __m256d& v3) {
+        __m256d t0 = _mm256_unpacklo_pd(v0, v1), t1 = _mm256_unpackhi_pd(v0, v1);
+        __m256d t2 = _mm256_unpacklo_pd(v2, v3), t3 = _mm256_unpackhi_pd(v2, v3);
+        v0 = _mm256_permute2f128_pd(t0, t2, 0x20);
+        v1 = _mm256_permute2f128_pd(t1, t3, 0x20);
+        v2 = _mm256_permute2f128_pd(t0, t2, 0x31);
+        v3 = _mm256_permute2f128_pd(t1, t3, 0x31);
+    }
+#endif
+
+    // a radix-4 level, 2^len blocks of 4 * q elements
+    template <bool Inverse>
+    static void radix4Level(double* re, double* im, int n, int len) {
+        const Twiddles& tw = twiddles();
+        int q = n >> (len + 2);
+        int blocks = 1 << len;
+        int s = 0;
+#if defined(__AVX2__)
+        if (q >= 4) {
+            for (; s < blocks; s++) {
+                const __m256d ur = _mm256_set1_pd(tw.re[2 * s]), ui = _mm256_set1_pd(tw.im[2 * s]);
+                const __m256d u2r = _mm256_set1_pd(tw.re[s]), u2i = _mm256_set1_pd(tw.im[s]);
+                double* pr = re + s * 4 * q;
+                double* pi = im + s * 4 * q;
+                for (int i = 0; i < q; i += 4) {
+                    __m256d x0r = _mm256_loadu_pd(pr + i), x1r = _mm256_loadu_pd(pr + i + q);
+                    __m256d x2r = _mm256_loadu_pd(pr + i + 2 * q), x3r = _mm256_loadu_pd(pr + i + 3 * q);
+                    __m256d x0i = _mm256_loadu_pd(pi + i), x1i = _mm256_loadu_pd(pi + i + q);
+                    __m256d x2i = _mm256_loadu_pd(pi + i + 2 * q), x3i = _mm256_loadu_pd(pi + i + 3 * q);
+                    butterfly4<Inverse>(x0r, x0i, x1r, x1i, x2r, x2i, x3r, x3i, ur, ui, u2r, u2i);
+                    _mm256_storeu_pd(pr + i, x0r); _mm256_storeu_pd(pr + i + q, x1r);
+                    _mm256_storeu_pd(pr + i + 2 * q, x2r); _mm256_storeu_pd(pr + i + 3 * q, x3r);
+                    _mm256_storeu_pd(pi + i, x0i); _mm256_storeu_pd(pi + i + q, x1i);
+                    _mm256_storeu_pd(pi + i + 2 * q, x2i); _mm256_storeu_pd(pi + i + 3 * q, x3i);
+                }
+            }
+        } else {
+            // q = 1, four blocks at a time with transposes
+            for (; s + 4 <= blocks; s += 4) {
+                const __m256d ur = _mm256_setr_pd(tw.re[2 * s], tw.re[2 * s + 2], tw.re[2 * s + 4], tw.re[2 * s + 6]);
+                const __m256d ui = _mm256_setr_pd(tw.im[2 * s], tw.im[2 * s + 2], tw.im[2 * s + 4], tw.im[2 * s + 6]);
+                const __m256d u2r = _mm256_loadu_pd(tw.re + s), u2i = _mm256_loadu_pd(tw.im + s);
+                double* pr = re + s * 4;
+                double* pi = im + s * 4;
+
+                __m256d x0r = _mm256_loadu_pd(pr), x1r = _mm256_loadu_pd(pr + 4);
+                __m256d x2r = _mm256_loadu_pd(pr + 8), x3r = _mm256_loadu_pd(pr + 12);
+                __m256d x0i = _mm256_loadu_pd(pi), x1i = _mm256_loadu_pd(pi + 4);
+                __m256d x2i = _mm256_loadu_pd(pi + 8), x3i = _mm256_loadu_pd(pi + 12);
+                transpose4x4(x0r, x1r, x2r, x3r);
+                transpose4x4(x0i, x1i, x2i, x3i);
+                butterfly4<Inverse>(x0r, x0i, x1r, x1i, x2r, x2i, x3r, x3i, ur, ui, u2r, u2i);
+                transpose4x4(x0r, x1r, x2r, x3r);
+                transpose4x4(x0i, x1i, x2i, x3i);
+                _mm256_storeu_pd(pr, x0r); _mm256_storeu_pd(pr + 4, x1r);
+                _mm256_storeu_pd(pr + 8, x2r); _mm256_storeu_pd(pr + 12, x3r);
+                _mm256_storeu_pd(pi, x0i); _mm256_storeu_pd(pi + 4, x1i);
+                _mm256_storeu_pd(pi + 8, x2i); _mm256_storeu_pd(pi + 12, x3i);
+            }
+        }
+#endif
+        for (; s < blocks; s++) {
+            double ur = tw.re[2 * s], ui = tw.im[2 * s], u2r = tw.re[s], u2i = tw.im[s];
+            double* pr = re + s * 4 * q;
+            double* pi = im + s * 4 * q;
+            for (int i = 0; i < q; i++) {
+                butterfly4<Inverse>(pr[i], pi[i], pr[i + q], pi[i + q], pr[i + 2 * q], pi[i + 2 * q],
+                                    pr[i + 3 * q], pi[i + 3 * q], ur, ui, u2r, u2i);
+            }
+        }
+    }
 };
@@ -67,6 +67,24 @@ void testFFT2() {
         cout << "ERROR at " << __LINE__ << endl;
     assert(out1 == out2);
 
+    // real-input convolution
+    for (int n : { 1, 2, 3, 100, 1000, 5000 }) {
+        vector<double> A(n), B(n / 2 + 1);
+        for (auto& x : A)
+            x = RandInt32::get() % 32768;
+        for (auto& x : B)
+            x = RandInt32::get() % 32768;
+
+        auto C = fft.multiplyReal(A, B);
+        assert(C.size() == A.size() + B.size() - 1);
+        for (int k = 0; k < int(C.size()); k++) {
+            long long gt = 0;
+            for (int i = max(0, k - int(B.size()) + 1); i <= min(k, n - 1); i++)
+                gt += (long long)A[i] * (long long)B[k - i];
+            assert(fabs(C[k] - gt) < 0.1);
+        }
+    }
+
     cout << "*** Speed test ***" << endl;
 
     for (int n = 32; n <= 2048; n <<= 1) {
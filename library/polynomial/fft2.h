@@ -132,4 +132,45 @@ struct FFT2 {
 
         return true;
     }
+
+    // real-input convolution, returns a * b with exactly sizeA + sizeB - 1 terms
+    //   P = FFT(a + i*b), A[k] = (P[k] + conj(P[-k])) / 2, B[k] = (P[k] - conj(P[-k])) / 2i
+    //   C[k] = A[k] * B[k] = (P[k]^2 - conj(P[-k])^2) / 4i
+    // two transforms instead of three
+    vector<double> multiplyReal(const vector<double>& a, const vector<double>& b) {
+        int sizeA = int(a.size());
+        int sizeB = int(b.size());
+        if (sizeA == 0 || sizeB == 0)
+            return vector<double>();
+
+        int n = sizeA + sizeB - 1;
+        int size = 2;
+        while (size < n)
+            size <<= 1;
+
+        vector<pair<double,double>> P(size);
+        for (int i = 0; i < sizeA; i++)
+            P[i].first = a[i];
+        for (int i = 0; i < sizeB; i++)
+            P[i].second = b[i];
+
+        fft(P);
+
+        for (int k = 0; k <= size / 2; k++) {
+            int j = (size - k) & (size - 1);
+            // x = P[k], y = P[-k]
+            double xr = P[k].first, xi = P[k].second, yr = P[j].first, yi = P[j].second;
+            double sr = (xr * xr - xi * xi) - (yr * yr - yi * yi);
+            double si = (xr * xi + yr * yi) * 2.0;
+            P[k] = make_pair(0.25 * si, -0.25 * sr);
+            P[j] = make_pair(0.25 * si, 0.25 * sr);
+        }
+
+        fft(P, true);
+
+        vector<double> res(n);
+        for (int i = 0; i < n; i++)
+            res[i] = P[i].first;
+        return res;
+    }
 };
@@ -49,6 +49,28 @@ void testLagrange() {
         cout << "f(3) = " << ans << endl;
         assert(ans == 35);
     }
+    {
+        // many samples and many points with an NTT-friendly prime
+        const int NTT_MOD = 998244353;
+
+        int N = 3000;
+        vector<pair<int, int>> samples(N);
+        for (int i = 0; i < N; i++)
+            samples[i] = make_pair(i * 7 + 3, RandInt32::get() % NTT_MOD);
+
+        auto f = LagrangePolynomialMod<NTT_MOD>::interpolatePolynomial(samples);
+        assert(int(f.size()) == N);
+
+        vector<int> X(1000);
+        for (auto& x : X)
+            x = RandInt32::get() % NTT_MOD;
+        X[0] = samples[10].first;
+
+        auto Y = LagrangePolynomialMod<NTT_MOD>::interpolate(samples, X);
+        assert(Y[0] == samples[10].second);
+        for (int i = 0; i < 10; i++)
+            assert(Y[i] == LagrangePolynomialMod<NTT_MOD>::interpolate(samples, X[i]));
+    }
     {
         int T = 100;
         int N = 100;
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "ntt_fast.h"
+
 /*
     Y = f(X) = a_n * X^n + a_(n-1) * X^(n - 1) + ... + a_0
         Y0 = f(X0),
@@ -41,6 +43,41 @@ struct LagrangePolynomialMod {
         return interpolate(samples.data(), int(samples.size()), x);
     }
 
+    //--- many samples and many points, 'mod' must be an NTT-friendly prime and 'root' is its primitive root
+    //    transforms are up to 2^MaxBitSize, and 2^MaxBitSize must divide (mod - 1)
+
+    // O(n*log^2(n)), returns f(x) of n coefficients (low order first), f(Xi) = Yi
+    // samples = { ..., (Xi, Yi), ... }, Xi must be distinct
+    // PRECONDITION: 2 * n <= 2^MaxBitSize
+    template <int root = 3, int MaxBitSize = 23>
+    static vector<int> interpolatePolynomial(const vector<pair<int, int>>& samples) {
+        int n = int(samples.size());
+        assert(2ll * n <= (1ll << MaxBitSize));
+
+        vector<int> X(n), Y(n);
+        for (int i = 0; i < n; i++) {
+            X[i] = samples[i].first;
+            Y[i] = samples[i].second;
+        }
+
+        typename FastNTT<mod, root, MaxBitSize>::SubproductTree tree;
+        tree.build(X);
+        return tree.interpolate(Y);
+    }
+
+    // O((n + m)*log^2(n + m)), returns { f(x[0]), f(x[1]), ..., f(x[m-1]) }
+    // samples = { ..., (Xi, Yi), ... }, Xi must be distinct
+    // PRECONDITION: 2 * n <= 2^MaxBitSize, n + m <= 2^MaxBitSize
+    template <int root = 3, int MaxBitSize = 23>
+    static vector<int> interpolate(const vector<pair<int, int>>& samples, const vector<int>& x) {
+        assert(1ll * int(samples.size()) + int(x.size()) <= (1ll << MaxBitSize));
+        auto f = interpolatePolynomial<root, MaxBitSize>(samples);
+
+        typename FastNTT<mod, root, MaxBitSize>::SubproductTree tree;
+        tree.build(x);
+        return tree.evaluate(f);
+    }
+
 private:
     // O(logn), mod must be a prime number
     static int modPow(long long x, int n) {
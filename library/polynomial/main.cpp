@@ -10,6 +10,7 @@ int main(void) {
     TEST(FFT2);
     TEST(PolyFFT);
     TEST(PolyFFTMod);
+    TEST(ArbitraryModConvolution);
     TEST(Convolution);
     TEST(NTT);
     TEST(FactorialMod);
@@ -17,6 +18,7 @@ int main(void) {
     TEST(Lagrange);
     TEST(PowerSumPolyMod);
     TEST(WalshHadamard);
+    TEST(SubsetConvolution);
     TEST(VandermondeMatrix);
     TEST(Polynomial);
     TEST(FactorialIntModFast);
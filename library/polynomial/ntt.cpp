@@ -1,5 +1,6 @@
 #include <vector>
 #include <algorithm>
+#include <thread>
 
 using namespace std;
 
@@ -164,6 +165,92 @@ private:
     }
 };
 
+// Newton iterations with full products, to compare with truncated products
+template <int mod, int root, int MaxBitSize>
+struct NewtonWithFullProducts {
+    typedef FastNTT<mod, root, MaxBitSize> NTTT;
+
+    static vector<int> inverse(const vector<int>& poly, int n) {
+        vector<int> res{ NTTT::modInv(poly[0]) };
+        int a = 1;
+        while (a < n) {
+            vector<int> C = NTTT::substr(NTTT::multiply(res, NTTT::modXK(poly, 2 * a)), a, 2 * a);
+            NTTT::subtract(res, NTTT::mulXK(NTTT::modXK(NTTT::multiply(res, C), a), a));
+            a *= 2;
+        }
+        return NTTT::modXK(res, n);
+    }
+
+    static vector<int> ln(const vector<int>& a) {
+        auto A = inverse(a, int(a.size()));
+        A = NTTT::multiply(A, NTTT::derivate(a));
+        A.resize(a.size());
+        return NTTT::integrate(A);
+    }
+
+    static vector<int> exp(vector<int> a) {
+        int size = 1;
+        while (size < int(a.size()))
+            size <<= 1;
+        if (size == 1)
+            return{ 1 };
+
+        a.resize(size);
+        vector<int> b = exp(vector<int>(a.begin(), a.begin() + (size >> 1)));
+        b.resize(size);
+
+        vector<int> c = ln(b);
+        for (int i = 0; i < size; i++)
+            c[i] = int((a[i] - c[i] + mod) % mod);
+        c[0]++;
+
+        b = NTTT::multiply(b, c);
+        b.resize(size);
+        return b;
+    }
+};
+
+// the remainder tree with polynomial divisions, to compare with FastNTT::SubproductTree
+template <int mod, int root, int MaxBitSize>
+struct RemainderTree {
+    typedef FastNTT<mod, root, MaxBitSize> NTTT;
+
+    int N;
+    vector<vector<int>> tree;
+
+    void build(const vector<int>& X) {
+        N = int(X.size());
+        tree = vector<vector<int>>(4 * N);
+        dfsBuild(X, 1, 0, N - 1);
+    }
+
+    vector<int> evaluate(const vector<int>& poly, const vector<int>& X) {
+        return dfsEvaluate(poly, X, 1, 0, N - 1);
+    }
+
+private:
+    void dfsBuild(const vector<int>& X, int node, int L, int R) {
+        if (L == R)
+            tree[node] = vector<int>{ X[L] ? (mod - X[L]) : X[L], 1 };
+        else {
+            int mid = L + (R - L) / 2;
+            dfsBuild(X, 2 * node, L, mid);
+            dfsBuild(X, 2 * node + 1, mid + 1, R);
+            tree[node] = NTTT::multiply(tree[2 * node], tree[2 * node + 1]);
+        }
+    }
+
+    vector<int> dfsEvaluate(const vector<int>& poly, const vector<int>& X, int node, int L, int R) {
+        if (R == L)
+            return vector<int>{ NTTT::evaluate(poly, X[L]) };
+
+        int mid = L + (R - L) / 2;
+        auto A = dfsEvaluate(NTTT::divmod(poly, tree[2 * node]).second, X, 2 * node, L, mid);
+        auto B = dfsEvaluate(NTTT::divmod(poly, tree[2 * node + 1]).second, X, 2 * node + 1, mid + 1, R);
+        A.insert(end(A), begin(B), end(B));
+        return A;
+    }
+};
 
 void testNTT() {
     return; //TODO: if you want to test, make this line a comment.
@@ -280,6 +367,438 @@ void testNTT() {
             assert(out1 == out2);
         }
     }
+    {
+        // FastNTT
+        for (int n : { 1, 2, 16, 256, 1000, 1025, 4097, 70000 }) {
+            for (int m : { 256, 257, 3000 }) {
+                vector<int> A(n), B(m);
+                for (int i = 0; i < n; i++)
+                    A[i] = RandInt32::get() % MOD;
+                for (int i = 0; i < m; i++)
+                    B[i] = RandInt32::get() % MOD;
+
+                vector<int> out1 = NTT<MOD, ROOT>::multiply(A, B);
+                vector<int> out2 = FastNTT<MOD, ROOT>::multiply(A, B);
+                if (out1 != out2)
+                    cout << "Mismatched at " << n << ", " << m << endl;
+                assert(out1 == out2);
+            }
+            vector<int> A(n);
+            for (int i = 0; i < n; i++)
+                A[i] = RandInt32::get() % MOD;
+            vector<int> out1 = NTT<MOD, ROOT>::multiply(A, A);
+            vector<int> out2 = FastNTT<MOD, ROOT>::square(A);
+            assert(out1 == out2);
+        }
+
+        // transforms in natural order
+        for (int n = 1; n <= 64; n <<= 1) {
+            vector<int> A(n), B(n), C(n);
+            for (int i = 0; i < n; i++)
+                A[i] = RandInt32::get() % MOD;
+
+            FastNTT<MOD, ROOT>::ntt(A.data(), B.data(), n);
+            long long w = FastNTT<MOD, ROOT>::modPow(ROOT, (MOD - 1) / n);
+            for (int k = 0; k < n; k++) {
+                long long wk = FastNTT<MOD, ROOT>::modPow(w, k), t = 1, sum = 0;
+                for (int j = 0; j < n; j++) {
+                    sum = (sum + A[j] * t) % MOD;
+                    t = t * wk % MOD;
+                }
+                assert(B[k] == sum);
+            }
+
+            FastNTT<MOD, ROOT>::nttInv(B.data(), C.data(), n);
+            assert(A == C);
+        }
+    }
+    {
+        // FastNTT in parallel
+        const int T = 4;
+        vector<vector<int>> A(T), B(T), gt(T), out(T);
+        for (int t = 0; t < T; t++) {
+            A[t].resize(5000 + t * 1000);
+            B[t].resize(3000 + t * 500);
+            for (auto& x : A[t])
+                x = RandInt32::get() % MOD;
+            for (auto& x : B[t])
+                x = RandInt32::get() % MOD;
+            gt[t] = NTT<MOD, ROOT>::multiply(A[t], B[t]);
+        }
+
+        vector<thread> threads;
+        for (int t = 0; t < T; t++) {
+            threads.emplace_back([&A, &B, &out, t]() {
+                FastNTT<MOD, ROOT>::Workspace ws;
+                for (int i = 0; i < 20; i++) {
+                    out[t] = (i & 1) ? FastNTT<MOD, ROOT>::multiply(A[t], B[t])
+                                     : FastNTT<MOD, ROOT>::multiply(A[t], B[t], ws);
+                }
+            });
+        }
+        for (auto& th : threads)
+            th.join();
+
+        for (int t = 0; t < T; t++)
+            assert(out[t] == gt[t]);
+    }
+    {
+        // parallel multiplication
+        for (int n : { 1000, 70000, 300000 }) {
+            for (int T : { 2, 3, 4 }) {
+                vector<int> A(n), B(n / 2 + 7);
+                for (auto& x : A)
+                    x = RandInt32::get() % MOD;
+                for (auto& x : B)
+                    x = RandInt32::get() % MOD;
+
+                vector<int> out1 = FastNTT<MOD, ROOT>::multiply(A, B);
+                vector<int> out2 = FastNTT<MOD, ROOT>::multiplyParallel(A, B, T);
+                assert(out1 == out2);
+            }
+        }
+        {
+            static const int M = 1000000007;
+            static const int R = 5;
+
+            vector<int> A(100000), B(70000);
+            for (auto& x : A)
+                x = RandInt32::get() % M;
+            for (auto& x : B)
+                x = RandInt32::get() % M;
+
+            vector<int> out1 = PolyNTT<M, R>::multiplyFast(A, B);
+            vector<int> out2 = PolyNTT<M, R>::multiplyParallel(A, B, 4);
+            assert(out1 == out2);
+        }
+    }
+    {
+        // prepared operands
+        typedef FastNTT<MOD, ROOT> FNTT;
+        for (int n : { 1, 255, 1000, 4097 }) {
+            vector<int> K(n);
+            for (auto& x : K)
+                x = RandInt32::get() % MOD;
+
+            auto P = FNTT::prepare(K, 3000);
+            auto PRev = FNTT::prepare(K, 3000, true, 3);
+            assert(P.maxOperandSize() >= 3000);
+            for (int m : { 1, 256, 2999, 3000 }) {
+                vector<int> X(m);
+                for (auto& x : X)
+                    x = RandInt32::get() % MOD;
+
+                vector<int> gt = NTT<MOD, ROOT>::multiply(K, X);
+                assert(FNTT::multiply(P, X) == gt);
+                assert(FNTT::convolute(X, PRev) == FNTT::convolute(X, K));
+
+                FNTT::Workspace ws;
+                assert(FNTT::multiply(P, X, ws, 4) == gt);
+            }
+        }
+        {
+            typedef PolyNTT<1000000007, 5> PNTT;
+
+            vector<int> K(5000), X(7000);
+            for (auto& x : K)
+                x = RandInt32::get() % 1000000007;
+            for (auto& x : X)
+                x = RandInt32::get() % 1000000007;
+
+            auto P = PNTT::prepare(K, int(X.size()));
+            auto PRev = PNTT::prepare(K, int(X.size()), true);
+            vector<int> gt = PNTT::multiplyFast(K, X);
+            assert(PNTT::multiply(P, X) == gt);
+            assert(PNTT::multiply(P, X, 3) == gt);
+            assert(PNTT::convolute(X, PRev) == PNTT::convolute(X, K));
+        }
+    }
+    {
+        // truncated products
+        typedef FastNTT<MOD, ROOT> FNTT;
+        typedef PolyNTT<1000000007, 5> PNTT;
+        for (int n : { 1, 63, 64, 1000, 3000 }) {
+            for (int m : { 1, 64, 1000 }) {
+                vector<int> A(n), B(m);
+                for (auto& x : A)
+                    x = RandInt32::get() % MOD;
+                for (auto& x : B)
+                    x = RandInt32::get() % MOD;
+
+                vector<int> full = NTT<MOD, ROOT>::multiply(A, B);
+                full.resize(n + m - 1);
+                vector<int> fullP = PNTT::multiplyFast(A, B);
+                for (int k : { 1, m, n + m - 2, n + m + 5 }) {
+                    vector<int> gt(full.begin(), full.begin() + min(k, n + m - 1));
+                    assert(FNTT::multiplyTruncated(A, B, k) == gt);
+                    gt.assign(fullP.begin(), fullP.begin() + min(k, n + m - 1));
+                    assert(PNTT::multiplyTruncated(A, B, k) == gt);
+                }
+                if (n >= m) {
+                    vector<int> gt(full.begin() + m - 1, full.begin() + n);
+                    assert(FNTT::middleProduct(A, B) == gt);
+                    gt.assign(fullP.begin() + m - 1, fullP.begin() + n);
+                    assert(PNTT::middleProduct(A, B) == gt);
+                }
+            }
+        }
+
+        // Newton iterations
+        for (int n : { 1, 2, 100, 1000, 4097 }) {
+            vector<int> A(n);
+            for (auto& x : A)
+                x = RandInt32::get() % MOD;
+            A[0] = 1;
+
+            auto inv = FNTT::inverse(A, n);
+            auto one = FNTT::multiplyTruncated(A, inv, n);
+            for (int i = 0; i < n; i++)
+                assert(one[i] == (i == 0));
+            assert(inv == (NewtonWithFullProducts<MOD, ROOT, 20>::inverse(A, n)));
+
+            auto lnA = FNTT::ln(A);
+            lnA.resize(n);
+            auto expLnA = FNTT::exp(lnA);
+            expLnA.resize(n);
+            assert(expLnA == A);
+            assert(FNTT::exp(lnA) == (NewtonWithFullProducts<MOD, ROOT, 20>::exp(lnA)));
+
+            auto invP = PNTT::inverse(A);
+            auto oneP = PNTT::multiplyTruncated(A, invP, n);
+            for (int i = 0; i < n; i++)
+                assert(oneP[i] == (i == 0));
+        }
+    }
+    {
+        // subproduct tree
+        typedef FastNTT<MOD, ROOT> FNTT;
+
+        for (int n : { 1, 2, 3, 63, 64, 65, 100, 129, 1000, 3000 }) {
+            vector<int> X(n);
+            for (int i = 0; i < n; i++)
+                X[i] = (i == 0) ? 0 : RandInt32::get() % MOD;
+            sort(X.begin(), X.end());
+            X.erase(unique(X.begin(), X.end()), X.end());
+            random_shuffle(X.begin(), X.end());
+            n = int(X.size());
+
+            FNTT::SubproductTree tree;
+            tree.build(X);
+
+            auto M = tree.product();
+            for (int i = 0; i < n; i++)
+                assert(FNTT::evaluate(M, X[i]) == 0);
+
+            for (int m : { 1, n / 2 + 1, n, 2 * n + 7 }) {
+                vector<int> f(m);
+                for (auto& x : f)
+                    x = RandInt32::get() % MOD;
+
+                auto Y = tree.evaluate(f);
+                for (int i = 0; i < n; i++)
+                    assert(Y[i] == FNTT::evaluate(f, X[i]));
+            }
+
+            vector<int> g(n);
+            for (auto& x : g)
+                x = RandInt32::get() % MOD;
+            assert(tree.interpolate(tree.evaluate(g)) == g);
+
+            FNTT::EvaluationTree evalTree;
+            evalTree.build(X);
+            assert(evalTree.tree[1] == M);
+            auto Y = evalTree.evaluate(g, X);
+            FNTT::normalize(g);
+            assert(evalTree.interpolate(X, Y) == g);
+        }
+    }
+    {
+        // 2^23 is the largest size of MOD = 998244353
+        typedef FastNTT<MOD, ROOT, 23> NTT23;
+
+        int maxThreadN = max(1, int(thread::hardware_concurrency()));
+
+        cout << "*** Scaling test of FastNTT::multiplyParallel() ***" << endl;
+        for (int n = (1 << 16); n <= (1 << 23); n <<= 1) {
+            vector<int> in1(n / 2);
+            vector<int> in2(n / 2);
+            for (int i = 0; i < n / 2; i++) {
+                in1[i] = RandInt32::get() % MOD;
+                in2[i] = RandInt32::get() % MOD;
+            }
+
+            cout << "N = " << n << endl;
+            for (int T = 1; ; T = min(T * 2, maxThreadN)) {
+                cout << "  threads = " << T << " : ";
+                PROFILE_START(0);
+                NTT23::multiplyParallel(in1, in2, T);
+                PROFILE_STOP(0);
+                if (T >= maxThreadN)
+                    break;
+            }
+        }
+    }
+    {
+        cout << "*** Speed test of FastNTT ***" << endl;
+        for (int n = (1 << 16); n <= (1 << 20); n <<= 2) {
+            vector<int> in1(n / 2);
+            vector<int> in2(n / 2);
+            for (int i = 0; i < n / 2; i++) {
+                in1[i] = RandInt32::get() % MOD;
+                in2[i] = RandInt32::get() % MOD;
+            }
+
+            vector<int> out1, out2;
+
+            cout << "N = " << n << endl;
+
+            cout << "  NTT::multiply() : ";
+            PROFILE_START(0);
+            for (int i = 0; i < 10; i++)
+                out1 = NTT<MOD, ROOT>::multiply(in1, in2);
+            PROFILE_STOP(0);
+
+            cout << "  FastNTT::multiply() : ";
+            PROFILE_START(1);
+            for (int i = 0; i < 10; i++)
+                out2 = FastNTT<MOD, ROOT>::multiply(in1, in2);
+            PROFILE_STOP(1);
+
+            assert(out1 == out2);
+        }
+    }
+    {
+        cout << "*** Speed test of FastNTT::PreparedPoly ***" << endl;
+        // a kernel of size N/2 is multiplied with 20 streams of size N/2
+        for (int n = (1 << 16); n <= (1 << 20); n <<= 2) {
+            vector<int> K(n / 2);
+            vector<vector<int>> X(20, vector<int>(n / 2));
+            for (auto& x : K)
+                x = RandInt32::get() % MOD;
+            for (auto& v : X) {
+                for (auto& x : v)
+                    x = RandInt32::get() % MOD;
+            }
+
+            long long sum1 = 0, sum2 = 0;
+
+            cout << "N = " << n << endl;
+
+            cout << "  FastNTT::multiply() : ";
+            PROFILE_START(0);
+            for (auto& v : X)
+                sum1 += FastNTT<MOD, ROOT>::multiply(K, v).back();
+            PROFILE_STOP(0);
+
+            cout << "  FastNTT::multiply() with PreparedPoly : ";
+            PROFILE_START(1);
+            auto P = FastNTT<MOD, ROOT>::prepare(K, n / 2);
+            for (auto& v : X)
+                sum2 += FastNTT<MOD, ROOT>::multiply(P, v).back();
+            PROFILE_STOP(1);
+
+            assert(sum1 == sum2);
+        }
+    }
+    {
+        cout << "*** Speed test of Newton iterations with truncated products ***" << endl;
+        typedef FastNTT<MOD, ROOT, 23> NTT23;
+        typedef NewtonWithFullProducts<MOD, ROOT, 23> FullT;
+
+        const int N = 1000000;
+        vector<int> A(N), B(N);
+        for (auto& x : A)
+            x = RandInt32::get() % MOD;
+        for (auto& x : B)
+            x = RandInt32::get() % MOD;
+        A[0] = 1;
+        B[0] = 0;
+
+        cout << "N = " << N << endl;
+        vector<int> out1, out2;
+
+        cout << "  inverse() with full products : ";
+        PROFILE_START(0);
+        out1 = FullT::inverse(A, N);
+        PROFILE_STOP(0);
+
+        cout << "  inverse() with truncated products : ";
+        PROFILE_START(1);
+        out2 = NTT23::inverse(A, N);
+        PROFILE_STOP(1);
+        assert(out1 == out2);
+
+        cout << "  exp() with full products : ";
+        PROFILE_START(2);
+        out1 = FullT::exp(B);
+        PROFILE_STOP(2);
+
+        cout << "  exp() with truncated products : ";
+        PROFILE_START(3);
+        out2 = NTT23::exp(B);
+        PROFILE_STOP(3);
+        assert(out1 == out2);
+    }
+    {
+        cout << "*** Speed test of multipoint evaluation ***" << endl;
+        typedef FastNTT<MOD, ROOT, 23> NTT23;
+
+        for (int n : { 1 << 14, 1 << 16 }) {
+            vector<int> X(n), f(n);
+            for (int i = 0; i < n; i++) {
+                X[i] = RandInt32::get() % MOD;
+                f[i] = RandInt32::get() % MOD;
+            }
+
+            vector<int> out1, out2;
+
+            cout << "N = " << n << endl;
+
+            cout << "  remainder tree : ";
+            PROFILE_START(0);
+            RemainderTree<MOD, ROOT, 23> remTree;
+            remTree.build(X);
+            out1 = remTree.evaluate(f, X);
+            PROFILE_STOP(0);
+
+            cout << "  subproduct tree : ";
+            PROFILE_START(1);
+            NTT23::SubproductTree tree;
+            tree.build(X);
+            out2 = tree.evaluate(f);
+            PROFILE_STOP(1);
+
+            assert(out1 == out2);
+        }
+
+        // degree 10^6 at 10^6 points
+        const int N = 1000000;
+        vector<int> X(N), f(N);
+        for (int i = 0; i < N; i++) {
+            X[i] = i;
+            f[i] = RandInt32::get() % MOD;
+        }
+
+        cout << "N = " << N << endl;
+        NTT23::SubproductTree tree;
+
+        cout << "  build : ";
+        PROFILE_START(2);
+        tree.build(X);
+        PROFILE_STOP(2);
+
+        cout << "  evaluate : ";
+        PROFILE_START(3);
+        auto Y = tree.evaluate(f);
+        PROFILE_STOP(3);
+
+        cout << "  interpolate : ";
+        PROFILE_START(4);
+        auto g = tree.interpolate(Y);
+        PROFILE_STOP(4);
+
+        assert(g == f);
+    }
     {
         //static const int M = 1000000007;
         static const int M = MOD;
@@ -1,8 +1,23 @@
 #pragma once
 
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <cassert>
+#include <cstring>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
 // Number Theoretic Transforms
 // M = 998244353 (119 * 2^23 + 1), primitive root = 3
 //
+// Iterative radix-4 NTT with Montgomery multiplication and lazy reduction,
+//   butterflies run on 8 lanes with AVX2 (-mavx2, -march=native, /arch:AVX2), otherwise scalar.
+// M must be an odd prime less than 2^30.
+// All operations are thread-safe, scratch memory is kept per thread. (see FastNTT::Workspace)
+//
 // [CAUTION]
 // It's not working for below 'M's. Use PolyNTT for these
 //    - 10^9 + 7
@@ -35,11 +50,15 @@
 
 template <int mod, int root, int MaxBitSize = 20>
 struct FastNTT {
+    static_assert((mod & 1) && mod < (1 << 30), "mod must be an odd number less than 2^30");
+
     static const int MAXN = 1 << MaxBitSize;
 
-    static int w[MAXN], wInv[MAXN];
-    static int nInv[MaxBitSize + 1];
-    static bool initiated;
+    // twiddle factors in bit-reversed order (Montgomery form)
+    //   rt[s] = w^bitReverse(s), w is the primitive MAXN-th root of unity
+    static unsigned rt[MAXN / 2], irt[MAXN / 2];
+    static std::atomic<int> twiddleN;   // rt[0, twiddleN) and irt[0, twiddleN) are built
+    static std::mutex twiddleMutex;
 
     // counting trailing zeros
     static int ctz(int x) {
@@ -52,82 +71,559 @@ struct FastNTT {
 #endif
     }
 
-    static void init() {
-        if (!initiated) {
-            for (int i = 1; i < MAXN; i <<= 1) {
-                int base = modPow(root, (mod - 1) / (i * 2));
-                int baseInv = modInv(base);
+    // thread-safe, twiddle tables are built incrementally up to transforms of size n,
+    //   so small transforms don't touch the whole tables
+    static void init(int n = MAXN) {
+        int need = min(MAXN / 2, max(2, n / 2));
+        if (twiddleN.load(std::memory_order_acquire) >= need)
+            return;
+
+        std::lock_guard<std::mutex> lock(twiddleMutex);
+        int built = twiddleN.load(std::memory_order_relaxed);
+        if (built == 0) {
+            rt[0] = irt[0] = toMont(1);
+            built = 1;
+        }
+        for (; built < need; built <<= 1)
+            buildTwiddles(ctz(built));
+        twiddleN.store(built, std::memory_order_release);
+    }
 
-                int tw = 1, twInv = 1;
-                for (int j = 0; j < i; j++) {
-                    w[i + j] = tw;
-                    wInv[i + j] = twInv;
+    // builds rt[2^k, 2^(k+1)) and irt[2^k, 2^(k+1))
+    static void buildTwiddles(int k) {
+        // z = primitive (2^(k+2))-th root of unity
+        unsigned z = toMont(modPow(root, (mod - 1) >> (k + 2)));
+        unsigned zInv = toMont(modInv(modPow(root, (mod - 1) >> (k + 2))));
+        for (int j = 0; j < (1 << k); j++) {
+            rt[(1 << k) + j] = normalizeMont(montMul(rt[j], z));
+            irt[(1 << k) + j] = normalizeMont(montMul(irt[j], zInv));
+        }
+    }
 
-                    tw = int(1ll * tw * base % mod);
-                    twInv = int(1ll * twInv * baseInv % mod);
-                }
-            }
+    //--- Montgomery arithmetic (R = 2^32) ---
+    // Values are kept in [0, 2 * mod) during transforms, and they are reduced to [0, mod) at the end.
+    // Only twiddle factors are in Montgomery form, so montMul(x, toMont(t)) = x * t (mod).
 
-            for (int i = 0; i <= MaxBitSize; i++)
-                nInv[i] = modInv(1 << i);
+    static const unsigned MOD2 = 2u * unsigned(mod);
+
+    // mod^-1 (mod 2^32) by Newton's method, each step doubles correct bits
+    static constexpr unsigned montInvStep(unsigned x, int step) {
+        return step == 0 ? x : montInvStep(x * (2u - unsigned(mod) * x), step - 1);
+    }
+
+    static const unsigned MOD_NEG_INV = 0u - montInvStep(unsigned(mod), 5);
+
+    // x < mod * 2^32, returns x * 2^-32 (mod) in [0, 2 * mod)
+    static unsigned montReduce(unsigned long long x) {
+        unsigned m = unsigned(x) * MOD_NEG_INV;
+        return unsigned((x + 1ull * m * unsigned(mod)) >> 32);
+    }
+
+    // a * b < mod * 2^32
+    static unsigned montMul(unsigned a, unsigned b) {
+        return montReduce(1ull * a * b);
+    }
+
+    static unsigned toMont(int x) {
+        return unsigned((static_cast<unsigned long long>(x) << 32) % unsigned(mod));
+    }
+
+    // [0, 4 * mod) -> [0, 2 * mod)
+    static unsigned reduce2(unsigned x) {
+        return x >= MOD2 ? x - MOD2 : x;
+    }
+
+    // [0, 2 * mod) -> [0, mod)
+    static unsigned normalizeMont(unsigned x) {
+        return x >= unsigned(mod) ? x - unsigned(mod) : x;
+    }
+
+#if defined(__AVX2__)
+    static __m256i montMul(__m256i a, __m256i b) {
+        const __m256i vmod = _mm256_set1_epi32(mod);
+        const __m256i vnegInv = _mm256_set1_epi32(int(MOD_NEG_INV));
+
+        __m256i pe = _mm256_mul_epu32(a, b);
+        __m256i po = _mm256_mul_epu32(_mm256_srli_epi64(a, 32), _mm256_srli_epi64(b, 32));
+        __m256i me = _mm256_mul_epu32(_mm256_mul_epu32(pe, vnegInv), vmod);
+        __m256i mo = _mm256_mul_epu32(_mm256_mul_epu32(po, vnegInv), vmod);
+        __m256i re = _mm256_srli_epi64(_mm256_add_epi64(pe, me), 32);
+        __m256i ro = _mm256_add_epi64(po, mo);
+        return _mm256_blend_epi32(re, ro, 0xAA);
+    }
+
+    static __m256i reduce2(__m256i x) {
+        return _mm256_min_epu32(x, _mm256_sub_epi32(x, _mm256_set1_epi32(int(MOD2))));
+    }
+
+    static __m256i load(const unsigned* p) {
+        return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    }
+
+    static void store(unsigned* p, __m256i x) {
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), x);
+    }
+#endif
+
+    //--- transforms ---
+    // Iterative radix-4 NTT (two radix-2 levels at once).
+    //  - transform()    : natural order -> bit-reversed order (Cooley-Tukey)
+    //  - transformInv() : bit-reversed order -> natural order (Gentleman-Sande), without scaling by 1/n
+    // inputs must be in [0, 2 * mod), outputs are in [0, 2 * mod)
+    // PRECONDITION: init(n) was called
+    //
+    // A radix-4 block at level 'len' has 4 * q elements (q = n / 4^(len/2+1)) and twiddles u = rt[2s], u^2 = rt[s], u^3.
+    // With AVX2, blocks of q >= 8 are processed 8 elements at a time,
+    //   and the last two levels (q = 4, q = 1) are transposed in registers to fill 8 lanes.
+
+    // forward radix-4 butterfly
+    static void butterfly4(unsigned& x0, unsigned& x1, unsigned& x2, unsigned& x3,
+                           unsigned u, unsigned u2, unsigned u3, unsigned imag) {
+        unsigned y1 = montMul(x1, u), y2 = montMul(x2, u2), y3 = montMul(x3, u3);
+
+        unsigned s02 = reduce2(x0 + y2), d02 = reduce2(x0 + MOD2 - y2);
+        unsigned s13 = reduce2(y1 + y3), d13 = montMul(y1 + MOD2 - y3, imag);
+
+        x0 = reduce2(s02 + s13);
+        x1 = reduce2(s02 + MOD2 - s13);
+        x2 = reduce2(d02 + d13);
+        x3 = reduce2(d02 + MOD2 - d13);
+    }
+
+    // inverse radix-4 butterfly
+    static void butterfly4Inv(unsigned& x0, unsigned& x1, unsigned& x2, unsigned& x3,
+                              unsigned u, unsigned u2, unsigned u3, unsigned imagInv) {
+        unsigned s01 = reduce2(x0 + x1), d01 = reduce2(x0 + MOD2 - x1);
+        unsigned s23 = reduce2(x2 + x3), d23 = montMul(x2 + MOD2 - x3, imagInv);
+
+        x0 = reduce2(s01 + s23);
+        x1 = montMul(d01 + d23, u);
+        x2 = montMul(s01 + MOD2 - s23, u2);
+        x3 = montMul(d01 + MOD2 - d23, u3);
+    }
 
-            initiated = true;
+#if defined(__AVX2__)
+    static void butterfly4(__m256i& x0, __m256i& x1, __m256i& x2, __m256i& x3,
+                           __m256i u, __m256i u2, __m256i u3, __m256i imag) {
+        const __m256i vmod2 = _mm256_set1_epi32(int(MOD2));
+
+        __m256i y1 = montMul(x1, u), y2 = montMul(x2, u2), y3 = montMul(x3, u3);
+
+        __m256i s02 = reduce2(_mm256_add_epi32(x0, y2));
+        __m256i d02 = reduce2(_mm256_sub_epi32(_mm256_add_epi32(x0, vmod2), y2));
+        __m256i s13 = reduce2(_mm256_add_epi32(y1, y3));
+        __m256i d13 = montMul(_mm256_sub_epi32(_mm256_add_epi32(y1, vmod2), y3), imag);
+
+        x0 = reduce2(_mm256_add_epi32(s02, s13));
+        x1 = reduce2(_mm256_sub_epi32(_mm256_add_epi32(s02, vmod2), s13));
+        x2 = reduce2(_mm256_add_epi32(d02, d13));
+        x3 = reduce2(_mm256_sub_epi32(_mm256_add_epi32(d02, vmod2), d13));
+    }
+
+    static void butterfly4Inv(__m256i& x0, __m256i& x1, __m256i& x2, __m256i& x3,
+                              __m256i u, __m256i u2, __m256i u3, __m256i imagInv) {
+        const __m256i vmod2 = _mm256_set1_epi32(int(MOD2));
+
+        __m256i s01 = reduce2(_mm256_add_epi32(x0, x1));
+        __m256i d01 = reduce2(_mm256_sub_epi32(_mm256_add_epi32(x0, vmod2), x1));
+        __m256i s23 = reduce2(_mm256_add_epi32(x2, x3));
+        __m256i d23 = montMul(_mm256_sub_epi32(_mm256_add_epi32(x2, vmod2), x3), imagInv);
+
+        x0 = reduce2(_mm256_add_epi32(s01, s23));
+        x1 = montMul(_mm256_add_epi32(d01, d23), u);
+        x2 = montMul(_mm256_sub_epi32(_mm256_add_epi32(s01, vmod2), s23), u2);
+        x3 = montMul(_mm256_sub_epi32(_mm256_add_epi32(d01, vmod2), d23), u3);
+    }
+
+    // 4x4 transpose in each 128-bit lane, it's an involution
+    static void transpose4x4(__m256i& v0, __m256i& v1, __m256i& v2, __m256i& v3) {
+        __m256i t0 = _mm256_unpacklo_epi32(v0, v1), t1 = _mm256_unpackhi_epi32(v0, v1);
+        __m256i t2 = _mm256_unpacklo_epi32(v2, v3), t3 = _mm256_unpackhi_epi32(v2, v3);
+        v0 = _mm256_unpacklo_epi64(t0, t2);
+        v1 = _mm256_unpackhi_epi64(t0, t2);
+        v2 = _mm256_unpacklo_epi64(t1, t3);
+        v3 = _mm256_unpackhi_epi64(t1, t3);
+    }
+
+    // twiddles of 8 blocks, idx = block indexes
+    static void loadTwiddles(const unsigned* table, __m256i idx, __m256i& u, __m256i& u2, __m256i& u3) {
+        const int* t = reinterpret_cast<const int*>(table);
+        u = _mm256_i32gather_epi32(t, _mm256_add_epi32(idx, idx), 4);
+        u2 = _mm256_i32gather_epi32(t, idx, 4);
+        u3 = montMul(u, u2);
+    }
+
+    // a radix-4 level of q >= 8, blocks in [sFirst, sLast), elements in [iFirst, iLast) of each block
+    template <bool Inverse>
+    static void radix4Level(unsigned* a, int q, int sFirst, int sLast, int iFirst, int iLast,
+                            const unsigned* table, unsigned imag) {
+        const __m256i vimag = _mm256_set1_epi32(int(imag));
+        for (int s = sFirst; s < sLast; s++) {
+            unsigned u = table[2 * s], u2 = table[s];
+            const __m256i vu = _mm256_set1_epi32(int(u)), vu2 = _mm256_set1_epi32(int(u2));
+            const __m256i vu3 = _mm256_set1_epi32(int(montMul(u, u2)));
+
+            unsigned* p = a + s * 4 * q;
+            for (int i = iFirst; i < iLast; i += 8) {
+                __m256i x0 = load(p + i), x1 = load(p + i + q), x2 = load(p + i + 2 * q), x3 = load(p + i + 3 * q);
+                if (Inverse)
+                    butterfly4Inv(x0, x1, x2, x3, vu, vu2, vu3, vimag);
+                else
+                    butterfly4(x0, x1, x2, x3, vu, vu2, vu3, vimag);
+                store(p + i, x0);
+                store(p + i + q, x1);
+                store(p + i + 2 * q, x2);
+                store(p + i + 3 * q, x3);
+            }
         }
     }
 
-    static void ntt(const int* in, int* out, int n, int k = 1) {
-        if (n == 1) {
-            *out = *in;
-        } else {
-            n >>= 1;
-            ntt(in, out, n, k << 1);
-            ntt(in + k, out + n, n, k << 1);
-            for (int i = 0; i < n; i++) {
-                int t = int(1ll * out[i + n] * w[i + n] % mod);
+    // the radix-4 level of q = 4, two blocks (32 elements) at a time
+    //   PRECONDITION: sFirst and sLast are multiples of 2
+    template <bool Inverse>
+    static void radix4LevelQ4(unsigned* a, int sFirst, int sLast, const unsigned* table, unsigned imag) {
+        const __m256i vimag = _mm256_set1_epi32(int(imag));
+        for (int s = sFirst; s < sLast; s += 2) {
+            unsigned* p = a + s * 16;
+
+            // v0 = (x0, x1) of block s, v1 = (x2, x3) of block s, v2 and v3 of block s + 1
+            __m256i v0 = load(p), v1 = load(p + 8), v2 = load(p + 16), v3 = load(p + 24);
+            __m256i x0 = _mm256_permute2x128_si256(v0, v2, 0x20);
+            __m256i x1 = _mm256_permute2x128_si256(v0, v2, 0x31);
+            __m256i x2 = _mm256_permute2x128_si256(v1, v3, 0x20);
+            __m256i x3 = _mm256_permute2x128_si256(v1, v3, 0x31);
+
+            __m256i u, u2, u3;
+            loadTwiddles(table, _mm256_setr_epi32(s, s, s, s, s + 1, s + 1, s + 1, s + 1), u, u2, u3);
+            if (Inverse)
+                butterfly4Inv(x0, x1, x2, x3, u, u2, u3, vimag);
+            else
+                butterfly4(x0, x1, x2, x3, u, u2, u3, vimag);
+
+            store(p, _mm256_permute2x128_si256(x0, x1, 0x20));
+            store(p + 8, _mm256_permute2x128_si256(x2, x3, 0x20));
+            store(p + 16, _mm256_permute2x128_si256(x0, x1, 0x31));
+            store(p + 24, _mm256_permute2x128_si256(x2, x3, 0x31));
+        }
+    }
 
-                out[i + n] = out[i] - t;
-                if (out[i + n] < 0)
-                    out[i + n] += mod;
+    // the radix-4 level of q = 1, eight blocks (32 elements) at a time
+    //   PRECONDITION: sFirst and sLast are multiples of 8
+    template <bool Inverse>
+    static void radix4LevelQ1(unsigned* a, int sFirst, int sLast, const unsigned* table, unsigned imag) {
+        const __m256i vimag = _mm256_set1_epi32(int(imag));
+        // the block order in lanes after transpose4x4()
+        const __m256i order = _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7);
+        for (int s = sFirst; s < sLast; s += 8) {
+            unsigned* p = a + s * 4;
+
+            __m256i x0 = load(p), x1 = load(p + 8), x2 = load(p + 16), x3 = load(p + 24);
+            transpose4x4(x0, x1, x2, x3);
+
+            __m256i u, u2, u3;
+            loadTwiddles(table, _mm256_add_epi32(_mm256_set1_epi32(s), order), u, u2, u3);
+            if (Inverse)
+                butterfly4Inv(x0, x1, x2, x3, u, u2, u3, vimag);
+            else
+                butterfly4(x0, x1, x2, x3, u, u2, u3, vimag);
+
+            transpose4x4(x0, x1, x2, x3);
+            store(p, x0);
+            store(p + 8, x1);
+            store(p + 16, x2);
+            store(p + 24, x3);
+        }
+    }
+#endif
 
-                out[i] += t;
-                if (out[i] >= mod)
-                    out[i] -= mod;
+    // a radix-4 level, blocks in [sFirst, sLast) and elements in [iFirst, iLast) of each block
+    //   PRECONDITION: the range is whole blocks of 32 elements or more, or iFirst and iLast are multiples of 8
+    template <bool Inverse>
+    static void radix4Level(unsigned* a, int n, int len, int sFirst, int sLast, int iFirst, int iLast) {
+        const unsigned* table = Inverse ? irt : rt;
+        unsigned imag = table[1];
+        int q = n >> (len + 2);
+#if defined(__AVX2__)
+        if (q >= 8) {
+            radix4Level<Inverse>(a, q, sFirst, sLast, iFirst, iLast, table, imag);
+            return;
+        } else if ((sLast - sFirst) * 4 * q >= 32) {
+            if (q == 4)
+                radix4LevelQ4<Inverse>(a, sFirst, sLast, table, imag);
+            else
+                radix4LevelQ1<Inverse>(a, sFirst, sLast, table, imag);
+            return;
+        }
+#endif
+        for (int s = sFirst; s < sLast; s++) {
+            unsigned u = table[2 * s], u2 = table[s], u3 = montMul(u, u2);
+            unsigned* p = a + s * 4 * q;
+            for (int i = iFirst; i < iLast; i++) {
+                if (Inverse)
+                    butterfly4Inv(p[i], p[i + q], p[i + 2 * q], p[i + 3 * q], u, u2, u3, imag);
+                else
+                    butterfly4(p[i], p[i + q], p[i + 2 * q], p[i + 3 * q], u, u2, u3, imag);
             }
         }
     }
 
-    static void nttInv(const int* in, int* out, int n, int k = 1) {
-        if (n == 1) {
-            *out = *in;
-        } else {
-            n >>= 1;
-            nttInv(in, out, n, k << 1);
-            nttInv(in + k, out + n, n, k << 1);
-            for (int i = 0; i < n; i++) {
-                int t = int(1ll * out[i + n] * wInv[i + n] % mod);
+    // the radix-2 level 0 (twiddle = 1), elements in [iFirst, iLast) of the first half
+    static void radix2Level0(unsigned* a, int n, int iFirst, int iLast) {
+        int p = n >> 1;
+        int i = iFirst;
+#if defined(__AVX2__)
+        const __m256i vmod2 = _mm256_set1_epi32(int(MOD2));
+        for (; i + 8 <= iLast; i += 8) {
+            __m256i x = load(a + i), y = load(a + i + p);
+            store(a + i, reduce2(_mm256_add_epi32(x, y)));
+            store(a + i + p, reduce2(_mm256_sub_epi32(_mm256_add_epi32(x, vmod2), y)));
+        }
+#endif
+        for (; i < iLast; i++) {
+            unsigned x = a[i], y = a[i + p];
+            a[i] = reduce2(x + y);
+            a[i + p] = reduce2(x + MOD2 - y);
+        }
+    }
+
+    static void transform(unsigned* a, int n) {
+        int levels = ctz(n);
+        int len = 0;
+        if (levels & 1) {
+            radix2Level0(a, n, 0, n >> 1);
+            len = 1;
+        }
+        for (; len < levels; len += 2)
+            radix4Level<false>(a, n, len, 0, 1 << len, 0, n >> (len + 2));
+    }
+
+    static void transformInv(unsigned* a, int n) {
+        int levels = ctz(n);
+        for (int len = levels - 2; len >= (levels & 1); len -= 2)
+            radix4Level<true>(a, n, len, 0, 1 << len, 0, n >> (len + 2));
+        if (levels & 1)
+            radix2Level0(a, n, 0, n >> 1);
+    }
+
+    //--- parallel transforms ---
+    // Opt-in multi-threaded transforms for large sizes (n >= 2^16).
+    //  1) top levels : each block is split into 'threadN' element ranges
+    //  2) other levels : the array is split into P pieces (P >= 4 * threadN), and each piece is transformed
+    //     independently. Idle threads take the next piece, so threads are balanced dynamically.
+    // Threads are created for each level of 1) and for 2), so it's O(threadN * log(threadN)) thread creations.
+
+    // f(t), 0 <= t < threadN, f(0) runs in the current thread
+    template <typename FuncT>
+    static void parallelFor(int threadN, const FuncT& f) {
+        vector<thread> threads;
+        threads.reserve(threadN - 1);
+        for (int t = 1; t < threadN; t++)
+            threads.emplace_back(f, t);
+        f(0);
+        for (auto& th : threads)
+            th.join();
+    }
 
-                out[i + n] = out[i] - t;
-                if (out[i + n] < 0)
-                    out[i + n] += mod;
+    // the t-th of 'parts' ranges of [0, n), the boundaries are multiples of 'align'
+    static pair<int, int> splitRange(int n, int parts, int t, int align) {
+        int chunk = ((n + align - 1) / align + parts - 1) / parts * align;
+        int first = min(n, t * chunk);
+        return{ first, min(n, first + chunk) };
+    }
+
+    // the number of pieces and the first level of 2)
+    static int parallelPieces(int n, int threadN, int& firstLen) {
+        int levels = ctz(n);
+
+        int pieces = 1;
+        while (pieces < 4 * threadN)
+            pieces <<= 1;
+        while (pieces > 1 && n / pieces < 1024)
+            pieces >>= 1;
+
+        firstLen = levels & 1;
+        while (firstLen < levels && (1 << firstLen) < pieces)
+            firstLen += 2;
+
+        return pieces;
+    }
+
+    static void transformParallel(unsigned* a, int n, int threadN) {
+        int firstLen;
+        int pieces = parallelPieces(n, threadN, firstLen);
+        if (threadN <= 1 || pieces < threadN) {
+            transform(a, n);
+            return;
+        }
 
-                out[i] += t;
-                if (out[i] >= mod)
-                    out[i] -= mod;
+        int levels = ctz(n);
+        int len = 0;
+        if (levels & 1) {
+            parallelFor(threadN, [a, n, threadN](int t) {
+                auto r = splitRange(n >> 1, threadN, t, 8);
+                radix2Level0(a, n, r.first, r.second);
+            });
+            len = 1;
+        }
+        for (; len < firstLen; len += 2) {
+            parallelFor(threadN, [a, n, len, threadN](int t) {
+                auto r = splitRange(n >> (len + 2), threadN, t, 8);
+                radix4Level<false>(a, n, len, 0, 1 << len, r.first, r.second);
+            });
+        }
+
+        std::atomic<int> next(0);
+        parallelFor(threadN, [a, n, levels, firstLen, pieces, &next](int) {
+            for (int k = next++; k < pieces; k = next++) {
+                for (int l = firstLen; l < levels; l += 2) {
+                    int step = (1 << l) / pieces;
+                    radix4Level<false>(a, n, l, k * step, (k + 1) * step, 0, n >> (l + 2));
+                }
             }
+        });
+    }
+
+    static void transformInvParallel(unsigned* a, int n, int threadN) {
+        int firstLen;
+        int pieces = parallelPieces(n, threadN, firstLen);
+        if (threadN <= 1 || pieces < threadN) {
+            transformInv(a, n);
+            return;
+        }
 
-            if (k == 1) {
-                n <<= 1;
-                int inv = nInv[ctz(n)];
-                for (int i = 0; i < n; i++)
-                    out[i] = int(1ll * out[i] * inv % mod);
+        int levels = ctz(n);
+
+        std::atomic<int> next(0);
+        parallelFor(threadN, [a, n, levels, firstLen, pieces, &next](int) {
+            for (int k = next++; k < pieces; k = next++) {
+                for (int l = levels - 2; l >= firstLen; l -= 2) {
+                    int step = (1 << l) / pieces;
+                    radix4Level<true>(a, n, l, k * step, (k + 1) * step, 0, n >> (l + 2));
+                }
             }
+        });
+
+        for (int len = firstLen - 2; len >= (levels & 1); len -= 2) {
+            parallelFor(threadN, [a, n, len, threadN](int t) {
+                auto r = splitRange(n >> (len + 2), threadN, t, 8);
+                radix4Level<true>(a, n, len, 0, 1 << len, r.first, r.second);
+            });
+        }
+        if (levels & 1) {
+            parallelFor(threadN, [a, n, threadN](int t) {
+                auto r = splitRange(n >> 1, threadN, t, 8);
+                radix2Level0(a, n, r.first, r.second);
+            });
         }
     }
 
-    //---
+    // a[i] = a[i] * b[i] * scale / 2^64 (mod)
+    static void multiplyPointwise(unsigned* a, const unsigned* b, int n, unsigned scale) {
+        int i = 0;
+#if defined(__AVX2__)
+        const __m256i vscale = _mm256_set1_epi32(int(scale));
+        for (; i + 8 <= n; i += 8)
+            store(a + i, montMul(montMul(load(a + i), load(b + i)), vscale));
+#endif
+        for (; i < n; i++)
+            a[i] = montMul(montMul(a[i], b[i]), scale);
+    }
+
+    // a[i] = a[i] * b[i] / 2^32 (mod)
+    static void multiplyPointwise(unsigned* a, const unsigned* b, int n) {
+        int i = 0;
+#if defined(__AVX2__)
+        for (; i + 8 <= n; i += 8)
+            store(a + i, montMul(load(a + i), load(b + i)));
+#endif
+        for (; i < n; i++)
+            a[i] = montMul(a[i], b[i]);
+    }
+
+    // [0, 2 * mod) -> [0, mod)
+    static void normalizeMont(unsigned* a, int n) {
+        int i = 0;
+#if defined(__AVX2__)
+        const __m256i vmod = _mm256_set1_epi32(mod);
+        for (; i + 8 <= n; i += 8) {
+            __m256i x = load(a + i);
+            store(a + i, _mm256_min_epu32(x, _mm256_sub_epi32(x, vmod)));
+        }
+#endif
+        for (; i < n; i++)
+            a[i] = normalizeMont(a[i]);
+    }
+
+    // the factor for multiplyPointwise() to get a[i] * b[i] / n
+    static unsigned pointwiseScale(int n) {
+        // toMont(1/n) * 2^32 = 2^64 / n
+        return toMont(int(1ll * modInv(n) * toMont(1) % mod));
+    }
+
+    static void bitReverse(int* a, int n) {
+        for (int i = 1, j = 0; i < n; i++) {
+            int bit = n >> 1;
+            for (; j & bit; bit >>= 1)
+                j ^= bit;
+            j ^= bit;
+            if (i < j)
+                swap(a[i], a[j]);
+        }
+    }
+
+    // natural order -> natural order
+    static void ntt(const int* in, int* out, int n) {
+        init(n);
+        if (in != out)
+            memcpy(out, in, sizeof(int) * n);
+        transform(reinterpret_cast<unsigned*>(out), n);
+        normalizeMont(reinterpret_cast<unsigned*>(out), n);
+        bitReverse(out, n);
+    }
+
+    static void nttInv(const int* in, int* out, int n) {
+        init(n);
+        if (in != out)
+            memcpy(out, in, sizeof(int) * n);
+        bitReverse(out, n);
 
-    static int A[MAXN], B[MAXN];
-    static int C[MAXN], D[MAXN];
+        unsigned* p = reinterpret_cast<unsigned*>(out);
+        transformInv(p, n);
+
+        unsigned scale = toMont(modInv(n));
+        for (int i = 0; i < n; i++)
+            p[i] = normalizeMont(montMul(p[i], scale));
+    }
+
+    //--- workspace ---
+
+    // Scratch memory of multiply() and square().
+    //  - a workspace must not be used by two threads at the same time
+    //  - functions without a workspace parameter use the workspace of the current thread (defaultWorkspace()),
+    //    so all operations are re-entrant and independent jobs can run in parallel
+    struct Workspace {
+        vector<unsigned> A, B;
+
+        void reserve(int n) {
+            if (int(A.size()) < n) {
+                A.resize(n);
+                B.resize(n);
+            }
+        }
+
+        // releases memory
+        void clear() {
+            vector<unsigned>().swap(A);
+            vector<unsigned>().swap(B);
+        }
+    };
+
+    static Workspace& defaultWorkspace() {
+        static thread_local Workspace ws;
+        return ws;
+    }
+
+    //---
 
     static vector<int> multiplySlow(const vector<int>& a, const vector<int>& b) {
         vector<int> res(a.size() + b.size() - 1);
@@ -140,39 +636,68 @@ struct FastNTT {
     }
 
     static vector<int> multiply(const vector<int>& a, const vector<int>& b, bool reverseB = false) {
+        return multiply(a, b, defaultWorkspace(), reverseB);
+    }
+
+    // multiply() with 'threadN' threads, use it for large inputs (the result size >= 2^16)
+    static vector<int> multiplyParallel(const vector<int>& a, const vector<int>& b, int threadN, bool reverseB = false) {
+        return multiply(a, b, defaultWorkspace(), reverseB, threadN);
+    }
+
+    static vector<int> multiply(const vector<int>& a, const vector<int>& b, Workspace& ws, bool reverseB = false,
+                                int threadN = 1) {
         int sizeA = int(a.size());
         int sizeB = int(b.size());
 
-        if (min(sizeA, sizeB) < 256)
+        if (min(sizeA, sizeB) < 256) {
+            if (reverseB)
+                return multiplySlow(a, vector<int>(b.rbegin(), b.rend()));
             return multiplySlow(a, b);
-
-        init();
+        }
 
         int n = sizeA + sizeB - 1;
         int size = 1;
         while (size < n)
             size <<= 1;
 
+        init(size);
+
+        ws.reserve(size);
+        unsigned* A = ws.A.data();
+        unsigned* B = ws.B.data();
+
         memcpy(A, a.data(), sizeof(int) * sizeA);
         if (!reverseB)
             memcpy(B, b.data(), sizeof(int) * sizeB);
         else {
             for (int i = 0, j = sizeB - 1; j >= 0; i++, j--)
-                B[j] = b[i];
+                B[j] = unsigned(b[i]);
         }
         memset(A + sizeA, 0, sizeof(int) * (size - sizeA));
         memset(B + sizeB, 0, sizeof(int) * (size - sizeB));
 
-        ntt(A, C, size);
-        ntt(B, D, size);
-
-        for (int i = 0; i < size; i++)
-            A[i] = int(1ll * C[i] * D[i] % mod);
-
-        vector<int> res(size);
-        nttInv(A, res.data(), size);
+        if (threadN <= 1) {
+            transform(A, size);
+            transform(B, size);
+            multiplyPointwise(A, B, size, pointwiseScale(size));
+            transformInv(A, size);
+            normalizeMont(A, n);
+        } else {
+            transformParallel(A, size, threadN);
+            transformParallel(B, size, threadN);
+            unsigned scale = pointwiseScale(size);
+            parallelFor(threadN, [A, B, size, n, scale, threadN](int t) {
+                auto r = splitRange(size, threadN, t, 8);
+                multiplyPointwise(A + r.first, B + r.first, r.second - r.first, scale);
+            });
+            transformInvParallel(A, size, threadN);
+            parallelFor(threadN, [A, n, threadN](int t) {
+                auto r = splitRange(n, threadN, t, 8);
+                normalizeMont(A + r.first, r.second - r.first);
+            });
+        }
 
-        res.resize(n);
+        vector<int> res(A, A + n);
         normalize(res);
         return res;
     }
@@ -181,6 +706,115 @@ struct FastNTT {
         return multiply(x, h, reverseH);
     }
 
+    //--- prepared operands ---
+    // A fixed operand is transformed once, then each multiplication costs one forward and one inverse transform.
+    //
+    //   auto K = FastNTT<>::prepare(kernel, maxSizeX);     // or prepare(h, maxSizeX, true) for convolute(x, h)
+    //   for (auto& x : streams)
+    //       y = FastNTT<>::multiply(K, x);                 // == multiply(kernel, x)
+    //
+    // A prepared operand is read-only, so it can be shared by threads.
+    struct PreparedPoly {
+        int sizeA;              // the size of the prepared operand
+        int size;               // the transform size
+        vector<unsigned> F;     // the transform of the operand (bit-reversed order), multiplied by 2^32 / size
+
+        PreparedPoly() : sizeA(0), size(0) {
+        }
+
+        // the max size of the other operand
+        int maxOperandSize() const {
+            return size - sizeA + 1;
+        }
+    };
+
+    // 'maxSizeB' is the max size of operands to multiply with 'a'
+    static PreparedPoly prepare(const vector<int>& a, int maxSizeB, bool reverseA = false, int threadN = 1) {
+        PreparedPoly res;
+        res.sizeA = int(a.size());
+
+        res.size = 1;
+        while (res.size < res.sizeA + maxSizeB - 1)
+            res.size <<= 1;
+
+        int size = res.size;
+        init(size);
+
+        res.F.assign(size, 0);
+        unsigned* F = res.F.data();
+        if (!reverseA)
+            memcpy(F, a.data(), sizeof(int) * res.sizeA);
+        else {
+            for (int i = 0, j = res.sizeA - 1; j >= 0; i++, j--)
+                F[j] = unsigned(a[i]);
+        }
+
+        unsigned scale = pointwiseScale(size);
+        if (threadN <= 1) {
+            transform(F, size);
+            for (int i = 0; i < size; i++)
+                F[i] = montMul(F[i], scale);
+        } else {
+            transformParallel(F, size, threadN);
+            parallelFor(threadN, [F, size, scale, threadN](int t) {
+                auto r = splitRange(size, threadN, t, 8);
+                for (int i = r.first; i < r.second; i++)
+                    F[i] = montMul(F[i], scale);
+            });
+        }
+
+        return res;
+    }
+
+    static vector<int> multiply(const PreparedPoly& a, const vector<int>& b) {
+        return multiply(a, b, defaultWorkspace());
+    }
+
+    // PRECONDITION: b.size() <= a.maxOperandSize()
+    static vector<int> multiply(const PreparedPoly& a, const vector<int>& b, Workspace& ws, int threadN = 1) {
+        int sizeB = int(b.size());
+        assert(sizeB <= a.maxOperandSize());
+        if (a.sizeA == 0 || sizeB == 0)
+            return vector<int>();
+
+        int n = a.sizeA + sizeB - 1;
+        int size = a.size;
+
+        ws.reserve(size);
+        unsigned* A = ws.A.data();
+        const unsigned* F = a.F.data();
+
+        memcpy(A, b.data(), sizeof(int) * sizeB);
+        memset(A + sizeB, 0, sizeof(int) * (size - sizeB));
+
+        if (threadN <= 1) {
+            transform(A, size);
+            multiplyPointwise(A, F, size);
+            transformInv(A, size);
+            normalizeMont(A, n);
+        } else {
+            transformParallel(A, size, threadN);
+            parallelFor(threadN, [A, F, size, threadN](int t) {
+                auto r = splitRange(size, threadN, t, 8);
+                multiplyPointwise(A + r.first, F + r.first, r.second - r.first);
+            });
+            transformInvParallel(A, size, threadN);
+            parallelFor(threadN, [A, n, threadN](int t) {
+                auto r = splitRange(n, threadN, t, 8);
+                normalizeMont(A + r.first, r.second - r.first);
+            });
+        }
+
+        vector<int> res(A, A + n);
+        normalize(res);
+        return res;
+    }
+
+    // 'h' must be prepared with reverseA = reverseH
+    static vector<int> convolute(const vector<int>& x, const PreparedPoly& h) {
+        return multiply(h, x);
+    }
+
     //--- extended operations
 
     static void normalize(vector<int>& poly) {
@@ -325,65 +959,207 @@ struct FastNTT {
     //---
 
     static vector<int> square(const vector<int>& a) {
+        return square(a, defaultWorkspace());
+    }
+
+    // square() with 'threadN' threads, use it for large inputs (the result size >= 2^16)
+    static vector<int> squareParallel(const vector<int>& a, int threadN) {
+        return square(a, defaultWorkspace(), threadN);
+    }
+
+    static vector<int> square(const vector<int>& a, Workspace& ws, int threadN = 1) {
         int sizeA = int(a.size());
         if (sizeA < 256)
             return multiplySlow(a, a);
 
-        init();
-
         int n = sizeA * 2 - 1;
         int size = 1;
         while (size < n)
             size <<= 1;
 
-        memcpy(A, a.data(), sizeof(int) * sizeA);
-        memset(A + sizeA, 0, sizeof(int) * (size - sizeA));
+        init(size);
 
-        ntt(A, B, size);
+        ws.reserve(size);
+        unsigned* A = ws.A.data();
 
-        for (int i = 0; i < size; i++)
-            A[i] = int(1ll * B[i] * B[i] % mod);
+        memcpy(A, a.data(), sizeof(int) * sizeA);
+        memset(A + sizeA, 0, sizeof(int) * (size - sizeA));
 
-        vector<int> res(size);
-        nttInv(A, res.data(), size);
+        if (threadN <= 1) {
+            transform(A, size);
+            multiplyPointwise(A, A, size, pointwiseScale(size));
+            transformInv(A, size);
+            normalizeMont(A, n);
+        } else {
+            transformParallel(A, size, threadN);
+            unsigned scale = pointwiseScale(size);
+            parallelFor(threadN, [A, size, scale, threadN](int t) {
+                auto r = splitRange(size, threadN, t, 8);
+                multiplyPointwise(A + r.first, A + r.first, r.second - r.first, scale);
+            });
+            transformInvParallel(A, size, threadN);
+            parallelFor(threadN, [A, n, threadN](int t) {
+                auto r = splitRange(n, threadN, t, 8);
+                normalizeMont(A + r.first, r.second - r.first);
+            });
+        }
 
-        res.resize(n);
+        vector<int> res(A, A + n);
         normalize(res);
         return res;
     }
 
+    //--- truncated products ---
+    // Power series operations need only a part of a product.
+    //  - multiplyTruncated(a, b, k) : (a * b) mod x^k, inputs are cut to k terms
+    //  - middleProduct(a, b)        : (a * b)[sizeB - 1, sizeA - 1], with one cyclic convolution of size >= sizeA
+    //                                 (terms wrapped around by the cyclic convolution land below sizeB - 1)
+    // Results are not normalized, they have exactly min(k, sizeA + sizeB - 1) and sizeA - sizeB + 1 terms.
+
+    static vector<int> multiplyTruncated(const vector<int>& a, const vector<int>& b, int k) {
+        return multiplyTruncated(a, b, k, defaultWorkspace());
+    }
+
+    static vector<int> multiplyTruncated(const vector<int>& a, const vector<int>& b, int k, Workspace& ws) {
+        int sizeA = min(int(a.size()), k);
+        int sizeB = min(int(b.size()), k);
+        if (sizeA <= 0 || sizeB <= 0)
+            return vector<int>();
+
+        int n = min(k, sizeA + sizeB - 1);
+        if (min(sizeA, sizeB) < 64) {
+            vector<int> res(n);
+            for (int i = 0; i < sizeA; i++) {
+                for (int j = 0; j < sizeB && i + j < n; j++)
+                    res[i + j] = int((res[i + j] + 1ll * a[i] * b[j]) % mod);
+            }
+            return res;
+        }
+
+        int size = 1;
+        while (size < sizeA + sizeB - 1)
+            size <<= 1;
+
+        init(size);
+
+        ws.reserve(size);
+        unsigned* A = ws.A.data();
+        unsigned* B = ws.B.data();
+
+        memcpy(A, a.data(), sizeof(int) * sizeA);
+        memset(A + sizeA, 0, sizeof(int) * (size - sizeA));
+        transform(A, size);
+        if (&a == &b && sizeA == sizeB)
+            multiplyPointwise(A, A, size, pointwiseScale(size));
+        else {
+            memcpy(B, b.data(), sizeof(int) * sizeB);
+            memset(B + sizeB, 0, sizeof(int) * (size - sizeB));
+            transform(B, size);
+            multiplyPointwise(A, B, size, pointwiseScale(size));
+        }
+        transformInv(A, size);
+        normalizeMont(A, n);
+
+        return vector<int>(A, A + n);
+    }
+
+    static vector<int> middleProduct(const vector<int>& a, const vector<int>& b) {
+        return middleProduct(a, b, defaultWorkspace());
+    }
+
+    // PRECONDITION: a.size() >= b.size() > 0
+    static vector<int> middleProduct(const vector<int>& a, const vector<int>& b, Workspace& ws) {
+        int sizeA = int(a.size());
+        int sizeB = int(b.size());
+        int n = sizeA - sizeB + 1;
+
+        if (sizeB < 64 || n < 64) {
+            vector<int> res(n);
+            for (int i = 0; i < n; i++) {
+                long long sum = 0;
+                for (int j = 0; j < sizeB; j++)
+                    sum = (sum + 1ll * a[i + sizeB - 1 - j] * b[j]) % mod;
+                res[i] = int(sum);
+            }
+            return res;
+        }
+
+        int size = 1;
+        while (size < sizeA)
+            size <<= 1;
+
+        init(size);
+
+        ws.reserve(size);
+        unsigned* A = ws.A.data();
+        unsigned* B = ws.B.data();
+
+        memcpy(A, a.data(), sizeof(int) * sizeA);
+        memset(A + sizeA, 0, sizeof(int) * (size - sizeA));
+        memcpy(B, b.data(), sizeof(int) * sizeB);
+        memset(B + sizeB, 0, sizeof(int) * (size - sizeB));
+
+        transform(A, size);
+        transform(B, size);
+        multiplyPointwise(A, B, size, pointwiseScale(size));
+        transformInv(A, size);
+        normalizeMont(A + sizeB - 1, n);
+
+        return vector<int>(A + sizeB - 1, A + sizeA);
+    }
 
-#if 1
     // get inverse series mod x^n
+    //   Newton's method, g = 1/f (mod x^a) -> 1/f (mod x^2a) with five transforms of size 2a
+    //     h = (f * g)[a, 2a), it's a middle product of a cyclic convolution of size 2a
+    //     g[a, 2a) = -(g * h) mod x^a, the transform of g is reused
     static vector<int> inverse(const vector<int>& poly, int n) {
         //assert(!poly.empty());
+        if (n <= 0)
+            return vector<int>();
+
+        int maxSize = 1;
+        while (maxSize < n)
+            maxSize <<= 1;
 
         vector<int> res{ modInv(poly[0]) };
-        int a = 1;
-        while (a < n) {
-            vector<int> C = substr(multiply(res, modXK(poly, 2 * a)), a, 2 * a);
-            subtract(res, mulXK(modXK(multiply(res, C), a), a));
-            a *= 2;
+        if (maxSize == 1)
+            return res;
+
+        init(maxSize);
+
+        res.reserve(maxSize);
+        vector<unsigned> G(maxSize), F(maxSize);
+        for (int a = 1; a < n; a <<= 1) {
+            int size = 2 * a;
+            unsigned scale = pointwiseScale(size);
+
+            memcpy(G.data(), res.data(), sizeof(int) * a);
+            memset(G.data() + a, 0, sizeof(int) * a);
+            transform(G.data(), size);
+
+            int sizeF = min(size, int(poly.size()));
+            memcpy(F.data(), poly.data(), sizeof(int) * sizeF);
+            memset(F.data() + sizeF, 0, sizeof(int) * (size - sizeF));
+            transform(F.data(), size);
+            multiplyPointwise(F.data(), G.data(), size, scale);
+            transformInv(F.data(), size);
+
+            // F = h
+            normalizeMont(F.data() + a, a);
+            memcpy(F.data(), F.data() + a, sizeof(int) * a);
+            memset(F.data() + a, 0, sizeof(int) * a);
+            transform(F.data(), size);
+            multiplyPointwise(F.data(), G.data(), size, scale);
+            transformInv(F.data(), size);
+            normalizeMont(F.data(), a);
+
+            res.resize(size);
+            for (int i = 0; i < a; i++)
+                res[a + i] = F[i] ? int(mod - F[i]) : 0;
         }
-        return modXK(res, n);
-    }
-#else
-    // low order first
-    static vector<int> inverse(const vector<int>& a, int n) {
-        //assert(!a.empty());
-
-        vector<int> b = { modInv(a[0]) };
-        while (int(b.size()) < n) {
-            vector<int> a_cut(a.begin(), a.begin() + min(a.size(), b.size() << 1));
-            vector<int> x = multiply(square(b), a_cut);
-            b.resize(b.size() << 1);
-            for (int i = int(b.size()) >> 1; i < int(min(x.size(), b.size())); i++)
-                b[i] = mod - x[i];
-        }
-        b.resize(n);
-        return b;
+        res.resize(n);
+        return res;
     }
-#endif
 
     static vector<int> inverse(vector<int> a) {
         return inverse(a, int(a.size()));
@@ -400,11 +1176,16 @@ struct FastNTT {
 
     // low order first
     static vector<int> integrate(const vector<int>& poly) {
-        vector<int> res;
-        res.reserve(poly.size() + 1);
-        res.push_back(0);
-        for (int i = 0; i < int(poly.size()); i++)
-            res.push_back(int(1ll * poly[i] * modInv(i + 1) % mod));
+        int n = int(poly.size());
+
+        // inverses of 1..n in O(n)
+        vector<int> inv(n + 1, 1);
+        for (int i = 2; i <= n; i++)
+            inv[i] = int((mod - 1ll * (mod / i) * inv[mod % i] % mod) % mod);
+
+        vector<int> res(n + 1);
+        for (int i = 0; i < n; i++)
+            res[i + 1] = int(1ll * poly[i] * inv[i + 1] % mod);
         return res;
     }
 
@@ -413,12 +1194,14 @@ struct FastNTT {
     static vector<int> ln(vector<int> a) {
         auto A = inverse(a);
         auto B = derivate(a);
-        A = multiply(A, B);
+        A = multiplyTruncated(A, B, int(a.size()));
         A.resize(a.size());
         return integrate(A);
     }
 
     // low order first
+    //   b = exp(a) (mod x^(size/2)), exp(a) = b * (1 + a - ln(b)) (mod x^size)
+    //   a - ln(b) = 0 (mod x^(size/2)), so only the upper half is multiplied
     static vector<int> exp(vector<int> a) {
         int size = 1;
         while (size < int(a.size()))
@@ -429,18 +1212,22 @@ struct FastNTT {
 
         a.resize(size);
 
-        vector<int> dd(a.begin(), a.begin() + (size >> 1));
+        int half = size >> 1;
+        vector<int> dd(a.begin(), a.begin() + half);
 
         vector<int> b = exp(dd);
         b.resize(size);
 
         vector<int> c = ln(b);
-        for (int i = 0; i < size; i++)
-            c[i] = int((a[i] - c[i] + mod) % mod);
-        c[0]++;
+        vector<int> d(half);
+        for (int i = 0; i < half; i++)
+            d[i] = int((a[half + i] - c[half + i] + mod) % mod);
 
-        b = multiply(b, c);
+        b.resize(half);
+        auto t = multiplyTruncated(b, d, half);
         b.resize(size);
+        for (int i = 0; i < int(t.size()); i++)
+            b[half + i] = t[i];
 
         return b;
     }
@@ -458,78 +1245,340 @@ struct FastNTT {
             return{ 1 };
 
         auto poly = pow(p, n / 2, maxDegree);
-        poly = square(poly);
-        if (int(poly.size()) > maxDegree + 1)
-            poly.resize(maxDegree + 1);
-
-        if (n & 1) {
-            poly = multiply(poly, p);
-            if (int(poly.size()) > maxDegree + 1)
-                poly.resize(maxDegree + 1);
-        }
+        poly = multiplyTruncated(poly, poly, maxDegree + 1);
+        if (n & 1)
+            poly = multiplyTruncated(poly, p, maxDegree + 1);
 
         return poly;
     }
 
 
-    struct EvaluationTree {
-        int N;
-        vector<vector<int>> tree;
+    //--- subproduct tree ---
+    // Multipoint evaluation and interpolation in O(N*log^2(N)), without polynomial division.
+    //  - the node of points [L, R) keeps P(t) = PROD (1 - X[i] * t), L <= i < R.
+    //    Its constant term is always 1, so P[1..R-L] is kept at [L, R) and all nodes of a depth share one array of N.
+    //  - evaluation is the transposed algorithm (Tellegen's principle), with (q^T * P)[i] = SUM q[i + j] * P[j]
+    //      q_root  = (f^T * (1 / P_root))[0, N)
+    //      q_left  = (q^T * P_right)[0, sizeLeft),  q_right = (q^T * P_left)[0, sizeRight)
+    //      f(X[i]) = q_leaf[0]
+    //    q^T * P is a middle product of a cyclic convolution, the transform of q is shared by both children,
+    //    and q of children take the place of their parent's q, so one array of N is reused for all depths.
+    //  - interpolation : w_i = Y[i] / M'(X[i]) and R_node = R_left * M_right + R_right * M_left (R_leaf = w_i),
+    //    where M(x) = PROD (x - X[i]) is the reversed P. R is also computed in place in one array of N.
+    //
+    //   FastNTT<>::SubproductTree tree;
+    //   tree.build(X);
+    //   auto Y = tree.evaluate(f);         // Y[i] = f(X[i])
+    //   auto g = tree.interpolate(Y);      // g(X[i]) = Y[i], deg(g) < N, X[i] must be distinct
+    //
+    // PRECONDITION: 0 <= X[i] < mod
+    // Memory : N * (ceil(log2(N)) + 1) integers for the tree
+    struct SubproductTree {
+        // nodes of up to NAIVE_SIZE points are multiplied in O(size^2)
+        static const int NAIVE_SIZE = 32;
+
+        int N = 0;
+        vector<int> X;
+        vector<vector<int>> levels;     // levels[depth][L..R) = P[1..R-L] of the node [L, R)
 
-        // builds evaluation tree for (x - X[0])(x - X[1])...(x - X[n-1])
         void build(const vector<int>& X) {
+            this->X = X;
             N = int(X.size());
-            tree = vector<vector<int>>(4 * N);
-            if (N > 0)
-                dfsBuild(X, 1, 0, N - 1);
+
+            int depth = 1;
+            while ((1 << (depth - 1)) < N)
+                depth++;
+            levels.assign(depth, vector<int>(N));
+
+            if (N > 0) {
+                int size = ceilPow2(N);
+                init(size);
+                ws.reserve(size);
+                dfsBuild(0, 0, N);
+            }
         }
 
-        // multipoint evaluation
-        vector<int> evaluate(const vector<int>& poly, const vector<int>& X) {
+        // M(x) = (x - X[0])(x - X[1])...(x - X[N-1]), low order first
+        vector<int> product() const {
+            vector<int> res(N + 1);
+            res[N] = 1;
+            for (int i = 0; i < N; i++)
+                res[i] = levels[0][N - 1 - i];
+            return res;
+        }
+
+        // multipoint evaluation, returns { f(X[0]), f(X[1]), ..., f(X[N-1]) }
+        vector<int> evaluate(const vector<int>& f) {
+            int m = int(f.size());
+            if (N <= 0 || m <= 0)
+                return vector<int>(N, 0);
+
+            // q_root = (f^T * (1 / P_root))[0, N) = (f * reverse(1 / P_root))[m - 1, m + N - 1)
+            vector<int> invP(N + 1);
+            invP[0] = 1;
+            memcpy(invP.data() + 1, levels[0].data(), sizeof(int) * N);
+            invP = inverse(invP, m);
+            std::reverse(invP.begin(), invP.end());
+
+            vector<int> a(f);
+            a.resize(m + N - 1);
+            Q = middleProduct(a, invP, ws);
+
+            dfsEvaluate(0, 0, N);
+            return Q;
+        }
+
+        // returns g(x) of N coefficients, g(X[i]) = Y[i]
+        // PRECONDITION: X[i] are distinct
+        vector<int> interpolate(const vector<int>& Y) {
             if (N <= 0)
-                return vector<int>(X.size(), 0);
-            return dfsEvaluate(poly, X, 1, 0, N - 1);
+                return vector<int>();
+
+            // M'(x)
+            vector<int> dM(N);
+            for (int i = 1; i <= N; i++)
+                dM[i - 1] = (i == N) ? N % mod : int(1ll * i * levels[0][N - 1 - i] % mod);
+            auto W = evaluate(dM);
+
+            // Q[i] = Y[i] / M'(X[i]), with one modular inverse
+            vector<int> prefix(N);
+            long long prod = 1;
+            for (int i = 0; i < N; i++) {
+                prefix[i] = int(prod);
+                prod = prod * W[i] % mod;
+            }
+            long long inv = modInv(int(prod));
+            for (int i = N - 1; i >= 0; i--) {
+                Q[i] = int(inv * prefix[i] % mod * Y[i] % mod);
+                inv = inv * W[i] % mod;
+            }
+
+            dfsInterpolate(0, 0, N);
+            return Q;
         }
 
-        // interpolates minimum polynomial from (Xi, Yi) pairs
-        vector<int> interpolate(const vector<int>& X, const vector<int>& Y) {
-            return dfsInterpolate(derivate(tree[1]), X, Y, 1, 0, N - 1);
+        // releases memory
+        void clear() {
+            N = 0;
+            vector<int>().swap(X);
+            vector<vector<int>>().swap(levels);
+            vector<int>().swap(Q);
+            vector<unsigned>().swap(C);
+            ws.clear();
         }
 
     private:
-        // builds evaluation tree for (x - a1)(x - a2)...(x - an)
-        void dfsBuild(const vector<int>& X, int node, int L, int R) {
-            if (L == R)
-                tree[node] = vector<int>{ X[L] ? (mod - X[L]) : X[L], 1 };
-            else {
-                int mid = L + (R - L) / 2;
-                dfsBuild(X, 2 * node, L, mid);
-                dfsBuild(X, 2 * node + 1, mid + 1, R);
-                tree[node] = multiply(tree[2 * node], tree[2 * node + 1]);
+        static const unsigned long long MOD_SQ = 1ull * mod * mod;
+
+        vector<int> Q;                  // q or R of nodes
+        Workspace ws;
+        vector<unsigned> C;
+
+        static int ceilPow2(int n) {
+            int size = 1;
+            while (size < n)
+                size <<= 1;
+            return size;
+        }
+
+        // (sum + x * y) in [0, mod^2)
+        static unsigned long long mulAdd(unsigned long long sum, unsigned x, unsigned y) {
+            sum += 1ull * x * y;
+            return sum >= MOD_SQ ? sum - MOD_SQ : sum;
+        }
+
+        // dst[0..size) = the transform of M = { P[n-1], P[n-2], ..., P[0], 1 }
+        static void transformReversed(unsigned* dst, const int* P, int n, int size) {
+            for (int i = 0; i < n; i++)
+                dst[i] = unsigned(P[n - 1 - i]);
+            dst[n] = 1;
+            memset(dst + n + 1, 0, sizeof(int) * (size - n - 1));
+            transform(dst, size);
+        }
+
+        void dfsBuild(int depth, int L, int R) {
+            if (R - L == 1) {
+                levels[depth][L] = X[L] ? mod - X[L] : 0;
+                return;
+            }
+
+            int mid = (L + R) >> 1;
+            dfsBuild(depth + 1, L, mid);
+            dfsBuild(depth + 1, mid, R);
+
+            int n = R - L, nL = mid - L, nR = R - mid;
+            const int* PL = levels[depth + 1].data() + L;
+            const int* PR = levels[depth + 1].data() + mid;
+            int* out = levels[depth].data() + L;
+
+            if (n <= NAIVE_SIZE) {
+                // (1 + PL[0]t + ...)(1 + PR[0]t + ...)
+                for (int k = 1; k <= n; k++) {
+                    unsigned long long sum = 0;
+                    for (int i = max(0, k - nR); i <= min(k, nL); i++)
+                        sum = mulAdd(sum, i ? PL[i - 1] : 1, (k - i) ? PR[k - i - 1] : 1);
+                    out[k - 1] = int(sum % mod);
+                }
+                return;
             }
+
+            // the product has n + 1 terms, the term of t^n wraps around to the constant term 1 if size == n
+            int size = ceilPow2(n);
+            unsigned* A = ws.A.data();
+            unsigned* B = ws.B.data();
+            A[0] = B[0] = 1;
+            memcpy(A + 1, PL, sizeof(int) * nL);
+            memset(A + nL + 1, 0, sizeof(int) * (size - nL - 1));
+            memcpy(B + 1, PR, sizeof(int) * nR);
+            memset(B + nR + 1, 0, sizeof(int) * (size - nR - 1));
+
+            transform(A, size);
+            transform(B, size);
+            multiplyPointwise(A, B, size, pointwiseScale(size));
+            transformInv(A, size);
+            normalizeMont(A, size);
+
+            memcpy(out, A + 1, sizeof(int) * (n - 1));
+            out[n - 1] = (size == n) ? (A[0] ? int(A[0]) - 1 : mod - 1) : int(A[n]);
         }
 
-        vector<int> dfsEvaluate(const vector<int>& poly, const vector<int>& X, int node, int L, int R) {
-            if (R == L) {
-                return vector<int>{ FastNTT<mod, root, MaxBitSize>::evaluate(poly, X[L]) };
+        void dfsEvaluate(int depth, int L, int R) {
+            if (R - L == 1)
+                return;
+
+            int mid = (L + R) >> 1;
+            int n = R - L, nL = mid - L, nR = R - mid;
+            const int* PL = levels[depth + 1].data() + L;
+            const int* PR = levels[depth + 1].data() + mid;
+            int* q = Q.data() + L;
+
+            if (n <= NAIVE_SIZE) {
+                int qLR[NAIVE_SIZE];
+                for (int i = 0; i < nL; i++) {
+                    unsigned long long sum = unsigned(q[i]);
+                    for (int j = 1; j <= nR; j++)
+                        sum = mulAdd(sum, q[i + j], PR[j - 1]);
+                    qLR[i] = int(sum % mod);
+                }
+                for (int i = 0; i < nR; i++) {
+                    unsigned long long sum = unsigned(q[i]);
+                    for (int j = 1; j <= nL; j++)
+                        sum = mulAdd(sum, q[i + j], PL[j - 1]);
+                    qLR[nL + i] = int(sum % mod);
+                }
+                memcpy(q, qLR, sizeof(int) * n);
             } else {
-                int mid = L + (R - L) / 2;
-                auto A = dfsEvaluate(divmod(poly, tree[2 * node]).second, X, 2 * node, L, mid);
-                auto B = dfsEvaluate(divmod(poly, tree[2 * node + 1]).second, X, 2 * node + 1, mid + 1, R);
-                A.insert(end(A), begin(B), end(B));
-                return A;
+                // (q^T * P)[i] = (q * reverse(P))[deg(P) + i], wrapped terms land below deg(P)
+                int size = ceilPow2(n);
+                unsigned scale = pointwiseScale(size);
+                unsigned* A = ws.A.data();
+                unsigned* B = ws.B.data();
+
+                memcpy(A, q, sizeof(int) * n);
+                memset(A + n, 0, sizeof(int) * (size - n));
+                transform(A, size);
+
+                transformReversed(B, PR, nR, size);
+                multiplyPointwise(B, A, size, scale);
+                transformInv(B, size);
+                normalizeMont(B + nR, nL);
+                memcpy(q, B + nR, sizeof(int) * nL);
+
+                transformReversed(B, PL, nL, size);
+                multiplyPointwise(B, A, size, scale);
+                transformInv(B, size);
+                normalizeMont(B + nL, nR);
+                memcpy(q + nL, B + nL, sizeof(int) * nR);
             }
+
+            dfsEvaluate(depth + 1, L, mid);
+            dfsEvaluate(depth + 1, mid, R);
         }
 
-        vector<int> dfsInterpolate(const vector<int>& poly, const vector<int>& X, const vector<int>& Y, int node, int L, int R) {
-            if (R == L) {
-                return vector<int>{ int(1ll * Y[L] * modInv(poly[0]) % mod) };
-            } else {
-                int mid = L + (R - L) / 2;
-                auto A = dfsInterpolate(divmod(poly, tree[2 * node]).second, X, Y, 2 * node, L, mid);
-                auto B = dfsInterpolate(divmod(poly, tree[2 * node + 1]).second, X, Y, 2 * node + 1, mid + 1, R);
-                return copyAndAdd(multiply(A, tree[2 * node + 1]), multiply(B, tree[2 * node]));
+        void dfsInterpolate(int depth, int L, int R) {
+            if (R - L == 1)
+                return;
+
+            int mid = (L + R) >> 1;
+            dfsInterpolate(depth + 1, L, mid);
+            dfsInterpolate(depth + 1, mid, R);
+
+            int n = R - L, nL = mid - L, nR = R - mid;
+            const int* PL = levels[depth + 1].data() + L;
+            const int* PR = levels[depth + 1].data() + mid;
+            int* r = Q.data() + L;
+
+            if (n <= NAIVE_SIZE) {
+                // M[k] = P[deg(P) - k]
+                int res[NAIVE_SIZE];
+                for (int k = 0; k < n; k++) {
+                    unsigned long long sum = 0;
+                    for (int i = max(0, k - nR); i <= min(k, nL - 1); i++)
+                        sum = mulAdd(sum, r[i], (k - i == nR) ? 1 : PR[nR - 1 - (k - i)]);
+                    for (int i = max(0, k - nL); i <= min(k, nR - 1); i++)
+                        sum = mulAdd(sum, r[nL + i], (k - i == nL) ? 1 : PL[nL - 1 - (k - i)]);
+                    res[k] = int(sum % mod);
+                }
+                memcpy(r, res, sizeof(int) * n);
+                return;
             }
+
+            // deg(R_left * M_right) = deg(R_right * M_left) = n - 1, so there are no wrapped terms
+            int size = ceilPow2(n);
+            if (int(C.size()) < size)
+                C.resize(size);
+            unsigned* A = ws.A.data();
+            unsigned* B = ws.B.data();
+
+            memcpy(A, r, sizeof(int) * nL);
+            memset(A + nL, 0, sizeof(int) * (size - nL));
+            transform(A, size);
+            transformReversed(B, PR, nR, size);
+            multiplyPointwise(A, B, size);
+
+            memcpy(B, r + nL, sizeof(int) * nR);
+            memset(B + nR, 0, sizeof(int) * (size - nR));
+            transform(B, size);
+            transformReversed(C.data(), PL, nL, size);
+            multiplyPointwise(B, C.data(), size);
+
+            unsigned scale = pointwiseScale(size);
+            for (int i = 0; i < size; i++)
+                A[i] = montMul(reduce2(A[i] + B[i]), scale);
+            transformInv(A, size);
+            normalizeMont(A, n);
+            memcpy(r, A, sizeof(int) * n);
+        }
+    };
+
+    // (x - X[0])(x - X[1])...(x - X[n-1]), multipoint evaluation and interpolation with SubproductTree
+    struct EvaluationTree {
+        int N;
+        vector<vector<int>> tree;       // tree[1] = (x - X[0])(x - X[1])...(x - X[n-1])
+        SubproductTree subTree;
+
+        // builds evaluation tree for (x - X[0])(x - X[1])...(x - X[n-1])
+        void build(const vector<int>& X) {
+            N = int(X.size());
+            subTree.build(X);
+            tree.assign(2, vector<int>());
+            tree[1] = subTree.product();
+        }
+
+        // multipoint evaluation, X must be the points of build()
+        vector<int> evaluate(const vector<int>& poly, const vector<int>& X) {
+            assert(X == subTree.X);
+            if (N <= 0)
+                return vector<int>(X.size(), 0);
+            return subTree.evaluate(poly);
+        }
+
+        // interpolates minimum polynomial from (Xi, Yi) pairs, X must be the points of build()
+        vector<int> interpolate(const vector<int>& X, const vector<int>& Y) {
+            assert(X == subTree.X);
+            auto res = subTree.interpolate(Y);
+            normalize(res);
+            return res;
         }
     };
 
@@ -555,25 +1604,14 @@ struct FastNTT {
 };
 
 template <int mod, int root, int MaxBitSize>
-int FastNTT<mod, root, MaxBitSize>::w[FastNTT<mod, root, MaxBitSize>::MAXN];
+unsigned FastNTT<mod, root, MaxBitSize>::rt[FastNTT<mod, root, MaxBitSize>::MAXN / 2];
 
 template <int mod, int root, int MaxBitSize>
-int FastNTT<mod, root, MaxBitSize>::wInv[FastNTT<mod, root, MaxBitSize>::MAXN];
+unsigned FastNTT<mod, root, MaxBitSize>::irt[FastNTT<mod, root, MaxBitSize>::MAXN / 2];
 
 template <int mod, int root, int MaxBitSize>
-int FastNTT<mod, root, MaxBitSize>::nInv[MaxBitSize + 1];
+std::atomic<int> FastNTT<mod, root, MaxBitSize>::twiddleN(0);
 
 template <int mod, int root, int MaxBitSize>
-bool FastNTT<mod, root, MaxBitSize>::initiated = false;
+std::mutex FastNTT<mod, root, MaxBitSize>::twiddleMutex;
 
-template <int mod, int root, int MaxBitSize>
-int FastNTT<mod, root, MaxBitSize>::A[FastNTT<mod, root, MaxBitSize>::MAXN];
-
-template <int mod, int root, int MaxBitSize>
-int FastNTT<mod, root, MaxBitSize>::B[FastNTT<mod, root, MaxBitSize>::MAXN];
-
-template <int mod, int root, int MaxBitSize>
-int FastNTT<mod, root, MaxBitSize>::C[FastNTT<mod, root, MaxBitSize>::MAXN];
-
-template <int mod, int root, int MaxBitSize>
-int FastNTT<mod, root, MaxBitSize>::D[FastNTT<mod, root, MaxBitSize>::MAXN];
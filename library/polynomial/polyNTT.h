@@ -1,8 +1,9 @@
 #pragma once
 
 #include "ntt.h"
+#include "ntt_fast.h"
 
-// It's slower than PolyFFTMod
+// multiply() and multiplyFast() are slower than PolyFFTMod, multiplyParallel() runs on FastNTT and it's faster.
 template <int mod, int root>
 struct PolyNTT {
     static vector<int> multiplySlow(const vector<int>& left, const vector<int>& right) {
@@ -79,6 +80,22 @@ struct PolyNTT {
         return res;
     }
 
+    // multiplyFast() with 'threadN' threads, use it for large inputs (the result size >= 2^16)
+    //   convolutions of the three primes run on FastNTT's parallel transforms
+    static vector<int> multiplyParallel(const vector<int>& a, const vector<int>& b, int threadN) {
+        if (int(a.size() + b.size()) <= 256)
+            return multiplySlow(a, b);
+
+        const int m1 = 167772161;
+        const int m2 = 469762049;
+        const int m3 = 998244353;
+
+        auto x = multiplyParallelMod<m1>(a, b, threadN);
+        auto y = multiplyParallelMod<m2>(a, b, threadN);
+        auto z = multiplyParallelMod<m3>(a, b, threadN);
+
+        return garner3(x, y, z, threadN);
+    }
 
     static vector<int> multiply(const vector<int>& a, const vector<int>& b, bool reverseB) {
         if (!reverseB)
@@ -93,6 +110,80 @@ struct PolyNTT {
         return multiply(x, h, reverseH);
     }
 
+    //--- prepared operands ---
+    // The transforms of a fixed operand for the three primes are kept,
+    //   so each multiplication costs one forward and one inverse transform per prime. (see FastNTT::PreparedPoly)
+    struct PreparedPoly {
+        typename FastNTT<167772161, 3, 23>::PreparedPoly p1;
+        typename FastNTT<469762049, 3, 23>::PreparedPoly p2;
+        typename FastNTT<998244353, 3, 23>::PreparedPoly p3;
+
+        int maxOperandSize() const {
+            return p1.maxOperandSize();
+        }
+    };
+
+    // 'maxSizeB' is the max size of operands to multiply with 'a'
+    static PreparedPoly prepare(const vector<int>& a, int maxSizeB, bool reverseA = false, int threadN = 1) {
+        PreparedPoly res;
+        res.p1 = prepareMod<167772161>(a, maxSizeB, reverseA, threadN);
+        res.p2 = prepareMod<469762049>(a, maxSizeB, reverseA, threadN);
+        res.p3 = prepareMod<998244353>(a, maxSizeB, reverseA, threadN);
+        return res;
+    }
+
+    // PRECONDITION: b.size() <= a.maxOperandSize()
+    static vector<int> multiply(const PreparedPoly& a, const vector<int>& b, int threadN = 1) {
+        if (a.p1.sizeA == 0 || b.empty())
+            return vector<int>();
+
+        auto x = multiplyPreparedMod<167772161>(a.p1, b, threadN);
+        auto y = multiplyPreparedMod<469762049>(a.p2, b, threadN);
+        auto z = multiplyPreparedMod<998244353>(a.p3, b, threadN);
+
+        return garner3(x, y, z, threadN);
+    }
+
+    // 'h' must be prepared with reverseA = reverseH
+    static vector<int> convolute(const vector<int>& x, const PreparedPoly& h) {
+        return multiply(h, x);
+    }
+
+    //--- truncated products (see FastNTT::multiplyTruncated() and FastNTT::middleProduct())
+
+    // (a * b) mod x^k
+    static vector<int> multiplyTruncated(const vector<int>& a, const vector<int>& b, int k) {
+        int sizeA = min(int(a.size()), k);
+        int sizeB = min(int(b.size()), k);
+        if (sizeA <= 0 || sizeB <= 0)
+            return vector<int>();
+
+        int n = min(k, sizeA + sizeB - 1);
+        if (min(sizeA, sizeB) < 64) {
+            vector<int> res(n);
+            for (int i = 0; i < sizeA; i++) {
+                for (int j = 0; j < sizeB && i + j < n; j++)
+                    res[i + j] = int((res[i + j] + 1ll * a[i] * b[j]) % mod);
+            }
+            return res;
+        }
+
+        vector<int> ap(a.begin(), a.begin() + sizeA), bp(b.begin(), b.begin() + sizeB);
+        auto x = multiplyTruncatedMod<167772161>(ap, bp, n);
+        auto y = multiplyTruncatedMod<469762049>(ap, bp, n);
+        auto z = multiplyTruncatedMod<998244353>(ap, bp, n);
+        return garner3(x, y, z, 1);
+    }
+
+    // (a * b)[sizeB - 1, sizeA - 1]
+    // PRECONDITION: a.size() >= b.size() > 0
+    static vector<int> middleProduct(const vector<int>& a, const vector<int>& b) {
+        auto x = middleProductMod<167772161>(a, b);
+        auto y = middleProductMod<469762049>(a, b);
+        auto z = middleProductMod<998244353>(a, b);
+        return garner3(x, y, z, 1);
+    }
+
     //--- extended operations
 
     static vector<int> square(const vector<int>& a) {
@@ -101,16 +192,25 @@ struct PolyNTT {
 
 
     // low order first
+    //   g = 1/f (mod x^a) -> 1/f (mod x^2a)
+    //     h = (f * g)[a, 2a), it's a middle product
+    //     g[a, 2a) = -(g * h) mod x^a
     static vector<int> inverse(vector<int> a) {
         //assert(!a.empty());
         int n = int(a.size());
         vector<int> b = { modInv(a[0]) };
         while (int(b.size()) < n) {
-            vector<int> a_cut(a.begin(), a.begin() + min(a.size(), b.size() << 1));
-            vector<int> x = multiply(square(b), a_cut);
-            b.resize(b.size() << 1);
-            for (int i = int(b.size()) >> 1; i < int(min(x.size(), b.size())); i++)
-                b[i] = mod - x[i];
+            int half = int(b.size());
+
+            vector<int> f(2 * half);
+            copy(a.begin(), a.begin() + min(n, 2 * half), f.begin());
+            auto h = middleProduct(f, b);       // (f * b)[half - 1, 2 * half - 1]
+            h.erase(h.begin());
+
+            auto x = multiplyTruncated(b, h, half);
+            b.resize(2 * half);
+            for (int i = 0; i < int(x.size()); i++)
+                b[half + i] = x[i] ? mod - x[i] : 0;
         }
         b.resize(n);
         return b;
@@ -127,11 +227,16 @@ struct PolyNTT {
 
     // low order first
     static vector<int> integrate(const vector<int>& poly) {
-        vector<int> res;
-        res.reserve(poly.size() + 1);
-        res.push_back(0);
-        for (int i = 0; i < int(poly.size()); i++)
-            res.push_back(int(1ll * poly[i] * modInv(i + 1) % mod));
+        int n = int(poly.size());
+
+        // inverses of 1..n in O(n)
+        vector<int> inv(n + 1, 1);
+        for (int i = 2; i <= n; i++)
+            inv[i] = int((mod - 1ll * (mod / i) * inv[mod % i] % mod) % mod);
+
+        vector<int> res(n + 1);
+        for (int i = 0; i < n; i++)
+            res[i + 1] = int(1ll * poly[i] * inv[i + 1] % mod);
         return res;
     }
 
@@ -140,12 +245,14 @@ struct PolyNTT {
     static vector<int> ln(vector<int> a) {
         auto A = inverse(a);
         auto B = derivate(a);
-        A = multiply(A, B);
+        A = multiplyTruncated(A, B, int(a.size()));
         A.resize(a.size());
         return integrate(A);  
     }
 
     // low order first
+    //   b = exp(a) (mod x^(size/2)), exp(a) = b * (1 + a - ln(b)) (mod x^size)
+    //   a - ln(b) = 0 (mod x^(size/2)), so only the upper half is multiplied
     static vector<int> exp(vector<int> a) {
         int size = 1;
         while (size < int(a.size()))
@@ -156,18 +263,22 @@ struct PolyNTT {
 
         a.resize(size);
 
-        vector<int> dd(a.begin(), a.begin() + (size >> 1));
+        int half = size >> 1;
+        vector<int> dd(a.begin(), a.begin() + half);
 
         vector<int> b = exp(dd);
         b.resize(size);
 
         vector<int> c = ln(b);
-        for (int i = 0; i < size; i++)
-            c[i] = int((a[i] - c[i] + mod) % mod);
-        c[0]++;
+        vector<int> d(half);
+        for (int i = 0; i < half; i++)
+            d[i] = int((a[half + i] - c[half + i] + mod) % mod);
 
-        b = multiply(b, c);
+        b.resize(half);
+        auto t = multiplyTruncated(b, d, half);
         b.resize(size);
+        for (int i = 0; i < int(t.size()); i++)
+            b[half + i] = t[i];
 
         return b;
     }
@@ -185,20 +296,101 @@ struct PolyNTT {
             return{ 1 };
 
         auto poly = pow(p, n / 2, maxDegree);
-        poly = square(poly);
-        if (int(poly.size()) > maxDegree + 1)
-            poly.resize(maxDegree + 1);
-
-        if (n & 1) {
-            poly = multiply(poly, p);
-            if (int(poly.size()) > maxDegree + 1)
-                poly.resize(maxDegree + 1);
-        }
+        poly = multiplyTruncated(poly, poly, maxDegree + 1);
+        if (n & 1)
+            poly = multiplyTruncated(poly, p, maxDegree + 1);
 
         return poly;
     }
 
 //private:
+    // a * b (mod P), P is an NTT-friendly prime with primitive root 3 and MaxBitSize >= 23
+    template <int P>
+    static vector<int> multiplyParallelMod(const vector<int>& a, const vector<int>& b, int threadN) {
+        vector<int> ap(a.size()), bp(b.size());
+        for (int i = 0; i < int(a.size()); i++)
+            ap[i] = a[i] % P;
+        for (int i = 0; i < int(b.size()); i++)
+            bp[i] = b[i] % P;
+
+        auto res = FastNTT<P, 3, 23>::multiplyParallel(ap, bp, threadN);
+        res.resize(a.size() + b.size() - 1);
+        return res;
+    }
+
+    template <int P>
+    static typename FastNTT<P, 3, 23>::PreparedPoly prepareMod(const vector<int>& a, int maxSizeB, bool reverseA, int threadN) {
+        vector<int> ap(a.size());
+        for (int i = 0; i < int(a.size()); i++)
+            ap[i] = a[i] % P;
+        return FastNTT<P, 3, 23>::prepare(ap, maxSizeB, reverseA, threadN);
+    }
+
+    template <int P>
+    static vector<int> multiplyPreparedMod(const typename FastNTT<P, 3, 23>::PreparedPoly& a, const vector<int>& b,
+                                           int threadN) {
+        vector<int> bp(b.size());
+        for (int i = 0; i < int(b.size()); i++)
+            bp[i] = b[i] % P;
+
+        auto res = FastNTT<P, 3, 23>::multiply(a, bp, FastNTT<P, 3, 23>::defaultWorkspace(), threadN);
+        res.resize(a.sizeA + b.size() - 1);
+        return res;
+    }
+
+    // (a * b) mod x^k, in mod P
+    template <int P>
+    static vector<int> multiplyTruncatedMod(vector<int> a, vector<int> b, int k) {
+        for (auto& x : a)
+            x %= P;
+        for (auto& x : b)
+            x %= P;
+        return FastNTT<P, 3, 23>::multiplyTruncated(a, b, k);
+    }
+
+    template <int P>
+    static vector<int> middleProductMod(vector<int> a, vector<int> b) {
+        for (auto& x : a)
+            x %= P;
+        for (auto& x : b)
+            x %= P;
+        return FastNTT<P, 3, 23>::middleProduct(a, b);
+    }
+
+    // x, y, z : results of m1, m2, m3 -> the result of 'mod'
+    static vector<int> garner3(const vector<int>& x, const vector<int>& y, const vector<int>& z, int threadN) {
+        const int m1 = 167772161;
+        const int m2 = 469762049;
+        const int m3 = 998244353;
+
+        const int m1InvM2 = modInv(m1, m2);
+        const int m12InvM3 = modInv(1ll * m1 * m2 % m3, m3);
+        const int m12Mod = 1ll * m1 * m2 % mod;
+
+        int n = int(x.size());
+        vector<int> res(n);
+        FastNTT<m3, 3>::parallelFor(threadN, [&](int t) {
+            auto r = FastNTT<m3, 3>::splitRange(n, threadN, t, 1);
+            for (int i = r.first; i < r.second; i++) {
+                int v1 = int(1ll * (y[i] - x[i]) * m1InvM2 % m2);
+                if (v1 < 0)
+                    v1 += m2;
+
+                int v2 = int(1ll * (z[i] - (x[i] + 1ll * m1 * v1) % m3) * m12InvM3 % m3);
+                if (v2 < 0)
+                    v2 += m3;
+
+                int b3 = (x[i] + 1ll * m1 * v1 + 1ll * m12Mod * v2) % mod;
+                if (b3 < 0)
+                    b3 += mod;
+
+                res[i] = b3;
+            }
+        });
+
+        return res;
+    }
+
     static int garner(vector<pair<int, int>> p) {
         int n = int(p.size());
 
@@ -224,23 +416,23 @@ struct PolyNTT {
 
     //---
 
-    static int modPow(int x, int n, int mod) {
+    static int modPow(int x, int n, int m) {
         if (n == 0)
             return 1;
 
-        long long t = x % mod;
+        long long t = x % m;
         long long res = 1;
         for (; n > 0; n >>= 1) {
             if (n & 1)
-                res = res * t % mod;
-            t = t * t % mod;
+                res = res * t % m;
+            t = t * t % m;
         }
         return int(res);
     }
 
-    // mod is a prime number.
-    static int modInv(int a, int mod) {
-        return modPow(a, mod - 2, mod);
+    // m is a prime number.
+    static int modInv(int a, int m) {
+        return modPow(a, m - 2, m);
     }
 
 
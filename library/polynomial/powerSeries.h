@@ -1,6 +1,6 @@
 #pragma once
 
-#include "ntt.h"
+#include "ntt_fast.h"
 #include "polyFFTMod2.h"
 
 /*
@@ -112,7 +112,8 @@ struct PowerSeriesMod {
             }
         }
 
-        return NTT<mod, root>::exp(lnF);
+        // FastNTT::exp() multiplies only the upper half in each Newton step
+        return FastNTT<mod, root, 23>::exp(lnF);
     }
 
     vector<int> calculateAllCombinationWithFFT(const vector<pair<int, int>> poly, int N) {
@@ -0,0 +1,126 @@
+#include <vector>
+#include <algorithm>
+
+using namespace std;
+
+#include "subsetConvolution.h"
+
+/////////// For Testing ///////////////////////////////////////////////////////
+
+#include <time.h>
+#include <cassert>
+#include <string>
+#include <iostream>
+#include "../common/iostreamhelper.h"
+#include "../common/profile.h"
+#include "../common/rand.h"
+
+namespace {
+// the hand-rolled bit DP, O(3^n) with two nested submask loops
+vector<int> subsetConvolutionBitDP(const vector<int>& A, const vector<int>& B, int mod) {
+    int N = int(A.size());
+    vector<int> res(N);
+    for (int S = 0; S < N; S++) {
+        long long sum = 0;
+        for (int X = S; ; X = (X - 1) & S) {
+            sum = (sum + 1ll * A[X] * B[S ^ X]) % mod;
+            if (X == 0)
+                break;
+        }
+        res[S] = int(sum);
+    }
+    return res;
+}
+}
+
+void testSubsetConvolution() {
+    return; //TODO: if you want to test, make this line a comment.
+
+    cout << "--- Subset Convolution ------------------------------" << endl;
+    {
+        const int MOD = 998244353;
+        for (int n = 0; n <= 12; n++) {
+            int N = 1 << n;
+            vector<int> A(N), B(N);
+            for (int i = 0; i < N; i++) {
+                A[i] = RandInt32::get() % MOD;
+                B[i] = RandInt32::get() % MOD;
+            }
+
+            auto gt = subsetConvolutionBitDP(A, B, MOD);
+            assert((SubsetConvolution<int, MOD>::multiplyNaive(A, B) == gt));
+            assert((SubsetConvolution<int, MOD>::multiply(A, B) == gt));
+            assert((SubsetConvolution<int, MOD>::multiply(A, B, 3) == gt));
+            assert((SubsetConvolution<int, MOD>::multiply(A, A) == subsetConvolutionBitDP(A, A, MOD)));
+
+            vector<long long> AL(A.begin(), A.end()), BL(B.begin(), B.end());
+            auto ansL = SubsetConvolution<long long, MOD>::multiply(AL, BL);
+            assert(vector<int>(ansL.begin(), ansL.end()) == gt);
+        }
+    }
+    {
+        for (int n = 0; n <= 12; n++) {
+            int N = 1 << n;
+            vector<long long> A(N), B(N);
+            for (int i = 0; i < N; i++) {
+                A[i] = RandInt32::get() % 2001 - 1000;
+                B[i] = RandInt32::get() % 2001 - 1000;
+            }
+
+            auto gt = SubsetConvolution<long long>::multiplyNaive(A, B);
+            assert(SubsetConvolution<long long>::multiply(A, B) == gt);
+            assert(SubsetConvolution<long long>::multiply(A, B, 2) == gt);
+
+            // modulo 2^32
+            vector<unsigned> AU(N), BU(N);
+            for (int i = 0; i < N; i++) {
+                AU[i] = RandInt32::get();
+                BU[i] = RandInt32::get();
+            }
+            assert(SubsetConvolution<unsigned>::multiply(AU, BU) == SubsetConvolution<unsigned>::multiplyNaive(AU, BU));
+
+            auto P = A;
+            SubsetConvolution<long long>::zeta(P);
+            SubsetConvolution<long long>::mobius(P);
+            assert(P == A);
+        }
+        // padding
+        vector<long long> A{ 1, 2, 3 }, B{ 4, 5, 6, 7, 8 };
+        assert(SubsetConvolution<long long>::multiply(A, B) == SubsetConvolution<long long>::multiplyNaive(A, B));
+    }
+    cout << "OK!" << endl;
+
+    cout << "*** Speed test ***" << endl;
+    {
+        const int MOD = 998244353;
+        // n = 20 ~ 23 in the original measurement, it's reduced to run faster (n = 23 needs 1.6GB)
+        for (int n = 16; n <= 21; n++) {
+            int N = 1 << n;
+            vector<int> A(N), B(N);
+            for (int i = 0; i < N; i++) {
+                A[i] = RandInt32::get() % MOD;
+                B[i] = RandInt32::get() % MOD;
+            }
+            vector<unsigned> AU(A.begin(), A.end()), BU(B.begin(), B.end());
+
+            cout << "n = " << n << endl;
+            if (n <= 18) {
+                PROFILE_START(0);
+                auto gt = subsetConvolutionBitDP(A, B, MOD);
+                PROFILE_STOP(0);
+                assert((SubsetConvolution<int, MOD>::multiply(A, B) == gt));
+            }
+
+            PROFILE_START(1);
+            auto ans1 = SubsetConvolution<int, MOD>::multiply(A, B);
+            PROFILE_STOP(1);
+
+            PROFILE_START(2);
+            auto ans2 = SubsetConvolution<unsigned>::multiply(AU, BU);
+            PROFILE_STOP(2);
+
+            if (ans1.empty() || ans2.empty())
+                cout << "ERROR" << endl;
+        }
+    }
+}
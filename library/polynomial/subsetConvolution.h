@@ -0,0 +1,175 @@
+#pragma once
+
+#include <type_traits>
+
+#ifndef __GNUC__
+#include <intrin.h>
+#endif
+
+#include "walshHadamard.h"
+#include "walshHadamardMod.h"
+
+// Subset convolution
+//   C[S] = SUM A[X] * B[S \ X]
+//         X in S
+//
+//   ranked zeta transform (https://codeforces.com/blog/entry/72488)
+//     1) A_k[S] = A[S] if popcount(S) == k, otherwise 0, for k = 0..n
+//     2) zeta transforms (subset sums) of A_k and B_k
+//     3) C_k = SUM A_i * B_(k-i), pointwise on each S
+//                i
+//     4) Mobius transforms of C_k, and C[S] = C_popcount(S)[S]
+//   O(2^n * n^2)
+//
+//   - ranks are separate arrays of 2^n, so 2) and 4) are FWHT(Mod)::transformOr() (cache-blocked, SIMD, threads),
+//     and 3) runs on blocks of BLOCK masks, whose values of all ranks stay in cache
+//   - mod == 0 : exact arithmetic of T (or modulo 2^bits for unsigned T)
+//     mod > 0  : modulo 'mod' (mod < 2^31), PRECONDITION: 0 <= A[i], B[i] < mod
+//   - memory : 2 * (n + 1) * 2^n elements of T, about 1.6GB at n = 23 with 32-bit T
+template <typename T, int mod = 0>
+struct SubsetConvolution {
+    static const int BLOCK = 256;
+
+    typedef typename conditional<mod == 0, FWHT<T>, FWHTMod<T, (mod == 0 ? 1 : mod)>>::type TransformT;
+
+    // the size of A and B must be a power of 2 (2^n), or they are padded
+    // if A and B are the same object, A is squared with one less transform
+    static vector<T> multiply(const vector<T>& A, const vector<T>& B, int threadN = 1) {
+        int N = 1;
+        while (N < int(A.size()) || N < int(B.size()))
+            N <<= 1;
+
+        int n = 0;
+        while ((1 << n) < N)
+            n++;
+
+        vector<vector<T>> rankedA = rank(A, n, threadN);
+        if (&A == &B) {
+            product(rankedA, rankedA, n, threadN);
+        } else {
+            vector<vector<T>> rankedB = rank(B, n, threadN);
+            product(rankedA, rankedB, n, threadN);
+        }
+
+        for (int k = 0; k <= n; k++)
+            TransformT::transformOr(rankedA[k], true, threadN);
+
+        vector<T> res(N);
+        for (int S = 0; S < N; S++)
+            res[S] = rankedA[popcount(S)][S];
+        return res;
+    }
+
+    // subset sums, F[S] = SUM P[X]
+    //                    X in S
+    static void zeta(vector<T>& P, int threadN = 1) {
+        TransformT::transformOr(P, false, threadN);
+    }
+
+    // the inverse of zeta()
+    static void mobius(vector<T>& P, int threadN = 1) {
+        TransformT::transformOr(P, true, threadN);
+    }
+
+    // O(3^n)
+    static vector<T> multiplyNaive(const vector<T>& A, const vector<T>& B) {
+        int N = 1;
+        while (N < int(A.size()) || N < int(B.size()))
+            N <<= 1;
+
+        vector<T> res(N);
+        for (int S = 0; S < N; S++) {
+            T sum = 0;
+            for (int X = S; ; X = (X - 1) & S) {
+                T a = X < int(A.size()) ? A[X] : T(0);
+                T b = (S ^ X) < int(B.size()) ? B[S ^ X] : T(0);
+                sum = add(sum, mul(a, b));
+                if (X == 0)
+                    break;
+            }
+            res[S] = sum;
+        }
+        return res;
+    }
+
+private:
+    static int popcount(int x) {
+#ifndef __GNUC__
+        return int(__popcnt(x));
+#else
+        return __builtin_popcount(x);
+#endif
+    }
+
+    // zeta transforms of ranks 0..n
+    static vector<vector<T>> rank(const vector<T>& A, int n, int threadN) {
+        vector<vector<T>> res(n + 1, vector<T>(size_t(1) << n));
+        for (int S = 0; S < int(A.size()); S++)
+            res[popcount(S)][S] = A[S];
+
+        for (int k = 0; k <= n; k++)
+            TransformT::transformOr(res[k], false, threadN);
+        return res;
+    }
+
+    // A_k = SUM A_i * B_(k-i), it's in-place because A_k is written after the last use of A_i (i <= k)
+    //        i
+    static void product(vector<vector<T>>& A, const vector<vector<T>>& B, int n, int threadN) {
+        int blockN = ((1 << n) + BLOCK - 1) / BLOCK;
+        FWHTEngine::parallelFor(threadN, [&A, &B, n, blockN, threadN](int t) {
+            auto r = FWHTEngine::splitRange(blockN, threadN, t);
+            for (int i = r.first; i < r.second; i++)
+                productBlock(A, B, n, i * BLOCK, std::integral_constant<bool, mod == 0>());
+        });
+    }
+
+    static void productBlock(vector<vector<T>>& A, const vector<vector<T>>& B, int n, int first, std::true_type) {
+        int cnt = min(BLOCK, (1 << n) - first);
+        T acc[BLOCK];
+        for (int k = n; k >= 0; k--) {
+            fill(acc, acc + cnt, T(0));
+            for (int i = 0; i <= k; i++) {
+                const T* a = A[i].data() + first;
+                const T* b = B[k - i].data() + first;
+                for (int j = 0; j < cnt; j++)
+                    acc[j] += a[j] * b[j];
+            }
+            copy(acc, acc + cnt, A[k].data() + first);
+        }
+    }
+
+    // x * y < mod^2 < 2^62, so a sum of two terms doesn't overflow
+    static void productBlock(vector<vector<T>>& A, const vector<vector<T>>& B, int n, int first, std::false_type) {
+        const unsigned long long MOD_SQ = 1ull * mod * mod;
+
+        int cnt = min(BLOCK, (1 << n) - first);
+        unsigned long long acc[BLOCK];
+        for (int k = n; k >= 0; k--) {
+            fill(acc, acc + cnt, 0ull);
+            for (int i = 0; i <= k; i++) {
+                const T* a = A[i].data() + first;
+                const T* b = B[k - i].data() + first;
+                for (int j = 0; j < cnt; j++) {
+                    unsigned long long t = acc[j] + (unsigned long long)a[j] * (unsigned long long)b[j];
+                    acc[j] = t >= MOD_SQ ? t - MOD_SQ : t;
+                }
+            }
+            T* c = A[k].data() + first;
+            for (int j = 0; j < cnt; j++)
+                c[j] = T(acc[j] % mod);
+        }
+    }
+
+    static T add(T a, T b) {
+        if (mod == 0)
+            return a + b;
+        long long r = (long long)a + b;
+        return T(r >= mod ? r - mod : r);
+    }
+
+    static T mul(T a, T b) {
+        if (mod == 0)
+            return a * b;
+        return T((long long)a * b % (mod == 0 ? 1 : mod));
+    }
+};
@@ -153,6 +153,56 @@ static vector<T> slowAndMod(const vector<T>& A, const vector<T>& B) {
 }
 
 
+// the previous scalar transforms, O(N*logN) without blocking
+template <typename T>
+static void scalarTransformXorMod(vector<T>& P) {
+    int N = int(P.size());
+    for (int step = 1; step < N; step <<= 1) {
+        for (int i = 0; i < N; i += (step << 1)) {
+            for (int j = 0; j < step; j++) {
+                T u = P[i + j];
+                T v = P[i + step + j];
+                P[i + j] = (u + v >= MOD) ? u + v - MOD : u + v;
+                P[i + step + j] = (u - v < 0) ? u - v + MOD : u - v;
+            }
+        }
+    }
+}
+
+template <typename T>
+static vector<T> scalarXorMod(const vector<T>& A, const vector<T>& B) {
+    vector<T> tA(A), tB(B);
+    scalarTransformXorMod(tA);
+    scalarTransformXorMod(tB);
+
+    int N = int(A.size());
+    long long invN = 1;
+    for (long long b = MOD - 2, x = N; b > 0; b >>= 1, x = x * x % MOD) {
+        if (b & 1)
+            invN = invN * x % MOD;
+    }
+    for (int i = 0; i < N; i++)
+        tA[i] = T(1ll * tA[i] * tB[i] % MOD);
+    scalarTransformXorMod(tA);
+    for (int i = 0; i < N; i++)
+        tA[i] = T(tA[i] * invN % MOD);
+    return tA;
+}
+
+// subset sums and superset sums
+template <typename T>
+static vector<T> slowSubsetSum(const vector<T>& A, bool superset) {
+    int N = int(A.size());
+    vector<T> res(N);
+    for (int x = 0; x < N; x++) {
+        for (int y = 0; y < N; y++) {
+            if ((superset ? (x & y) == x : (x & y) == y))
+                res[x] += A[y];
+        }
+    }
+    return res;
+}
+
 //-----------------------------------------------------------------------------
 // https://www.codechef.com/problems/MDSWIN
 // -> https://discuss.codechef.com/t/mdswin-editorial/44120
@@ -255,6 +305,85 @@ void testWalshHadamard() {
             assert(ansAnd == gtAnd);
         }
     }
+    {
+        // in-place transforms
+        for (int N = 1; N <= 256; N <<= 1) {
+            vector<long long> A(N);
+            for (int i = 0; i < N; i++)
+                A[i] = RandInt32::get() % 10000;
+
+            auto P = A;
+            FWHT<long long>::transformOr(P, false);
+            assert(P == slowSubsetSum(A, false));
+            FWHT<long long>::transformOr(P, true);
+            assert(P == A);
+
+            FWHT<long long>::transformAnd(P, false);
+            assert(P == slowSubsetSum(A, true));
+            FWHT<long long>::transformAnd(P, true);
+            assert(P == A);
+
+            FWHT<long long>::transformXor(P, false);
+            FWHT<long long>::transformXor(P, true);
+            assert(P == A);
+        }
+    }
+    {
+        // blocked and fused stages (N > block), squaring, and threads
+        for (int logN : { 0, 1, 2, 3, 4, 10, 14, 15, 16, 17, 19 }) {
+            int N = 1 << logN;
+            vector<int> A(N), B(N);
+            for (int i = 0; i < N; i++) {
+                A[i] = RandInt32::get() % MOD;
+                B[i] = RandInt32::get() % MOD;
+            }
+
+            auto gt = scalarXorMod(A, B);
+            assert(FWHTMod<int>::fastXor(A, B) == gt);
+            assert(FWHTMod<int>::fastXor(A, B, 3) == gt);
+            assert(FWHTMod<int>::fastXor(A, A) == scalarXorMod(A, A));
+
+            vector<long long> AL(A.begin(), A.end()), BL(B.begin(), B.end());
+            auto ansL = FWHTMod<long long>::fastXor(AL, BL, 4);
+            assert(vector<int>(ansL.begin(), ansL.end()) == gt);
+
+            auto P = A;
+            FWHTMod<int>::transformOr(P, false, 2);
+            FWHTMod<int>::transformOr(P, true);
+            assert(P == A);
+            FWHTMod<int>::transformAnd(P, false);
+            FWHTMod<int>::transformAnd(P, true, 2);
+            assert(P == A);
+
+            if (logN <= 10) {
+                assert(FWHTMod<int>::fastOr(A, B, 2) == slowOrMod(A, B));
+                assert(FWHTMod<int>::fastAnd(A, B, 2) == slowAndMod(A, B));
+            }
+
+            vector<long long> X(N), Y(N);
+            for (int i = 0; i < N; i++) {
+                X[i] = RandInt32::get() % 100;
+                Y[i] = RandInt32::get() % 100;
+            }
+            auto ansOr = FWHT<long long>::fastOr(X, Y, 2);
+            auto ansAnd = FWHT<long long>::fastAnd(X, Y);
+            auto ansXor = FWHT<long long>::fastXor(X, Y, 3);
+            if (logN <= 10) {
+                assert(ansOr == slowOr(X, Y));
+                assert(ansAnd == slowAnd(X, Y));
+                assert(ansXor == slowXor(X, Y));
+            } else {
+                auto X2 = X;
+                FWHT<long long>::transformOr(X2, false, 2);
+                FWHT<long long>::transformOr(X2, true, 3);
+                assert(X2 == X);
+                vector<int> XI(X.begin(), X.end()), YI(Y.begin(), Y.end());
+                auto gtXor = scalarXorMod(XI, YI);
+                for (int i = 0; i < N; i++)
+                    assert(ansXor[i] % MOD == gtXor[i]);
+            }
+        }
+    }
     {
         auto ans1 = solveMDSWIN(vector<int>{1, 2}, 3);
         int gt1 = 6;
@@ -270,4 +399,31 @@ void testWalshHadamard() {
     }
 
     cout << "OK!" << endl;
+
+    cout << "*** Speed test ***" << endl;
+    {
+        // 2^24 in the original measurement, it's reduced to run faster
+        int N = 1 << 22;
+
+        vector<int> A(N), B(N);
+        for (int i = 0; i < N; i++) {
+            A[i] = RandInt32::get() % MOD;
+            B[i] = RandInt32::get() % MOD;
+        }
+
+        cout << "N = " << N << endl;
+        PROFILE_START(0);
+        auto gt = scalarXorMod(A, B);
+        PROFILE_STOP(0);
+
+        PROFILE_START(1);
+        auto ans1 = FWHTMod<int>::fastXor(A, B);
+        PROFILE_STOP(1);
+
+        PROFILE_START(2);
+        auto ans2 = FWHTMod<int>::fastXor(A, B, 4);
+        PROFILE_STOP(2);
+
+        assert(ans1 == gt && ans2 == gt);
+    }
 }
@@ -1,146 +1,335 @@
 #pragma once
 
+#include <thread>
+
 // Fast Walsh-Hadamard transform
 //  https://csacademy.com/blog/fast-fourier-transform-and-variations-of-it/
 //  https://en.wikipedia.org/wiki/Fast_Walsh%E2%80%93Hadamard_transform
 
+// Cache-blocked engine of Walsh-Hadamard-like transforms
+//   A transform applies a butterfly (u, v) -> (f(u, v), g(u, v)) to pairs (x, x | bit) for each bit of indexes.
+//   Butterflies on different bits commute, so the stages can run in any order.
+//     1) stages of step < block run in blocks of 'block' elements (about 64KB), which stay in cache
+//     2) stages of step >= block are fused by OUTER_FUSE stages, on chunks of CHUNK elements
+//   The convolution runs 2) forward, 1) forward + pointwise product + 1) inverse in each block, and 2) inverse,
+//   so it reads the arrays from memory 4 times instead of 2 * log2(N) times.
+//   With threadN > 1, blocks of 1) and chunks of 2) are split into threads.
+//
+//   ButterflyT must have
+//     static void apply(T& u, T& v);               // a butterfly
+//     static void apply(T* u, T* v, int n);        // butterflies of (u[i], v[i]), 0 <= i < n
+//   'mul' is a functor of
+//     void operator ()(T* a, const T* b, int n);   // a[i] = a[i] * b[i], 'a' and 'b' can be the same
+struct FWHTEngine {
+    static const int BLOCK_BYTES = 1 << 16;
+    static const int OUTER_FUSE = 3;
+    static const int CHUNK = 64;
+
+    // the size of P must be a power of 2
+    template <typename ButterflyT, typename T>
+    static void transform(T* P, int N, int threadN = 1) {
+        if (N < 8) {
+            transformSmall<ButterflyT>(P, N);
+            return;
+        }
+
+        int block = blockSize<T>(N);
+        parallelFor(threadN, [P, N, block, threadN](int t) {
+            auto r = splitRange(N / block, threadN, t);
+            for (int i = r.first; i < r.second; i++)
+                transformBlock<ButterflyT>(P + i * block, block);
+        });
+        transformOuter<ButterflyT>(P, N, block, threadN);
+    }
+
+    // A = inverse(forward(A) * forward(B)), B is destroyed
+    // - if A == B, A is squared
+    template <typename ForwardT, typename InverseT, typename T, typename MultiplyT>
+    static void convolute(T* A, T* B, int N, const MultiplyT& mul, int threadN = 1) {
+        if (N < 8) {
+            transformSmall<ForwardT>(A, N);
+            if (B != A)
+                transformSmall<ForwardT>(B, N);
+            mul(A, B, N);
+            transformSmall<InverseT>(A, N);
+            return;
+        }
+
+        int block = blockSize<T>(N);
+        transformOuter<ForwardT>(A, N, block, threadN);
+        if (B != A)
+            transformOuter<ForwardT>(B, N, block, threadN);
+
+        parallelFor(threadN, [A, B, N, block, &mul, threadN](int t) {
+            auto r = splitRange(N / block, threadN, t);
+            for (int i = r.first; i < r.second; i++) {
+                T* a = A + i * block;
+                T* b = B + i * block;
+                transformBlock<ForwardT>(a, block);
+                if (b != a)
+                    transformBlock<ForwardT>(b, block);
+                mul(a, b, block);
+                transformBlock<InverseT>(a, block);
+            }
+        });
+        transformOuter<InverseT>(A, N, block, threadN);
+    }
+
+    template <typename FuncT>
+    static void parallelFor(int threadN, const FuncT& f) {
+        vector<thread> threads;
+        threads.reserve(threadN - 1);
+        for (int t = 1; t < threadN; t++)
+            threads.emplace_back(f, t);
+        f(0);
+        for (auto& th : threads)
+            th.join();
+    }
+
+    // the t-th of 'parts' ranges of [0, n)
+    static pair<int, int> splitRange(int n, int parts, int t) {
+        int chunk = (n + parts - 1) / parts;
+        int first = min(n, t * chunk);
+        return{ first, min(n, first + chunk) };
+    }
+
+private:
+    // the largest power of 2 in [8, N], which fits in BLOCK_BYTES
+    template <typename T>
+    static int blockSize(int N) {
+        int block = 8;
+        while (block < N && block * 2 * int(sizeof(T)) <= BLOCK_BYTES)
+            block <<= 1;
+        return block;
+    }
+
+    template <typename ButterflyT, typename T>
+    static void transformSmall(T* P, int N) {
+        for (int step = 1; step < N; step <<= 1) {
+            for (int i = 0; i < N; i += (step << 1)) {
+                for (int j = 0; j < step; j++)
+                    ButterflyT::apply(P[i + j], P[i + step + j]);
+            }
+        }
+    }
+
+    // all stages of step < N, N >= 8
+    template <typename ButterflyT, typename T>
+    static void transformBlock(T* P, int N) {
+        // the first 3 stages in registers
+        for (int i = 0; i < N; i += 8) {
+            T* p = P + i;
+            ButterflyT::apply(p[0], p[1]); ButterflyT::apply(p[2], p[3]);
+            ButterflyT::apply(p[4], p[5]); ButterflyT::apply(p[6], p[7]);
+            ButterflyT::apply(p[0], p[2]); ButterflyT::apply(p[1], p[3]);
+            ButterflyT::apply(p[4], p[6]); ButterflyT::apply(p[5], p[7]);
+            ButterflyT::apply(p[0], p[4]); ButterflyT::apply(p[1], p[5]);
+            ButterflyT::apply(p[2], p[6]); ButterflyT::apply(p[3], p[7]);
+        }
+        for (int step = 8; step < N; step <<= 1) {
+            for (int i = 0; i < N; i += (step << 1))
+                ButterflyT::apply(P + i, P + i + step, step);
+        }
+    }
+
+    // stages of step >= first
+    template <typename ButterflyT, typename T>
+    static void transformOuter(T* P, int N, int first, int threadN) {
+        for (int step = first; step < N; ) {
+            int span = step << 1;
+            for (int f = 1; f < OUTER_FUSE && span < N; f++)
+                span <<= 1;
+
+            int chunk = min(CHUNK, step);
+            int chunkN = step / chunk;
+            int units = N / span * chunkN;
+            parallelFor(threadN, [P, step, span, chunk, chunkN, units, threadN](int t) {
+                auto r = splitRange(units, threadN, t);
+                for (int u = r.first; u < r.second; u++) {
+                    T* base = P + u / chunkN * span + u % chunkN * chunk;
+                    for (int s = step; s < span; s <<= 1) {
+                        for (int i = 0; i < span; i += (s << 1)) {
+                            for (int j = 0; j < s; j += step)
+                                ButterflyT::apply(base + i + j, base + i + j + s, chunk);
+                        }
+                    }
+                }
+            });
+            step = span;
+        }
+    }
+};
+
 // Fast Walsh-Hadamard transform
 
 template <typename T>
 struct FWHT {
     // C = SUM SUM A[i] * B[j] * x^(i xor j)
     //      i   j
-    static vector<T> fastXor(const vector<T>& A, const vector<T>& B) {
-        int size = 1;
-        while (size < int(A.size()) || size < int(B.size()))
-            size <<= 1;
+    // if A and B are the same object, A is squared with one less transform
+    static vector<T> fastXor(const vector<T>& A, const vector<T>& B, int threadN = 1) {
+        vector<T> tA, tB;
+        int size = prepare(A, B, tA, tB);
+        convoluteXor(tA.data(), &A == &B ? tA.data() : tB.data(), size, threadN);
+        return tA;
+    }
 
-        vector<T> tA(size);
-        vector<T> tB(size);
-        for (int i = 0; i < int(A.size()); i++)
-            tA[i] = A[i];
-        for (int i = 0; i < int(B.size()); i++)
-            tB[i] = B[i];
+    // C = SUM SUM A[i] * B[j] * x^(i or j)
+    //      i   j
+    static vector<T> fastOr(const vector<T>& A, const vector<T>& B, int threadN = 1) {
+        vector<T> tA, tB;
+        int size = prepare(A, B, tA, tB);
+        convoluteOr(tA.data(), &A == &B ? tA.data() : tB.data(), size, threadN);
+        return tA;
+    }
 
-        transformXor(tA, false);
-        transformXor(tB, false);
+    // C = SUM SUM A[i] * B[j] * x^(i and j)
+    //      i   j
+    static vector<T> fastAnd(const vector<T>& A, const vector<T>& B, int threadN = 1) {
+        vector<T> tA, tB;
+        int size = prepare(A, B, tA, tB);
+        convoluteAnd(tA.data(), &A == &B ? tA.data() : tB.data(), size, threadN);
+        return tA;
+    }
 
-        for (int i = 0; i < size; i++)
-            tA[i] *= tB[i];
+    //--- in-place operations, N must be a power of 2
 
-        transformXor(tA, true);
+    // A = A xor-convolution B, B is destroyed (A == B to square)
+    static void convoluteXor(T* A, T* B, int N, int threadN = 1) {
+        FWHTEngine::convolute<XorOp, XorOp>(A, B, N, MulOp(), threadN);
+        for (int i = 0; i < N; i++)
+            A[i] /= N;
+    }
 
-        return tA;
+    // A = A or-convolution B, B is destroyed (A == B to square)
+    static void convoluteOr(T* A, T* B, int N, int threadN = 1) {
+        FWHTEngine::convolute<OrOp, OrInvOp>(A, B, N, MulOp(), threadN);
     }
 
-    // C = SUM SUM A[i] * B[j] * x^(i or j)
-    //      i   j
-    static vector<T> fastOr(const vector<T>& A, const vector<T>& B) {
-        int size = 1;
-        while (size < int(A.size()) || size < int(B.size()))
-            size <<= 1;
+    // A = A and-convolution B, B is destroyed (A == B to square)
+    static void convoluteAnd(T* A, T* B, int N, int threadN = 1) {
+        FWHTEngine::convolute<AndOp, AndInvOp>(A, B, N, MulOp(), threadN);
+    }
 
-        vector<T> tA(size);
-        vector<T> tB(size);
-        for (int i = 0; i < int(A.size()); i++)
-            tA[i] = A[i];
-        for (int i = 0; i < int(B.size()); i++)
-            tB[i] = B[i];
+    // P'[x] = SUM (-1)^popcount(x & y) * P[y]
+    //          y
+    static void transformXor(T* P, int N, bool inverse, int threadN = 1) {
+        FWHTEngine::transform<XorOp>(P, N, threadN);
+        if (inverse) {
+            for (int i = 0; i < N; i++)
+                P[i] /= N;
+        }
+    }
 
-        transformOr(tA, false);
-        transformOr(tB, false);
+    // P'[x] = SUM P[y], subset sums (zeta transform) and its inverse (Mobius transform)
+    //        y in x
+    static void transformOr(T* P, int N, bool inverse, int threadN = 1) {
+        if (!inverse)
+            FWHTEngine::transform<OrOp>(P, N, threadN);
+        else
+            FWHTEngine::transform<OrInvOp>(P, N, threadN);
+    }
 
-        for (int i = 0; i < size; i++)
-            tA[i] *= tB[i];
+    // P'[x] = SUM P[y], superset sums and its inverse
+    //        x in y
+    static void transformAnd(T* P, int N, bool inverse, int threadN = 1) {
+        if (!inverse)
+            FWHTEngine::transform<AndOp>(P, N, threadN);
+        else
+            FWHTEngine::transform<AndInvOp>(P, N, threadN);
+    }
 
-        transformOr(tA, true);
+    // the size of P must be a power of 2
+    static void transformXor(vector<T>& P, bool inverse, int threadN = 1) {
+        transformXor(P.data(), int(P.size()), inverse, threadN);
+    }
 
-        return tA;
+    static void transformOr(vector<T>& P, bool inverse, int threadN = 1) {
+        transformOr(P.data(), int(P.size()), inverse, threadN);
     }
 
-    // C = SUM SUM A[i] * B[j] * x^(i and j)
-    //      i   j
-    static vector<T> fastAnd(const vector<T>& A, const vector<T>& B) {
+    static void transformAnd(vector<T>& P, bool inverse, int threadN = 1) {
+        transformAnd(P.data(), int(P.size()), inverse, threadN);
+    }
+
+private:
+    static int prepare(const vector<T>& A, const vector<T>& B, vector<T>& tA, vector<T>& tB) {
         int size = 1;
         while (size < int(A.size()) || size < int(B.size()))
             size <<= 1;
 
-        vector<T> tA(size);
-        vector<T> tB(size);
-        for (int i = 0; i < int(A.size()); i++)
-            tA[i] = A[i];
-        for (int i = 0; i < int(B.size()); i++)
-            tB[i] = B[i];
+        tA.assign(size, T());
+        copy(A.begin(), A.end(), tA.begin());
+        if (&A != &B) {
+            tB.assign(size, T());
+            copy(B.begin(), B.end(), tB.begin());
+        }
+        return size;
+    }
 
-        transformAnd(tA, false);
-        transformAnd(tB, false);
+    // plain loops, compilers vectorize them for arithmetic types
+    struct XorOp {
+        static void apply(T& u, T& v) {
+            T a = u + v;
+            T b = u - v;
+            u = a;
+            v = b;
+        }
 
-        for (int i = 0; i < size; i++)
-            tA[i] *= tB[i];
+        static void apply(T* u, T* v, int n) {
+            for (int i = 0; i < n; i++)
+                apply(u[i], v[i]);
+        }
+    };
 
-        transformAnd(tA, true);
+    struct OrOp {
+        static void apply(T& u, T& v) {
+            v += u;
+        }
 
-        return tA;
-    }
+        static void apply(T* u, T* v, int n) {
+            for (int i = 0; i < n; i++)
+                v[i] += u[i];
+        }
+    };
 
-private:
-    // the size of P must be a power of 2
-    static void transformXor(vector<T>& P, bool inverse) {
-        int N = int(P.size());
-        for (int step = 1; step < N; step <<= 1) {
-            for (int i = 0; i < N; i += (step << 1)) {
-                for (int j = 0; j < step; j++) {
-                    T u = P[i + j];
-                    T v = P[i + step + j];
-                    P[i + j] = u + v;
-                    P[i + step + j] = u - v;
-                }
-            }
+    struct OrInvOp {
+        static void apply(T& u, T& v) {
+            v -= u;
         }
 
-        if (inverse) {
-            for (int i = 0; i < int(P.size()); i++)
-                P[i] /= N;
+        static void apply(T* u, T* v, int n) {
+            for (int i = 0; i < n; i++)
+                v[i] -= u[i];
         }
-    }
+    };
 
-    // the size of P must be a power of 2
-    static void transformOr(vector<T>& P, bool inverse) {
-        int N = int(P.size());
-        for (int step = 1; step < N; step <<= 1) {
-            for (int i = 0; i < N; i += (step << 1)) {
-                for (int j = 0; j < step; j++) {
-                    T u = P[i + j];
-                    T v = P[i + step + j];
-                    if (!inverse) {
-                        P[i + j] = u + v;
-                        P[i + step + j] = u;
-                    } else {
-                        P[i + j] = v;
-                        P[i + step + j] = u - v;
-                    }
-                }
-            }
+    struct AndOp {
+        static void apply(T& u, T& v) {
+            u += v;
         }
-    }
 
-    // the size of P must be a power of 2
-    static void transformAnd(vector<T>& P, bool inverse) {
-        int N = int(P.size());
-        for (int step = 1; step < N; step <<= 1) {
-            for (int i = 0; i < N; i += (step << 1)) {
-                for (int j = 0; j < step; j++) {
-                    T u = P[i + j];
-                    T v = P[i + step + j];
-                    if (!inverse) {
-                        P[i + j] = v;
-                        P[i + step + j] = v + u;
-                    } else {
-                        P[i + j] = v - u;
-                        P[i + step + j] = u;
-                    }
-                }
-            }
+        static void apply(T* u, T* v, int n) {
+            for (int i = 0; i < n; i++)
+                u[i] += v[i];
         }
-    }
+    };
+
+    struct AndInvOp {
+        static void apply(T& u, T& v) {
+            u -= v;
+        }
+
+        static void apply(T* u, T* v, int n) {
+            for (int i = 0; i < n; i++)
+                u[i] -= v[i];
+        }
+    };
+
+    struct MulOp {
+        void operator ()(T* a, const T* b, int n) const {
+            for (int i = 0; i < n; i++)
+                a[i] *= b[i];
+        }
+    };
 };
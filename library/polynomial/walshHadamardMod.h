@@ -1,165 +1,242 @@
 #pragma once
 
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#include "walshHadamard.h"
+
 // Fast Walsh-Hadamard transform
 //  https://csacademy.com/blog/fast-fourier-transform-and-variations-of-it/
 //  https://en.wikipedia.org/wiki/Fast_Walsh%E2%80%93Hadamard_transform
 
-// Fast Walsh-Hadamard transform
+// Fast Walsh-Hadamard transform modulo 'mod'
+//   butterflies run on 8 lanes with AVX2 (-mavx2, -march=native, /arch:AVX2) when T is a 32-bit integer
 
 template <typename T, int mod = 1000000007>
 struct FWHTMod {
     // C = SUM SUM A[i] * B[j] * x^(i xor j)
     //      i   j
-    static vector<T> fastXor(const vector<T>& A, const vector<T>& B) {
-        int size = 1;
-        while (size < int(A.size()) || size < int(B.size()))
-            size <<= 1;
+    // if A and B are the same object, A is squared with one less transform
+    static vector<T> fastXor(const vector<T>& A, const vector<T>& B, int threadN = 1) {
+        vector<T> tA, tB;
+        int size = prepare(A, B, tA, tB);
+        convoluteXor(tA.data(), &A == &B ? tA.data() : tB.data(), size, threadN);
+        return tA;
+    }
 
-        vector<T> tA(size);
-        vector<T> tB(size);
-        for (int i = 0; i < int(A.size()); i++)
-            tA[i] = A[i];
-        for (int i = 0; i < int(B.size()); i++)
-            tB[i] = B[i];
+    // C = SUM SUM A[i] * B[j] * x^(i or j)
+    //      i   j
+    static vector<T> fastOr(const vector<T>& A, const vector<T>& B, int threadN = 1) {
+        vector<T> tA, tB;
+        int size = prepare(A, B, tA, tB);
+        convoluteOr(tA.data(), &A == &B ? tA.data() : tB.data(), size, threadN);
+        return tA;
+    }
 
-        transformXor(tA, false);
-        transformXor(tB, false);
+    // C = SUM SUM A[i] * B[j] * x^(i and j)
+    //      i   j
+    static vector<T> fastAnd(const vector<T>& A, const vector<T>& B, int threadN = 1) {
+        vector<T> tA, tB;
+        int size = prepare(A, B, tA, tB);
+        convoluteAnd(tA.data(), &A == &B ? tA.data() : tB.data(), size, threadN);
+        return tA;
+    }
 
-        for (int i = 0; i < size; i++)
-            tA[i] = T(1ll * tA[i] * tB[i] % mod);
+    //--- in-place operations, N must be a power of 2 and 0 <= P[i] < mod
 
-        transformXor(tA, true);
+    // A = A xor-convolution B, B is destroyed (A == B to square)
+    static void convoluteXor(T* A, T* B, int N, int threadN = 1) {
+        FWHTEngine::convolute<XorOp, XorOp>(A, B, N, MulOp{ modInv(T(N % mod)) }, threadN);
+    }
 
-        return tA;
+    // A = A or-convolution B, B is destroyed (A == B to square)
+    static void convoluteOr(T* A, T* B, int N, int threadN = 1) {
+        FWHTEngine::convolute<OrOp, OrInvOp>(A, B, N, MulOp{ 1 }, threadN);
     }
 
-    // C = SUM SUM A[i] * B[j] * x^(i or j)
-    //      i   j
-    static vector<T> fastOr(const vector<T>& A, const vector<T>& B) {
-        int size = 1;
-        while (size < int(A.size()) || size < int(B.size()))
-            size <<= 1;
+    // A = A and-convolution B, B is destroyed (A == B to square)
+    static void convoluteAnd(T* A, T* B, int N, int threadN = 1) {
+        FWHTEngine::convolute<AndOp, AndInvOp>(A, B, N, MulOp{ 1 }, threadN);
+    }
+
+    static void transformXor(T* P, int N, bool inverse, int threadN = 1) {
+        FWHTEngine::transform<XorOp>(P, N, threadN);
+        if (inverse) {
+            T invN = modInv(T(N % mod));
+            for (int i = 0; i < N; i++)
+                P[i] = T(1ll * P[i] * invN % mod);
+        }
+    }
 
-        vector<T> tA(size);
-        vector<T> tB(size);
-        for (int i = 0; i < int(A.size()); i++)
-            tA[i] = A[i];
-        for (int i = 0; i < int(B.size()); i++)
-            tB[i] = B[i];
+    // subset sums (zeta transform) and its inverse (Mobius transform)
+    static void transformOr(T* P, int N, bool inverse, int threadN = 1) {
+        if (!inverse)
+            FWHTEngine::transform<OrOp>(P, N, threadN);
+        else
+            FWHTEngine::transform<OrInvOp>(P, N, threadN);
+    }
 
-        transformOr(tA, false);
-        transformOr(tB, false);
+    // superset sums and its inverse
+    static void transformAnd(T* P, int N, bool inverse, int threadN = 1) {
+        if (!inverse)
+            FWHTEngine::transform<AndOp>(P, N, threadN);
+        else
+            FWHTEngine::transform<AndInvOp>(P, N, threadN);
+    }
 
-        for (int i = 0; i < size; i++)
-            tA[i] = T(1ll * tA[i] * tB[i] % mod);
+    // the size of P must be a power of 2
+    static void transformXor(vector<T>& P, bool inverse, int threadN = 1) {
+        transformXor(P.data(), int(P.size()), inverse, threadN);
+    }
 
-        transformOr(tA, true);
+    static void transformOr(vector<T>& P, bool inverse, int threadN = 1) {
+        transformOr(P.data(), int(P.size()), inverse, threadN);
+    }
 
-        return tA;
+    static void transformAnd(vector<T>& P, bool inverse, int threadN = 1) {
+        transformAnd(P.data(), int(P.size()), inverse, threadN);
     }
 
-    // C = SUM SUM A[i] * B[j] * x^(i and j)
-    //      i   j
-    static vector<T> fastAnd(const vector<T>& A, const vector<T>& B) {
+private:
+    static int prepare(const vector<T>& A, const vector<T>& B, vector<T>& tA, vector<T>& tB) {
         int size = 1;
         while (size < int(A.size()) || size < int(B.size()))
             size <<= 1;
 
-        vector<T> tA(size);
-        vector<T> tB(size);
-        for (int i = 0; i < int(A.size()); i++)
-            tA[i] = A[i];
-        for (int i = 0; i < int(B.size()); i++)
-            tB[i] = B[i];
+        tA.assign(size, T(0));
+        copy(A.begin(), A.end(), tA.begin());
+        if (&A != &B) {
+            tB.assign(size, T(0));
+            copy(B.begin(), B.end(), tB.begin());
+        }
+        return size;
+    }
 
-        transformAnd(tA, false);
-        transformAnd(tB, false);
+    static T addMod(T a, T b) {
+        T r = a + b;
+        return r >= mod ? r - mod : r;
+    }
 
-        for (int i = 0; i < size; i++)
-            tA[i] = T(1ll * tA[i] * tB[i] % mod);
+    static T subMod(T a, T b) {
+        T r = a - b;
+        return r < 0 ? r + mod : r;
+    }
 
-        transformAnd(tA, true);
+    // With AVX2 and 32-bit T, butterflies run on 8 lanes.
+    //   values are in [0, mod) and mod < 2^31, so a sum or a difference is reduced with one unsigned min
+#if defined(__AVX2__)
+    static __m256i addMod(__m256i a, __m256i b) {
+        __m256i r = _mm256_add_epi32(a, b);
+        return _mm256_min_epu32(r, _mm256_sub_epi32(r, _mm256_set1_epi32(mod)));
+    }
 
-        return tA;
+    static __m256i subMod(__m256i a, __m256i b) {
+        __m256i r = _mm256_sub_epi32(a, b);
+        return _mm256_min_epu32(r, _mm256_add_epi32(r, _mm256_set1_epi32(mod)));
     }
 
-private:
-    // the size of P must be a power of 2
-    static void transformXor(vector<T>& P, bool inverse) {
-        int N = int(P.size());
-        for (int step = 1; step < N; step <<= 1) {
-            for (int i = 0; i < N; i += (step << 1)) {
-                for (int j = 0; j < step; j++) {
-                    T u = P[i + j];
-                    T v = P[i + step + j];
-
-                    auto a = u + v;
-                    auto b = u - v;
-                    if (a >= mod)
-                        a -= mod;
-                    if (b < 0)
-                        b += mod;
-
-                    P[i + j] = a;
-                    P[i + step + j] = b;
-                }
-            }
+    // the number of leading elements processed with AVX2
+    template <typename OpT>
+    static int applySIMD(T* u, T* v, int n) {
+        if (sizeof(T) != 4)
+            return 0;
+
+        int i = 0;
+        for (; i + 8 <= n; i += 8) {
+            __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(u + i));
+            __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(v + i));
+            OpT::apply(a, b);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(u + i), a);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(v + i), b);
         }
+        return i;
+    }
+#else
+    template <typename OpT>
+    static int applySIMD(T*, T*, int) {
+        return 0;
+    }
+#endif
 
-        if (inverse) {
-            T invN = modInv(N);
-            for (int i = 0; i < int(P.size()); i++)
-                P[i] = T(1ll * P[i] * invN % mod);
-        }
+    template <typename OpT>
+    static void applyAll(T* u, T* v, int n) {
+        for (int i = applySIMD<OpT>(u, v, n); i < n; i++)
+            OpT::apply(u[i], v[i]);
     }
 
-    // the size of P must be a power of 2
-    static void transformOr(vector<T>& P, bool inverse) {
-        int N = int(P.size());
-        for (int step = 1; step < N; step <<= 1) {
-            for (int i = 0; i < N; i += (step << 1)) {
-                for (int j = 0; j < step; j++) {
-                    T u = P[i + j];
-                    T v = P[i + step + j];
-                    if (!inverse) {
-                        P[i + j] = u + v;
-                        if (P[i + j] >= mod)
-                            P[i + j] -= mod;
-                        P[i + step + j] = u;
-                    } else {
-                        P[i + j] = v;
-                        P[i + step + j] = u - v;
-                        if (P[i + step + j] < 0)
-                            P[i + step + j] += mod;
-                    }
-                }
-            }
+    struct XorOp {
+        template <typename U>
+        static void apply(U& u, U& v) {
+            U a = addMod(u, v);
+            U b = subMod(u, v);
+            u = a;
+            v = b;
         }
-    }
 
-    // the size of P must be a power of 2
-    static void transformAnd(vector<T>& P, bool inverse) {
-        int N = int(P.size());
-        for (int step = 1; step < N; step <<= 1) {
-            for (int i = 0; i < N; i += (step << 1)) {
-                for (int j = 0; j < step; j++) {
-                    T u = P[i + j];
-                    T v = P[i + step + j];
-                    if (!inverse) {
-                        P[i + j] = v;
-                        P[i + step + j] = v + u;
-                        if (P[i + step + j] >= mod)
-                            P[i + step + j] -= mod;
-                    } else {
-                        P[i + j] = v - u;
-                        if (P[i + j] < 0)
-                            P[i + j] += mod;
-                        P[i + step + j] = u;
-                    }
-                }
+        static void apply(T* u, T* v, int n) {
+            applyAll<XorOp>(u, v, n);
+        }
+    };
+
+    struct OrOp {
+        template <typename U>
+        static void apply(U& u, U& v) {
+            v = addMod(v, u);
+        }
+
+        static void apply(T* u, T* v, int n) {
+            applyAll<OrOp>(u, v, n);
+        }
+    };
+
+    struct OrInvOp {
+        template <typename U>
+        static void apply(U& u, U& v) {
+            v = subMod(v, u);
+        }
+
+        static void apply(T* u, T* v, int n) {
+            applyAll<OrInvOp>(u, v, n);
+        }
+    };
+
+    struct AndOp {
+        template <typename U>
+        static void apply(U& u, U& v) {
+            u = addMod(u, v);
+        }
+
+        static void apply(T* u, T* v, int n) {
+            applyAll<AndOp>(u, v, n);
+        }
+    };
+
+    struct AndInvOp {
+        template <typename U>
+        static void apply(U& u, U& v) {
+            u = subMod(u, v);
+        }
+
+        static void apply(T* u, T* v, int n) {
+            applyAll<AndInvOp>(u, v, n);
+        }
+    };
+
+    // a[i] = a[i] * b[i] * scale, the inverse of N of the XOR convolution is merged into 'scale'
+    struct MulOp {
+        T scale;
+
+        void operator ()(T* a, const T* b, int n) const {
+            if (scale == 1) {
+                for (int i = 0; i < n; i++)
+                    a[i] = T(1ll * a[i] * b[i] % mod);
+            } else {
+                for (int i = 0; i < n; i++)
+                    a[i] = T(1ll * a[i] * b[i] % mod * scale % mod);
             }
         }
-    }
+    };
 
     //---
 
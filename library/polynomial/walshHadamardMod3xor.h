@@ -127,8 +127,12 @@ struct FWHTMod3Xor {
         transform(tA, false);
         transform(tB, false);
 
-        for (int i = 0; i < size; i++)
+        // the inverse of size is merged into the pointwise product
+        T inv = invSize(size);
+        for (int i = 0; i < size; i++) {
             tA[i] *= tB[i];
+            tA[i] *= inv;
+        }
 
         transform(tA, true);
 
@@ -155,8 +159,11 @@ struct FWHTMod3Xor {
 
         transform(tA, false);
 
-        for (int i = 0; i < size; i++)
+        T inv = invSize(size);
+        for (int i = 0; i < size; i++) {
             tA[i] = tA[i] ^ k;
+            tA[i] *= inv;
+        }
 
         transform(tA, true);
 
@@ -168,37 +175,54 @@ struct FWHTMod3Xor {
     }
 
 private:
-    // the size of P must be a power of 3
+    // the size of P must be a power of 3, it's not scaled by 1/N
+    //   x * w = -q + (p - q) * w, x * w^2 = (q - p) - p * w, when x = p + q * w,
+    //   so a 3-point butterfly is 12 additions without multiplications
     static void transform(vector<NumW3Mod<T,mod>>& P, bool inverse) {
-        static NumW3Mod<T, mod> w(0, 1);
-        static NumW3Mod<T, mod> w2(mod - 1, mod - 1);
-
         int N = int(P.size());
         for (int len = 1; len < N; len *= 3) {
             int pitch = len * 3;
-            int len2 = len * 2;
             for (int i = 0; i < N; i += pitch) {
+                auto* a = &P[i];
+                auto* b = a + len;
+                auto* c = b + len;
                 for (int j = 0; j < len; j++) {
-                    auto a = P[i + j       ];
-                    auto b = P[i + j + len ];
-                    auto c = P[i + j + len2];
-                    P[i + j       ] = a + b      + c     ;
-                    P[i + j + len ] = a + b * w  + c * w2;
-                    P[i + j + len2] = a + b * w2 + c * w ;
-                    if (inverse)
-                        swap(P[i + j + len], P[i + j + len2]);
+                    long long ap = a[j].first, aq = a[j].second;
+                    long long bp = b[j].first, bq = b[j].second;
+                    long long cp = c[j].first, cq = c[j].second;
+
+                    // a + b + c, a + b*w + c*w^2, a + b*w^2 + c*w
+                    long long x0 = ap + bp + cp, y0 = aq + bq + cq;
+                    long long x1 = ap - bq + cq - cp, y1 = aq + bp - bq - cp;
+                    long long x2 = ap + bq - bp - cq, y2 = aq - bp + cp - cq;
+                    if (inverse) {
+                        swap(x1, x2);
+                        swap(y1, y2);
+                    }
+                    a[j] = NumW3Mod<T,mod>(reduce(x0), reduce(y0));
+                    b[j] = NumW3Mod<T,mod>(reduce(x1), reduce(y1));
+                    c[j] = NumW3Mod<T,mod>(reduce(x2), reduce(y2));
                 }
             }
         }
+    }
 
-        if (inverse) {
-            long long inv3 = (mod + 1) / 3;
-            long long inv = 1;
-            for (int i = 1; i < N; i *= 3)
-                inv = inv3 * inv % mod;
+    // -2 * mod < x < 3 * mod
+    static T reduce(long long x) {
+        if (x < 0)
+            x += 2ll * mod;
+        if (x >= mod)
+            x -= mod;
+        if (x >= mod)
+            x -= mod;
+        return T(x);
+    }
 
-            for (int i = 0; i < N; i++)
-                P[i] *= inv;
-        }
+    static T invSize(int N) {
+        long long inv3 = (mod + 1) / 3;
+        long long inv = 1;
+        for (int i = 1; i < N; i *= 3)
+            inv = inv3 * inv % mod;
+        return T(inv);
     }
 };
@@ -29,7 +29,7 @@ struct DisjointSparseTable {
     }
 
     DisjointSparseTable(DisjointSparseTable&& rhs)
-        : ReadN(rhs.RealN), N(rhs.N), value(std::move(rhs.value)), H(std::move(rhs.H)),
+        : RealN(rhs.RealN), N(rhs.N), value(std::move(rhs.value)), H(std::move(rhs.H)),
         mergeOp(std::move(rhs.mergeOp)), defaultValue(rhs.defaultValue) {
     }
 
@@ -24,6 +24,7 @@ using namespace std;
 #include "segmentTree.h"
 #include "segmentTreeLazy.h"
 #include "segmentTreeRMQ.h"
+#include "../memory/newTypeAllocator.h"
 
 static int sumSlow(vector<int>& v, int L, int R) {
     int res = 0;
@@ -100,6 +101,44 @@ void testDynamicSegmentTree() {
             treeEx.update(L, R, value);
         }
     }
+    {
+        int N = 1000;
+        int T = 1000;
+        vector<int> in(N);
+
+        // make*() return the tree by value, it must be movable without C++17 copy elision
+        auto sumOp = [](int a, int b) { return a + b; };
+        auto blockOp = [](int x, int n) { return x * n; };
+        auto tree = makeDynamicSegmentTreeLazy(0, N - 1, sumOp, blockOp, 0);
+        auto treeEx = makeDynamicSegmentTreeLazyEx(0, N - 1, sumOp, blockOp, 0);
+        for (int i = 0; i < T; i++) {
+            int L = RandInt32::get() % N;
+            int R = RandInt32::get() % N;
+            if (L > R)
+                swap(L, R);
+
+            int value = RandInt32::get() % 1000 + 1;
+            updateSlow(in, L, R, value);
+            tree.update(L, R, value);
+            treeEx.update(L, R, value);
+        }
+
+        auto moved = std::move(tree);
+        auto movedEx = std::move(treeEx);
+        for (int i = 0; i < T; i++) {
+            int L = RandInt32::get() % N;
+            int R = RandInt32::get() % N;
+            if (L > R)
+                swap(L, R);
+
+            int gt = sumSlow(in, L, R);
+            int ans = moved.query(L, R);
+            int ans2 = movedEx.query(L, R);
+            if (ans != gt || ans2 != gt)
+                cout << "Mismatched : " << ans << ", " << ans2 << ", " << gt << endl;
+            assert(ans == gt && ans2 == gt);
+        }
+    }
     cout << "OK!" << endl;
     {
         int N = 10000;
@@ -130,4 +169,48 @@ void testDynamicSegmentTree() {
         }
     }
     cout << "OK!" << endl;
+    cout << "-- Dynamic Segment Tree Node Allocator Performance Test -----" << endl;
+    {
+        int N = 1000000000;
+        int T = 1000000;
+#ifdef _DEBUG
+        T = 10000;
+#endif
+        vector<pair<int, int>> Q(T);
+        for (auto& it : Q) {
+            int L = RandInt32::get() % N;
+            int R = RandInt32::get() % N;
+            it = make_pair(min(L, R), max(L, R));
+        }
+
+        auto sumOp = [](int a, int b) { return a + b; };
+        auto blockOp = [](int x, int n) { return x * n; };
+
+        cout << "*** NewTypeAllocator" << endl;
+        PROFILE_START(0);
+        {
+            DynamicSegmentTreeLazy<int, decltype(sumOp), decltype(blockOp), NewTypeAllocator> tree(0, N - 1, sumOp, blockOp, 0);
+            int res = 0;
+            for (auto& it : Q) {
+                tree.update(it.first, it.second, 1);
+                res += tree.query(it.first, it.first);
+            }
+            cout << "nodes = " << tree.nodes.size() << ", result = " << res << endl;
+        }
+        PROFILE_STOP(0);
+
+        cout << "*** TypeAllocator" << endl;
+        PROFILE_START(1);
+        {
+            DynamicSegmentTreeLazy<int, decltype(sumOp), decltype(blockOp), TypeAllocator> tree(0, N - 1, sumOp, blockOp, 0);
+            int res = 0;
+            for (auto& it : Q) {
+                tree.update(it.first, it.second, 1);
+                res += tree.query(it.first, it.first);
+            }
+            cout << "nodes = " << tree.nodes.size() << ", result = " << res << endl;
+        }
+        PROFILE_STOP(1);
+    }
+    cout << "OK!" << endl;
 }
@@ -1,6 +1,11 @@
 #pragma once
 
-template <typename T, typename MergeOp = function<T(T, T)>, typename BlockOp = function<T(T, int)>>
+#include "../memory/fixedSizeAllocator.h"
+
+//  - AllocatorT : node allocator (TypeAllocator, SimpleTypeAllocator, NewTypeAllocator, ...)
+//      [CAUTION] the segment tree is move-only because it owns its nodes (see memory/fixedSizeAllocator.h)
+template <typename T, typename MergeOp = function<T(T, T)>, typename BlockOp = function<T(T, int)>,
+          template <typename> class AllocatorT = TypeAllocator>
 struct DynamicSegmentTreeLazyEx {
     enum LazyT {
         lzNone,
@@ -29,6 +34,7 @@ struct DynamicSegmentTreeLazyEx {
 
     Node*   root;
     vector<Node*> nodes;
+    AllocatorT<Node> allocator;
 
     int     rangeMin;
     int     rangeMax;
@@ -42,9 +48,32 @@ struct DynamicSegmentTreeLazyEx {
         root = createNode(defaultValue);
     }
 
+    DynamicSegmentTreeLazyEx(const DynamicSegmentTreeLazyEx&) = delete;
+    DynamicSegmentTreeLazyEx& operator =(const DynamicSegmentTreeLazyEx&) = delete;
+
+    DynamicSegmentTreeLazyEx(DynamicSegmentTreeLazyEx&&) = default;
+
+    DynamicSegmentTreeLazyEx& operator =(DynamicSegmentTreeLazyEx&& rhs) {
+        if (this != &rhs) {
+            clear();
+
+            root = rhs.root;
+            nodes = std::move(rhs.nodes);
+            allocator = std::move(rhs.allocator);
+            rangeMin = rhs.rangeMin;
+            rangeMax = rhs.rangeMax;
+            defaultValue = std::move(rhs.defaultValue);
+            mergeOp = std::move(rhs.mergeOp);
+            blockOp = std::move(rhs.blockOp);
+
+            rhs.root = nullptr;
+            rhs.nodes.clear();
+        }
+        return *this;
+    }
+
     ~DynamicSegmentTreeLazyEx() {
-        for (auto it : nodes)
-            delete it;
+        clear();
     }
 
     T update(int left, int right, T value) {
@@ -60,8 +89,15 @@ struct DynamicSegmentTreeLazyEx {
     }
 
 private:
+    void clear() {
+        for (auto it : nodes)
+            allocator.destroy(it);
+        nodes.clear();
+        root = nullptr;
+    }
+
     Node* createNode(T val) {
-        nodes.push_back(new Node());
+        nodes.push_back(allocator.construct());
         nodes.back()->init(val);
         return nodes.back();
     }
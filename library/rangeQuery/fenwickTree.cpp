@@ -1,6 +1,7 @@
 using namespace std;
 
 #include "fenwickTree.h"
+#include "fenwickTreeMod.h"
 
 /////////// For Testing ///////////////////////////////////////////////////////
 
@@ -13,6 +14,7 @@ using namespace std;
 #include <string>
 #include <iostream>
 #include "../common/iostreamhelper.h"
+#include "../common/profile.h"
 #include "../common/rand.h"
 
 static int sumSlow(vector<int>& v, int L, int R) {
@@ -32,6 +34,26 @@ static int lowerBoundSlow(vector<int>& v, int k) {
     return int(v.size());
 }
 
+// the average number of distinct 64-byte cache lines which add(pos) and sum(N - 1 - pos) touch,
+// over the first 'count' queries (there are no portable cache miss counters)
+template <typename T, typename LayoutT>
+static double cacheLinesPerQuery(const FenwickTree<T, LayoutT>& ft, const vector<pair<int, int>>& Q, int count = 100000) {
+    count = min(count, int(Q.size()));
+
+    long long total = 0;
+    vector<size_t> lines;
+    for (int q = 0; q < count; q++) {
+        lines.clear();
+        for (int i = Q[q].first + 1; i <= ft.N; i += i & -i)
+            lines.push_back(size_t(&ft.tree[ft.layout.index(i)]) / 64);
+        for (int i = ft.N - Q[q].first; i > 0; i &= i - 1)
+            lines.push_back(size_t(&ft.tree[ft.layout.index(i)]) / 64);
+        sort(lines.begin(), lines.end());
+        total += unique(lines.begin(), lines.end()) - lines.begin();
+    }
+    return double(total) / count;
+}
+
 void testFenwickTree() {
     return; //TODO: if you want to test, make this line a comment.
 
@@ -132,6 +154,127 @@ void testFenwickTree() {
             assert(ans == gt);
         }
     }
+    cout << "*** O(N) build test" << endl;
+    {
+        for (int N = 1; N <= 300; N++) {
+            vector<int> in(N);
+            FenwickTree<int> gt(N);
+            FenwickTreeMod<int, 1000> gtMod(N);
+            for (int i = 0; i < N; i++) {
+                in[i] = RandInt32::get() % 1000;
+                gt.add(i, in[i]);
+                gtMod.add(i, in[i]);
+            }
+
+            FenwickTree<int> ft(in);
+            assert(ft.tree == gt.tree);
+
+            FenwickTree<int, FenwickTreeBlockedLayout<2>> ftBlocked(in);
+            for (int i = 0; i < N; i++)
+                assert(ftBlocked.sum(i) == gt.sum(i));
+
+            int k = 0;
+            FenwickTree<int> ft2;
+            ft2.buildFromStream(N, [&in, &k]() { return in[k++]; });
+            assert(ft2.tree == gt.tree);
+
+            FenwickTreeMod<int, 1000> ftMod;
+            ftMod.build(in);
+            assert(ftMod.tree == gtMod.tree);
+        }
+    }
+    cout << "*** batch query test" << endl;
+    {
+        int N = 1000;
+        vector<int> in(N);
+
+        for (int i = 0; i < N; i++)
+            in[i] = RandInt32::get() % 1000;
+
+        FenwickTree<int> fenwick(in);
+
+        vector<pair<int, int>> qry;
+        for (int i = 0; i < N; i++) {
+            int L = RandInt32::get() % N;
+            int R = RandInt32::get() % N;
+            if (L > R)
+                swap(L, R);
+            qry.emplace_back(L, R);
+        }
+
+        for (int threadN = 1; threadN <= 4; threadN++) {
+            vector<int> ans;
+            fenwick.queryBatch(qry, ans, threadN, (threadN & 1) != 0);
+            for (int i = 0; i < N; i++)
+                assert(ans[i] == sumSlow(in, qry[i].first, qry[i].second));
+        }
+    }
+    cout << "*** blocked layout test" << endl;
+    {
+        int N = 1000;
+        vector<int> in(N);
+
+        for (int i = 0; i < N; i++)
+            in[i] = RandInt32::get() % 1000;
+
+        FenwickTree<int> fenwick(in);
+        FenwickTree<int, FenwickTreeBlockedLayout<3>> fenwickBlocked(in);
+
+        for (int i = 0; i < N; i++) {
+            int L = RandInt32::get() % N;
+            int R = RandInt32::get() % N;
+            if (L > R)
+                swap(L, R);
+
+            int x = RandInt32::get() % 1000;
+            fenwick.add(L, x);
+            fenwickBlocked.add(L, x);
+
+            assert(fenwick.sumRange(L, R) == fenwickBlocked.sumRange(L, R));
+            assert(fenwick.get(R) == fenwickBlocked.get(R));
+
+            int sum = fenwick.sum(R);
+            assert(fenwick.lowerBound(sum) == fenwickBlocked.lowerBound(sum));
+        }
+    }
+    cout << "*** layout performance test" << endl;
+    {
+#ifdef _DEBUG
+        int maxN = 1000000;
+#else
+        int maxN = 100000000;
+#endif
+        int T = 10000000;
+        for (int N = 1000000; N <= maxN; N *= 10) {
+            vector<pair<int, int>> Q(T);
+            for (auto& it : Q)
+                it = make_pair(RandInt32::get() % N, RandInt32::get() % 1000);
+
+            cout << "N = " << N << endl;
+            {
+                FenwickTree<long long> fenwick(N);
+                long long res = 0;
+                PROFILE_HI_START(0);
+                for (auto& it : Q) {
+                    fenwick.add(it.first, it.second);
+                    res += fenwick.sum(N - 1 - it.first);
+                }
+                PROFILE_HI_STOP(0);
+                cout << "  FenwickTreeLayout : " << res << ", cache lines per query = " << cacheLinesPerQuery(fenwick, Q) << endl;
+            }
+            {
+                FenwickTree<long long, FenwickTreeBlockedLayout<>> fenwick(N);
+                long long res = 0;
+                PROFILE_HI_START(1);
+                for (auto& it : Q) {
+                    fenwick.add(it.first, it.second);
+                    res += fenwick.sum(N - 1 - it.first);
+                }
+                PROFILE_HI_STOP(1);
+                cout << "  FenwickTreeBlockedLayout : " << res << ", cache lines per query = " << cacheLinesPerQuery(fenwick, Q) << endl;
+            }
+        }
+    }
 
     cout << "OK!" << endl;
 }
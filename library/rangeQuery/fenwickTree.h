@@ -1,7 +1,13 @@
 #pragma once
 
+#ifndef __GNUC__
+#include <intrin.h>
+#endif
+
 #include <vector>
 
+#include "rangeQueryBatch.h"
+
 //--------- Fenwick Tree (Binary Indexed Tree) --------------------------------
 
 /*
@@ -31,15 +37,106 @@
        Not working!!!
  */
 
+//--------- Fenwick Tree Layouts ----------------------------------------------
+
+// node i is stored at tree[i]
+struct FenwickTreeLayout {
+    // returns the size of the storage
+    int init(int n) {
+        return n + 1;
+    }
+
+    // called with the storage after init()
+    template <typename T>
+    void setBase(const T*) {
+    }
+
+    int index(int i) const {
+        return i;
+    }
+};
+
+// Cache-blocked layout, nodes are grouped by levels of BlockBits trailing zeros
+//  - node i (i > 0) is in the level k = ctz(i) / BlockBits, and it's stored at offset[k] + (i >> (k * BlockBits))
+//  - a query or an update changes the low BlockBits bits of (i >> (k * BlockBits)) before it moves to the next level,
+//    so the nodes which are visited in a level are in one block of 2^BlockBits entries
+//  - a query touches about log2(N) / BlockBits blocks instead of log2(N) - BlockBits entries far apart,
+//    and the upper levels are small enough to stay in cache
+//  - 2^BlockBits * sizeof(T) should be the size of a cache line, 3 for 64-bit values,
+//    and blocks are aligned to 2^BlockBits * sizeof(T) bytes in memory (see setBase())
+//  - index() is a few more instructions than FenwickTreeLayout, and storage is about N * 2^B / (2^B - 1)
+//  [CAUTION] a copy of the tree is correct, but its blocks may not be aligned
+template <int BlockBits = 3>
+struct FenwickTreeBlockedLayout {
+    static const int MAX_LEVEL = 30 / BlockBits + 1;
+
+    int offset[32];             // by ctz(i), the start of the level
+    int shift[32];              // by ctz(i), level * BlockBits
+
+    // returns the size of the storage
+    int init(int n) {
+        const int mask = (1 << BlockBits) - 1;
+
+        int levelOffset[MAX_LEVEL];
+        int size = 0;
+        for (int k = 0; k < MAX_LEVEL; k++) {
+            levelOffset[k] = size;
+            // levels start at multiples of 2^BlockBits, so blocks are aligned to the start of storage
+            size += ((n >> (k * BlockBits)) + 1 + mask) & ~mask;
+        }
+        size += mask;               // room for setBase()
+        for (int tz = 0; tz < 32; tz++) {
+            int k = min(tz / BlockBits, MAX_LEVEL - 1);
+            offset[tz] = levelOffset[k];
+            shift[tz] = k * BlockBits;
+        }
+        return size;
+    }
+
+    // moves all levels by up to 2^BlockBits - 1 entries, so that blocks start at aligned addresses
+    template <typename T>
+    void setBase(const T* data) {
+        const size_t blockBytes = sizeof(T) << BlockBits;
+        if (blockBytes & (blockBytes - 1))
+            return;
+
+        int base = int((blockBytes - reinterpret_cast<size_t>(data) % blockBytes) % blockBytes / sizeof(T));
+        for (int tz = 0; tz < 32; tz++)
+            offset[tz] += base;
+    }
+
+    // i > 0
+    int index(int i) const {
+        int tz = ctz(i);
+        return offset[tz] + (i >> shift[tz]);
+    }
+
+private:
+    static int ctz(int x) {
+#ifndef __GNUC__
+        unsigned long index;
+        _BitScanForward(&index, x);
+        return int(index);
+#else
+        return __builtin_ctz(x);
+#endif
+    }
+};
+
+//--------- Fenwick Tree ------------------------------------------------------
+
 // for sum from 0 to pos
-template <typename T>
+template <typename T, typename LayoutT = FenwickTreeLayout>
 struct FenwickTree {
+    int       N;
     vector<T> tree;
+    LayoutT   layout;
 
-    FenwickTree() {
+    FenwickTree() : N(0) {
     }
 
-    explicit FenwickTree(int n) : tree(n + 1) {
+    explicit FenwickTree(int n) {
+        init(n);
     }
 
     FenwickTree(const T value, int n) {
@@ -56,28 +153,42 @@ struct FenwickTree {
 
 
     void init(int n) {
-        tree = vector<T>(n + 1);
+        N = n;
+        tree = vector<T>(layout.init(n));
+        layout.setBase(tree.data());
     }
 
-    // O(NlogN)
+    // O(N)
     void build(T value, int n) {
         init(n);
-        for (int i = 0; i < n; i++)
-            add(i, value);
+        for (int i = 1; i <= n; i++)
+            tree[layout.index(i)] = value;
+        buildParents();
     }
 
-    // O(NlogN)
+    // O(N)
     void build(const T arr[], int n) {
         init(n);
-        for (int i = 0; i < n; i++)
-            add(i, arr[i]);
+        for (int i = 1; i <= n; i++)
+            tree[layout.index(i)] = arr[i - 1];
+        buildParents();
     }
 
-    // O(NlogN)
+    // O(N)
     void build(const vector<T>& v) {
         build(&v[0], int(v.size()));
     }
 
+    // build with n values from a reader without an intermediate array, O(N)
+    //   ex) ft.buildFromStream(n, FastIO::readSInt);
+    template <typename ReaderT>
+    void buildFromStream(int n, ReaderT reader) {
+        init(n);
+        for (int i = 1; i <= n; i++)
+            tree[layout.index(i)] = reader();
+        buildParents();
+    }
+
 
     // sum from 0 to pos
     // O(logN)
@@ -86,7 +197,7 @@ struct FenwickTree {
 
         T res = 0;
         while (pos > 0) {
-            res += tree[pos];
+            res += tree[layout.index(pos)];
             pos &= pos - 1;         // clear lowest bit
         }
 
@@ -101,12 +212,29 @@ struct FenwickTree {
         return res;
     }
 
+    // out[i] = sumRange(qry[i].first, qry[i].second), O(QlogN / threadN)
+    void queryBatch(const pair<int, int> qry[], int n, T out[], int threadN = 1, bool sortByLeft = false) const {
+        processQueryBatch(qry, n, out,
+            [this](int left, int right) { return sumRange(left, right); },
+            [this](int left, int right) {
+                if (left > 0)
+                    prefetchQueryData(&tree[layout.index(left)]);
+                prefetchQueryData(&tree[layout.index(right + 1)]);
+            },
+            threadN, sortByLeft);
+    }
+
+    void queryBatch(const vector<pair<int, int>>& qry, vector<T>& out, int threadN = 1, bool sortByLeft = false) const {
+        out.resize(qry.size());
+        queryBatch(qry.data(), int(qry.size()), out.data(), threadN, sortByLeft);
+    }
+
     // O(logN)
     void add(int pos, T val) {
         pos++;
 
-        while (pos < int(tree.size())) {
-            tree[pos] += val;
+        while (pos <= N) {
+            tree[layout.index(pos)] += val;
             pos += pos & -pos;      // add lowest bit
         }
     }
@@ -115,17 +243,17 @@ struct FenwickTree {
     // [CAUTION] This is not a general range update.
     void addRange(int left, int right, T val) {
         add(left, val);
-        if (right + 1 < int(tree.size()) - 1)
+        if (right + 1 < N)
             add(right + 1, -val);
     }
 
     // O(logN)
     T get(int pos) const {
-        T res = tree[pos + 1];
+        T res = tree[layout.index(pos + 1)];
         if (pos > 0) {
             int lca = pos & (pos + 1);
             for (; pos != lca; pos &= pos - 1)
-                res -= tree[pos];
+                res -= tree[layout.index(pos)];
         }
 
         return res;
@@ -144,8 +272,6 @@ struct FenwickTree {
     int lowerBound(T sum) {
         --sum;
 
-        int N = int(tree.size()) - 1;
-
         int blockSize = N;
         while (blockSize & (blockSize - 1))
             blockSize &= blockSize - 1;
@@ -153,22 +279,32 @@ struct FenwickTree {
         int lo = 0;
         for (; blockSize > 0; blockSize >>= 1) {
             int next = lo + blockSize;
-            if (next <= N && sum >= tree[next]) {
-                sum -= tree[next];
+            if (next <= N && sum >= tree[layout.index(next)]) {
+                sum -= tree[layout.index(next)];
                 lo = next;
             }
         }
 
         return lo;
     }
+
+private:
+    // tree[i] has A[i - 1] before calling, O(N)
+    void buildParents() {
+        for (int i = 1; i <= N; i++) {
+            int j = i + (i & -i);
+            if (j <= N)
+                tree[layout.index(j)] += tree[layout.index(i)];
+        }
+    }
 };
 
 
 // PRECONDITION: tree's values are monotonically increasing (ex: positive values)
 // returns min(i | sum[left, i] >= sum)
 // O((logN)^2)
-template <typename T>
-inline int findFirst(const FenwickTree<T>& ft, int left, int right, T sum) {
+template <typename T, typename LayoutT>
+inline int findFirst(const FenwickTree<T, LayoutT>& ft, int left, int right, T sum) {
     int lo = left, hi = right;
 
     while (lo <= hi) {
@@ -185,8 +321,8 @@ inline int findFirst(const FenwickTree<T>& ft, int left, int right, T sum) {
 // PRECONDITION: tree's values are monotonically increasing (ex: positive values)
 // returns min(i | sum[i, right] < sum)
 // O((logN)^2)
-template <typename T>
-inline int findLast(const FenwickTree<T>& ft, int left, int right, T sum) {
+template <typename T, typename LayoutT>
+inline int findLast(const FenwickTree<T, LayoutT>& ft, int left, int right, T sum) {
     int lo = left, hi = right;
 
     while (lo <= hi) {
@@ -14,6 +14,7 @@ using namespace std;
 #include <string>
 #include <iostream>
 #include "../common/iostreamhelper.h"
+#include "../common/rand.h"
 
 void testFenwickTree2D() {
     return; //TODO: if you want to test, make this line a comment.
@@ -71,5 +72,29 @@ void testFenwickTree2D() {
     cout << "fenwick.sumRange(3, 3, 3, 3) = " << ans << endl;
     assert(ans == 9);
 
+    cout << "*** O(NM) build" << endl;
+    {
+        int R = 37, C = 53;
+        vector<vector<int>> in(R, vector<int>(C));
+        for (int i = 0; i < R; i++) {
+            for (int j = 0; j < C; j++)
+                in[i][j] = RandInt32::get() % 1000;
+        }
+
+        FenwickTree2D<int> gt(R, C);
+        for (int i = R - 1; i >= 0; i--) {
+            for (int j = C - 1; j >= 0; j--)
+                gt.initReverse(i, j, in[i][j]);
+        }
+
+        FenwickTree2D<int> ft(in);
+        assert(ft.tree == gt.tree);
+
+        int k = 0;
+        FenwickTree2D<int> ft2;
+        ft2.buildFromStream(R, C, [&in, &k, C]() { int v = in[k / C][k % C]; k++; return v; });
+        assert(ft2.tree == gt.tree);
+    }
+
     cout << "OK!" << endl;
 }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <vector>
+#include <algorithm>
 
 //--------- Fenwick Tree 2D ---------------------------------------------------
 
@@ -8,9 +9,38 @@ template <typename T>
 struct FenwickTree2D {
     vector<vector<T>> tree;
 
+    FenwickTree2D() {
+    }
+
     FenwickTree2D(int rowN, int colN) : tree(rowN + 1, vector<T>(colN + 1)) {
     }
 
+    explicit FenwickTree2D(const vector<vector<T>>& v) {
+        build(v);
+    }
+
+    // O(NM)
+    void build(const vector<vector<T>>& v) {
+        int rowN = int(v.size());
+        int colN = rowN > 0 ? int(v[0].size()) : 0;
+        tree.assign(rowN + 1, vector<T>(colN + 1));
+        for (int r = 1; r <= rowN; r++)
+            copy(v[r - 1].begin(), v[r - 1].end(), tree[r].begin() + 1);
+        buildParents();
+    }
+
+    // build with rowN * colN values (row-major) from a reader without an intermediate array, O(NM)
+    //   ex) ft.buildFromStream(N, M, FastIO::readSInt);
+    template <typename ReaderT>
+    void buildFromStream(int rowN, int colN, ReaderT reader) {
+        tree.assign(rowN + 1, vector<T>(colN + 1));
+        for (int r = 1; r <= rowN; r++) {
+            for (int c = 1; c <= colN; c++)
+                tree[r][c] = reader();
+        }
+        buildParents();
+    }
+
     //--- for initialization
 
     // to initialize from (0, 0)
@@ -76,4 +106,32 @@ struct FenwickTree2D {
     void set(int row, int col, T val) {
         add(row, col, val - get(row, col));
     }
+
+private:
+    // tree[r][c] has A[r - 1][c - 1] before calling, O(NM)
+    void buildParents() {
+        int rowN = int(tree.size()) - 1;
+        int colN = int(tree[0].size()) - 1;
+
+        // columns in each row
+        for (int r = 1; r <= rowN; r++) {
+            auto& row = tree[r];
+            for (int c = 1; c <= colN; c++) {
+                int next = c + (c & -c);
+                if (next <= colN)
+                    row[next] += row[c];
+            }
+        }
+
+        // rows
+        for (int r = 1; r <= rowN; r++) {
+            int next = r + (r & -r);
+            if (next <= rowN) {
+                auto& dst = tree[next];
+                const auto& src = tree[r];
+                for (int c = 1; c <= colN; c++)
+                    dst[c] += src[c];
+            }
+        }
+    }
 };
@@ -16,6 +16,32 @@ struct FenwickTreeMod {
         tree = vector<T>(n + 1);
     }
 
+    // PRECONDITION: 0 <= arr[i] < mod
+    // O(N)
+    void build(const T arr[], int n) {
+        init(n);
+        for (int i = 1; i <= n; i++)
+            tree[i] = arr[i - 1];
+        buildParents();
+    }
+
+    // PRECONDITION: 0 <= v[i] < mod
+    // O(N)
+    void build(const vector<T>& v) {
+        build(&v[0], int(v.size()));
+    }
+
+    // build with n values from a reader without an intermediate array, O(N)
+    //   ex) ft.buildFromStream(n, FastIO::readInt);
+    // PRECONDITION: 0 <= reader() < mod
+    template <typename ReaderT>
+    void buildFromStream(int n, ReaderT reader) {
+        init(n);
+        for (int i = 1; i <= n; i++)
+            tree[i] = reader();
+        buildParents();
+    }
+
 
     // sum from 0 to pos
     // O(logN)
@@ -55,4 +81,18 @@ struct FenwickTreeMod {
             pos += pos & -pos;      // add lowest bit
         }
     }
+
+private:
+    // tree[i] has A[i - 1] before calling, O(N)
+    void buildParents() {
+        int n = int(tree.size()) - 1;
+        for (int i = 1; i <= n; i++) {
+            int j = i + (i & -i);
+            if (j <= n) {
+                tree[j] += tree[i];
+                if (tree[j] >= mod)
+                    tree[j] -= mod;
+            }
+        }
+    }
 };
@@ -52,6 +52,25 @@ void testFenwickTreeXor() {
             assert(xorTree.get(R) == in[R]);
         }
     }
+    cout << "*** O(N) build" << endl;
+    {
+        for (int N = 1; N <= 300; N++) {
+            vector<int> in(N);
+            FenwickTreeXor<int> gt(N);
+            for (int i = 0; i < N; i++) {
+                in[i] = RandInt32::get() % 65536;
+                gt.add(i, in[i]);
+            }
+
+            FenwickTreeXor<int> ft(in);
+            assert(ft.tree == gt.tree);
+
+            int k = 0;
+            FenwickTreeXor<int> ft2;
+            ft2.buildFromStream(N, [&in, &k]() { return in[k++]; });
+            assert(ft2.tree == gt.tree);
+        }
+    }
 
     cout << "OK!" << endl;
 }
@@ -32,22 +32,37 @@ struct FenwickTreeXor {
         tree = vector<T>(n + 1);
     }
 
+    // O(N)
     void build(T value, int n) {
         init(n);
-        for (int i = 0; i < n; i++)
-            add(i, value);
+        for (int i = 1; i <= n; i++)
+            tree[i] = value;
+        buildParents();
     }
 
+    // O(N)
     void build(const T arr[], int n) {
         init(n);
-        for (int i = 0; i < n; i++)
-            add(i, arr[i]);
+        for (int i = 1; i <= n; i++)
+            tree[i] = arr[i - 1];
+        buildParents();
     }
 
+    // O(N)
     void build(const vector<T>& v) {
         build(&v[0], int(v.size()));
     }
 
+    // build with n values from a reader without an intermediate array, O(N)
+    //   ex) ft.buildFromStream(n, FastIO::readInt);
+    template <typename ReaderT>
+    void buildFromStream(int n, ReaderT reader) {
+        init(n);
+        for (int i = 1; i <= n; i++)
+            tree[i] = reader();
+        buildParents();
+    }
+
 
     void add(int pos, T val) {
         pos++;
@@ -94,4 +109,15 @@ struct FenwickTreeXor {
     void set(int pos, T val) {
         add(pos, val ^ get(pos));
     }
+
+private:
+    // tree[i] has A[i - 1] before calling, O(N)
+    void buildParents() {
+        int n = int(tree.size()) - 1;
+        for (int i = 1; i <= n; i++) {
+            int j = i + (i & -i);
+            if (j <= n)
+                tree[j] ^= tree[i];
+        }
+    }
 };
@@ -18,6 +18,7 @@ int main(void) {
     TEST(PersistentFenwickTree);
     TEST(PersistentFenwickTreeMultAdd);
     TEST(SegmentTree);
+    TEST(SegmentTreeFast);
     TEST(SegmentTreePersistent);
     TEST(SegmentTreePartiallyPersistent);
     TEST(SegmentTreePersistentSimple);
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <vector>
+#include <tuple>
+
+//--------- Garbage Collection of Persistent Nodes ----------------------------
+
+// Nodes of persistent structures are stored in vectors and linked with 32-bit indexes (-1 is null).
+// Old versions can be dropped by compacting the nodes reachable from the retained roots.
+//  - the relative order of nodes is kept, so children are still placed before their parents
+//  - it's O(#nodes) time and O(#nodes) extra memory
+
+// returns new indexes of nodes, -1 if a node is unreachable from 'roots'
+//  left(i), right(i) : child indexes of node i
+template <typename LeftF, typename RightF>
+inline vector<int> makePersistentNodeMap(int nodeN, const vector<int>& roots, const LeftF& left, const RightF& right,
+                                         int* liveCount = nullptr) {
+    vector<int> newIndex(nodeN, -1);
+
+    vector<int> st;
+    for (int r : roots) {
+        if (r >= 0 && newIndex[r] < 0) {
+            newIndex[r] = 0;
+            st.push_back(r);
+        }
+    }
+    while (!st.empty()) {
+        int u = st.back();
+        st.pop_back();
+
+        int v = left(u);
+        if (v >= 0 && newIndex[v] < 0) {
+            newIndex[v] = 0;
+            st.push_back(v);
+        }
+        v = right(u);
+        if (v >= 0 && newIndex[v] < 0) {
+            newIndex[v] = 0;
+            st.push_back(v);
+        }
+    }
+
+    int n = 0;
+    for (int i = 0; i < nodeN; i++) {
+        if (newIndex[i] >= 0)
+            newIndex[i] = n++;
+    }
+    if (liveCount)
+        *liveCount = n;
+
+    return newIndex;
+}
+
+// Removes nodes unreachable from 'roots', and updates child indexes and 'roots'.
+// returns the number of removed nodes
+//  children(node) : std::tie(node.left, node.right)
+template <typename NodeT, typename ChildrenF>
+inline int compactPersistentNodes(vector<NodeT>& nodes, vector<int>& roots, const ChildrenF& children, bool shrink = false) {
+    int nodeN = int(nodes.size());
+    int liveN = 0;
+    auto newIndex = makePersistentNodeMap(nodeN, roots,
+        [&nodes, &children](int u) { return std::get<0>(children(nodes[u])); },
+        [&nodes, &children](int u) { return std::get<1>(children(nodes[u])); },
+        &liveN);
+
+    for (int i = 0; i < nodeN; i++) {
+        if (newIndex[i] < 0)
+            continue;
+
+        int j = newIndex[i];
+        if (j != i)
+            nodes[j] = nodes[i];
+
+        auto c = children(nodes[j]);
+        if (std::get<0>(c) >= 0)
+            std::get<0>(c) = newIndex[std::get<0>(c)];
+        if (std::get<1>(c) >= 0)
+            std::get<1>(c) = newIndex[std::get<1>(c)];
+    }
+    nodes.erase(nodes.begin() + liveN, nodes.end());
+    if (shrink)
+        nodes.shrink_to_fit();
+
+    for (auto& r : roots) {
+        if (r >= 0)
+            r = newIndex[r];
+    }
+
+    return nodeN - liveN;
+}
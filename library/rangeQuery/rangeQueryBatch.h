@@ -0,0 +1,94 @@
+#pragma once
+
+#include <vector>
+#include <thread>
+#include <algorithm>
+
+#if !defined(__GNUC__) && (defined(_M_X64) || defined(_M_IX86))
+#include <xmmintrin.h>
+#endif
+
+//--------- Batched Range Query -----------------------------------------------
+
+// Answers independent read-only range queries.
+//  - prefetchF(left, right) is called PrefetchDistance queries ahead
+//  - if 'sortByLeft' is true, queries are processed in increasing order of 'left'.
+//    It costs O(QlogQ), so use it only when many queries share their left parts.
+//    (for uniformly random queries it is slower than the original order)
+//  - queries are split into 'threadN' chunks and run in parallel
+//    (the structure must not be modified during the batch)
+//
+//  queryF    : T(int left, int right)
+//  prefetchF : void(int left, int right)
+template <typename T, typename QueryFuncT, typename PrefetchFuncT>
+inline void processQueryBatch(const pair<int, int> qry[], int n, T out[],
+                              const QueryFuncT& queryF, const PrefetchFuncT& prefetchF,
+                              int threadN = 1, bool sortByLeft = false) {
+    static const int PrefetchDistance = 8;
+
+    if (n <= 0)
+        return;
+
+    // (left << 32) | query index
+    vector<unsigned long long> order;
+    if (sortByLeft) {
+        order.resize(n);
+        for (int i = 0; i < n; i++)
+            order[i] = (static_cast<unsigned long long>(qry[i].first) << 32) | unsigned(i);
+        sort(order.begin(), order.end());
+    }
+
+    auto run = [&](int first, int last) {
+        if (order.empty()) {
+            for (int i = first; i < last; i++) {
+                if (i + PrefetchDistance < last)
+                    prefetchF(qry[i + PrefetchDistance].first, qry[i + PrefetchDistance].second);
+                out[i] = queryF(qry[i].first, qry[i].second);
+            }
+        } else {
+            for (int i = first; i < last; i++) {
+                if (i + PrefetchDistance < last) {
+                    auto& q = qry[unsigned(order[i + PrefetchDistance])];
+                    prefetchF(q.first, q.second);
+                }
+                int j = int(unsigned(order[i]));
+                out[j] = queryF(qry[j].first, qry[j].second);
+            }
+        }
+    };
+
+    threadN = max(1, min(threadN, n));
+    if (threadN == 1) {
+        run(0, n);
+        return;
+    }
+
+    vector<thread> threads;
+    threads.reserve(threadN - 1);
+
+    int step = (n + threadN - 1) / threadN;
+    for (int first = step; first < n; first += step)
+        threads.emplace_back(run, first, min(n, first + step));
+    run(0, min(n, step));
+
+    for (auto& t : threads)
+        t.join();
+}
+
+template <typename T, typename QueryFuncT>
+inline void processQueryBatch(const pair<int, int> qry[], int n, T out[], const QueryFuncT& queryF,
+                              int threadN = 1, bool sortByLeft = false) {
+    processQueryBatch(qry, n, out, queryF, [](int, int) {}, threadN, sortByLeft);
+}
+
+// a hint only, it's a no-op on unknown compilers and targets
+template <typename T>
+inline void prefetchQueryData(const T* p) {
+#if defined(__GNUC__)
+    __builtin_prefetch(p, 0, 3);
+#elif defined(_M_X64) || defined(_M_IX86)
+    _mm_prefetch(reinterpret_cast<const char*>(p), _MM_HINT_T0);
+#else
+    (void)p;
+#endif
+}
@@ -3,6 +3,8 @@
 #include <vector>
 #include <functional>
 
+#include "rangeQueryBatch.h"
+
 //--------- Operations --------------------------------------------------------
 
 template <typename T>
@@ -105,6 +107,16 @@ struct SegmentTree {
         return querySub(left, right, 1, 0, N - 1);
     }
 
+    // out[i] = query(qry[i].first, qry[i].second), O(QlogN / threadN)
+    void queryBatch(const pair<int, int> qry[], int n, T out[], int threadN = 1, bool sortByLeft = false) const {
+        processQueryBatch(qry, n, out, [this](int left, int right) { return query(left, right); }, threadN, sortByLeft);
+    }
+
+    void queryBatch(const vector<pair<int, int>>& qry, vector<T>& out, int threadN = 1, bool sortByLeft = false) const {
+        out.resize(qry.size());
+        queryBatch(qry.data(), int(qry.size()), out.data(), threadN, sortByLeft);
+    }
+
     // inclusive, O(logN)
     T update(int index, T newValue) {
         return updateSub(index, newValue, 1, 0, N - 1);
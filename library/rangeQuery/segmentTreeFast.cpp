@@ -0,0 +1,234 @@
+#include <memory.h>
+#include <climits>
+#include <queue>
+#include <stack>
+#include <numeric>
+#include <algorithm>
+
+using namespace std;
+
+#include "segmentTree.h"
+#include "segmentTreeFast.h"
+
+/////////// For Testing ///////////////////////////////////////////////////////
+
+#include <time.h>
+#include <cassert>
+#include <string>
+#include <iostream>
+#include "../common/iostreamhelper.h"
+#include "../common/profile.h"
+#include "../common/rand.h"
+
+static int lowerBoundSlow(const vector<int>& v, int k) {
+    int res = 0;
+    for (int i = 0; i < int(v.size()); i++) {
+        res += v[i];
+        if (res >= k)
+            return i;
+    }
+    return int(v.size());
+}
+
+void testSegmentTreeFast() {
+    return; //TODO: if you want to test, make this line a comment.
+
+    cout << "-- Fast Segment Tree ----------------------------------------" << endl;
+    {
+        FastSegmentTree<int, SumOp<int>> segTree(vector<int>{6, 5, 4, 3, 2, 1}, SumOp<int>());
+        FastSegmentTree<int, MinOp<int>> segTree2(vector<int>{6, 5, 4, 3, 2, 1}, MinOp<int>(), INT_MAX);
+
+        int ans;
+
+        ans = segTree.query(1, 3);
+        assert(ans == 12);
+
+        segTree.update(2, 10);
+        ans = segTree.query(1, 3);
+        assert(ans == 18);
+
+        ans = segTree2.query(1, 3);
+        assert(ans == 3);
+
+        segTree2.update(2, -10);
+        ans = segTree2.query(1, 3);
+        assert(ans == -10);
+
+        segTree.update(0, 2, 3);
+        ans = segTree.query(1, 3);
+        assert(ans == 9);
+
+        segTree2.update(0, 2, 2);
+        ans = segTree2.query(1, 3);
+        assert(ans == 2);
+    }
+    cout << "*** compare with SegmentTree" << endl;
+    {
+        for (int N = 1; N <= 100; N++) {
+            vector<int> in(N);
+            for (int i = 0; i < N; i++)
+                in[i] = RandInt32::get() % 1000;
+
+            auto gt = makeSegmentTree(in, [](int a, int b) { return max(a, b); }, INT_MIN);
+            FastSegmentTree<int, MaxOp<int>> seg(in, MaxOp<int>(), INT_MIN);
+            auto gtGcd = makeSegmentTree(in, [](int a, int b) { return gcd(a, b); });
+            FastSegmentTree<int, GcdOp<int>> segGcd(in, GcdOp<int>());
+
+            for (int i = 0; i < 100; i++) {
+                int L = RandInt32::get() % N;
+                int R = RandInt32::get() % N;
+                if (L > R)
+                    swap(L, R);
+                if (RandInt32::get() % 2) {
+                    int x = RandInt32::get() % 1000;
+                    gt.update(L, R, x);
+                    seg.update(L, R, x);
+                    gtGcd.update(L, x);
+                    segGcd.update(L, x);
+                }
+                assert(gt.query(L, R) == seg.query(L, R));
+                assert(gtGcd.query(L, R) == segGcd.query(L, R));
+            }
+        }
+    }
+    cout << "*** lowerBound()" << endl;
+    {
+        for (int N = 1; N <= 1000; N += 37) {
+            vector<int> in(N);
+            for (int i = 0; i < N; i++)
+                in[i] = RandInt32::get() % 1000;
+
+            FastSegmentTree<int, SumOp<int>> seg(in, SumOp<int>());
+
+            int total = accumulate(in.begin(), in.end(), 0);
+            for (int i = 0; i < 100; i++) {
+                int sum = RandInt32::get() % (total + 2);
+                auto ans = seg.lowerBound([sum](int val) { return val >= sum; });
+                int gt = lowerBoundSlow(in, sum);
+                if (ans != gt) {
+                    cerr << "[" << sum << "] ans = " << ans << ", gt = " << gt << endl;
+                    ans = seg.lowerBound([sum](int val) { return val >= sum; });
+                }
+                assert(ans == gt);
+            }
+        }
+    }
+    cout << "OK!" << endl;
+    cout << "-- Fast Segment Tree Performance Test -----------------------" << endl;
+    {
+        int N = 1000000;
+#ifdef _DEBUG
+        N = 10000;
+#endif
+
+        vector<int> T(N);
+        for (int i = 0; i < N; i++)
+            T[i] = RandInt32::get() % 1000;
+
+        vector<pair<int, int>> Q;
+        for (int i = 0; i < N; i++) {
+            int a = RandInt32::get() % N;
+            int b = RandInt32::get() % N;
+            Q.push_back({ min(a, b), max(a, b) });
+        }
+
+        vector<pair<int, int>> U;
+        for (int i = 0; i < N; i++)
+            U.emplace_back(RandInt32::get() % N, RandInt32::get() % 1000);
+
+        cout << "*** SegmentTree<int> (recursive, function<>) - query" << endl;
+        PROFILE_START(0);
+        {
+            int res = 0;
+            SegmentTree<int> seg(T, [](int a, int b) { return min(a, b); }, INT_MAX);
+            for (int i = 0; i < 10; i++) {
+                for (auto& it : Q)
+                    res += seg.query(it.first, it.second);
+            }
+            cout << "result = " << res << endl;
+        }
+        PROFILE_STOP(0);
+
+        cout << "*** SegmentTree<int, MinOp<int>> (recursive) - query" << endl;
+        PROFILE_START(1);
+        {
+            int res = 0;
+            SegmentTree<int, MinOp<int>> seg(T, MinOp<int>(), INT_MAX);
+            for (int i = 0; i < 10; i++) {
+                for (auto& it : Q)
+                    res += seg.query(it.first, it.second);
+            }
+            cout << "result = " << res << endl;
+        }
+        PROFILE_STOP(1);
+
+        cout << "*** FastSegmentTree<int, MinOp<int>> - query" << endl;
+        PROFILE_START(2);
+        {
+            int res = 0;
+            FastSegmentTree<int, MinOp<int>> seg(T, MinOp<int>(), INT_MAX);
+            for (int i = 0; i < 10; i++) {
+                for (auto& it : Q)
+                    res += seg.query(it.first, it.second);
+            }
+            cout << "result = " << res << endl;
+        }
+        PROFILE_STOP(2);
+
+        cout << "*** FastSegmentTree<int, MinOp<int>> - batch query" << endl;
+        PROFILE_START(5);
+        {
+            int res = 0;
+            vector<int> out;
+            FastSegmentTree<int, MinOp<int>> seg(T, MinOp<int>(), INT_MAX);
+            for (int i = 0; i < 10; i++) {
+                seg.queryBatch(Q, out);
+                for (auto x : out)
+                    res += x;
+            }
+            cout << "result = " << res << endl;
+        }
+        PROFILE_STOP(5);
+
+        cout << "*** FastSegmentTree<int, MinOp<int>> - batch query (sorted)" << endl;
+        PROFILE_START(6);
+        {
+            int res = 0;
+            vector<int> out;
+            FastSegmentTree<int, MinOp<int>> seg(T, MinOp<int>(), INT_MAX);
+            for (int i = 0; i < 10; i++) {
+                seg.queryBatch(Q, out, 1, true);
+                for (auto x : out)
+                    res += x;
+            }
+            cout << "result = " << res << endl;
+        }
+        PROFILE_STOP(6);
+
+        cout << "*** SegmentTree<int> (recursive, function<>) - update" << endl;
+        PROFILE_START(3);
+        {
+            SegmentTree<int> seg(T, [](int a, int b) { return a + b; }, 0);
+            for (int i = 0; i < 10; i++) {
+                for (auto& it : U)
+                    seg.update(it.first, it.second);
+            }
+            cout << "result = " << seg.query(0, N - 1) << endl;
+        }
+        PROFILE_STOP(3);
+
+        cout << "*** FastSegmentTree<int, SumOp<int>> - update" << endl;
+        PROFILE_START(4);
+        {
+            FastSegmentTree<int, SumOp<int>> seg(T, SumOp<int>(), 0);
+            for (int i = 0; i < 10; i++) {
+                for (auto& it : U)
+                    seg.update(it.first, it.second);
+            }
+            cout << "result = " << seg.query(0, N - 1) << endl;
+        }
+        PROFILE_STOP(4);
+    }
+
+    cout << "OK!" << endl;
+}
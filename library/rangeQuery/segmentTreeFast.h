@@ -0,0 +1,207 @@
+#pragma once
+
+#include <vector>
+#include <functional>
+
+#include "segmentTree.h"
+
+//--------- Fast Segment Tree -------------------------------------------------
+// http://codeforces.com/blog/entry/18051
+
+// Bottom-up (non-recursive) segment tree with 2N nodes.
+//  - It has the same interface as SegmentTree (query, update, lowerBound).
+//  - Use a functor type (MaxOp, MinOp, SumOp, GcdOp, lambda, ...) as MergeOp, not function<>, to inline merge operations.
+//  - The merge order is kept, so non-commutative operations can be used too.
+// The first 'node' number is 1, not 0, and leaves are tree[N..2N-1]
+template <typename T, typename MergeOp = function<T(T, T)>>
+struct FastSegmentTree {
+    int       N;            // the size of array
+    vector<T> tree;         //
+
+    MergeOp   mergeOp;
+    T         defaultValue; // identity element of mergeOp
+
+    explicit FastSegmentTree(MergeOp op = MergeOp(), T dflt = T())
+        : N(0), tree(), mergeOp(op), defaultValue(dflt) {
+    }
+
+    FastSegmentTree(int size, MergeOp op, T dflt = T())
+        : mergeOp(op), defaultValue(dflt) {
+        init(size);
+    }
+
+    FastSegmentTree(T value, int n, MergeOp op, T dflt = T())
+        : mergeOp(op), defaultValue(dflt) {
+        build(value, n);
+    }
+
+    FastSegmentTree(const T arr[], int n, MergeOp op, T dflt = T())
+        : mergeOp(op), defaultValue(dflt) {
+        build(arr, n);
+    }
+
+    FastSegmentTree(const vector<T>& v, MergeOp op, T dflt = T())
+        : mergeOp(op), defaultValue(dflt) {
+        build(v);
+    }
+
+
+    // O(N)
+    void init(int size) {
+        N = size;
+        tree.assign(size * 2, defaultValue);
+    }
+
+    // O(N)
+    void build(T value, int n) {
+        init(n);
+        for (int i = 0; i < n; i++)
+            tree[N + i] = value;
+        buildParents();
+    }
+
+    // O(N)
+    void build(const T arr[], int n) {
+        init(n);
+        for (int i = 0; i < n; i++)
+            tree[N + i] = arr[i];
+        buildParents();
+    }
+
+    // O(N)
+    void build(const vector<T>& v) {
+        build(&v[0], int(v.size()));
+    }
+
+
+    // O(1)
+    T query(int index) const {
+        return tree[N + index];
+    }
+
+    // inclusive, O(logN)
+    T query(int left, int right) const {
+        T resL = defaultValue;
+        T resR = defaultValue;
+
+        for (int L = left + N, R = right + N + 1; L < R; L >>= 1, R >>= 1) {
+            if (L & 1)
+                resL = mergeOp(resL, tree[L++]);
+            if (R & 1)
+                resR = mergeOp(tree[--R], resR);
+        }
+
+        return mergeOp(resL, resR);
+    }
+
+    // out[i] = query(qry[i].first, qry[i].second), O(QlogN / threadN)
+    void queryBatch(const pair<int, int> qry[], int n, T out[], int threadN = 1, bool sortByLeft = false) const {
+        processQueryBatch(qry, n, out,
+            [this](int left, int right) { return query(left, right); },
+            [this](int left, int right) {
+                prefetchQueryData(&tree[N + left]);
+                prefetchQueryData(&tree[N + right]);
+            },
+            threadN, sortByLeft);
+    }
+
+    void queryBatch(const vector<pair<int, int>>& qry, vector<T>& out, int threadN = 1, bool sortByLeft = false) const {
+        out.resize(qry.size());
+        queryBatch(qry.data(), int(qry.size()), out.data(), threadN, sortByLeft);
+    }
+
+    // O(logN)
+    void update(int index, T newValue) {
+        int i = index + N;
+        tree[i] = newValue;
+        for (i >>= 1; i > 0; i >>= 1)
+            tree[i] = mergeOp(tree[i << 1], tree[(i << 1) | 1]);
+    }
+
+    // inclusive, O(K + logN)
+    void update(int left, int right, T newValue) {
+        for (int i = left + N, end = right + N; i <= end; i++)
+            tree[i] = newValue;
+
+        for (int L = (left + N) >> 1, R = (right + N) >> 1; L > 0; L >>= 1, R >>= 1) {
+            for (int i = L; i <= R; i++)
+                tree[i] = mergeOp(tree[i << 1], tree[(i << 1) | 1]);
+        }
+    }
+
+
+    // PRECONDITION: tree's range operation is monotonically increasing or decreasing (positive / negative sum, min, max, gcd, lcm, ...)
+    // lower bound where f(x) is true in [0, N), and N if f(x) is false for all x
+    //   f(x): xxxxxxxxxxxOOOOOOOO
+    //         S          ^
+    // O(logN)
+    template <typename PredT>
+    int lowerBound(const PredT& f) const {
+        // nodes covering [0, N) from left to right
+        int nodes[64];
+        int leftCnt = 0, rightCnt = 64;
+        for (int L = N, R = N + N; L < R; L >>= 1, R >>= 1) {
+            if (L & 1)
+                nodes[leftCnt++] = L++;
+            if (R & 1)
+                nodes[--rightCnt] = --R;
+        }
+        while (rightCnt < 64)
+            nodes[leftCnt++] = nodes[rightCnt++];
+
+        T delta = defaultValue;
+        for (int i = 0; i < leftCnt; i++) {
+            int node = nodes[i];
+            T val = mergeOp(delta, tree[node]);
+            if (!f(val)) {
+                delta = val;
+                continue;
+            }
+
+            // all leaves of a covering node are at the same depth
+            while (node < N) {
+                node <<= 1;
+                val = mergeOp(delta, tree[node]);
+                if (!f(val)) {
+                    delta = val;
+                    node++;
+                }
+            }
+            return node - N;
+        }
+
+        return N;
+    }
+
+private:
+    void buildParents() {
+        for (int i = N - 1; i > 0; i--)
+            tree[i] = mergeOp(tree[i << 1], tree[(i << 1) | 1]);
+    }
+};
+
+template <typename T, typename MergeOp>
+inline FastSegmentTree<T, MergeOp> makeFastSegmentTree(int size, MergeOp op, T dfltValue = T()) {
+    return FastSegmentTree<T, MergeOp>(size, op, dfltValue);
+}
+
+template <typename T, typename MergeOp>
+inline FastSegmentTree<T, MergeOp> makeFastSegmentTree(const T arr[], int size, MergeOp op, T dfltValue = T()) {
+    return FastSegmentTree<T, MergeOp>(arr, size, op, dfltValue);
+}
+
+template <typename T, typename MergeOp>
+inline FastSegmentTree<T, MergeOp> makeFastSegmentTree(const vector<T>& v, MergeOp op, T dfltValue = T()) {
+    return FastSegmentTree<T, MergeOp>(v, op, dfltValue);
+}
+
+/* example
+    1) Min Segment Tree (RMQ)
+        FastSegmentTree<int, MinOp<int>> segTree(N, MinOp<int>(), INT_MAX);
+    2) Max Segment Tree
+        FastSegmentTree<int, MaxOp<int>> segTree(N, MaxOp<int>(), INT_MIN);
+    3) GCD Segment Tree
+        FastSegmentTree<int, GcdOp<int>> segTree(N, GcdOp<int>());
+    4) with lambda (the closure type is inlined too)
+        auto segTree = makeFastSegmentTree<int>(N, [](int a, int b) { return min(a, b); }, INT_MAX);
+*/
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "persistentNodeGC.h"
+
 // The first 'node' number is 1, not 0
 // Others('left', 'right', 'nodeLeft', 'nodeRight', 'index') are started from 0
 template <typename T, typename MergeOp = function<T(T, T)>, typename BlockOp = function<T(T, int)>>
@@ -44,6 +46,27 @@ struct PartiallyPersistentSegmentTreeLazy {
                 values[index].push_back(val);
             }
         }
+
+        // keeps values visible at 'keptTimes' and renumbers the times to 0, 1, 2, ...
+        // PRECONDITION: 'keptTimes' is sorted
+        // O(#values * log(#keptTimes))
+        void retain(const vector<int>& keptTimes) {
+            for (int i = 0; i < N; i++) {
+                int n = 0;
+                for (int j = 0; j < int(times[i].size()); j++) {
+                    int t = int(lower_bound(keptTimes.begin(), keptTimes.end(), times[i][j]) - keptTimes.begin());
+                    if (t >= int(keptTimes.size()))
+                        break;
+                    if (j + 1 < int(times[i].size()) && times[i][j + 1] <= keptTimes[t])
+                        continue;
+                    times[i][n] = t;
+                    values[i][n] = values[i][j];
+                    n++;
+                }
+                times[i].resize(n);
+                values[i].resize(n);
+            }
+        }
     };
 
     struct Node {
@@ -86,6 +109,37 @@ struct PartiallyPersistentSegmentTreeLazy {
         return int(trees.size());
     }
 
+    int getNodeCount() const {
+        return int(nodes.size());
+    }
+
+    // Drops all versions except 'historyIndexes' and the last version, and removes nodes unreachable from them.
+    //  - retained versions are renumbered to 0, 1, 2, ... in increasing order of their history indexes
+    //  - if 'shrink' is true, unused memory is returned to the system
+    // returns the number of removed nodes, O(#nodes + #lazy values * log(#retained versions))
+    int collectGarbage(vector<int> historyIndexes, bool shrink = false) {
+        historyIndexes.push_back(int(trees.size()) - 1);
+        sort(historyIndexes.begin(), historyIndexes.end());
+        historyIndexes.erase(unique(historyIndexes.begin(), historyIndexes.end()), historyIndexes.end());
+
+        vector<int> roots;
+        roots.reserve(historyIndexes.size());
+        for (int h : historyIndexes)
+            roots.push_back(trees[h]);
+
+        int res = compactPersistentNodes(nodes, roots, [](Node& node) { return std::tie(node.left, node.right); }, shrink);
+
+        // lazy values are also set at the next time (= trees.size())
+        historyIndexes.push_back(int(trees.size()));
+        treesLazy.retain(historyIndexes);
+
+        trees.swap(roots);
+        if (shrink)
+            trees.shrink_to_fit();
+
+        return res;
+    }
+
 
     // O(NlogN)
     T build(T value, int n) {
@@ -198,8 +252,8 @@ private:
             return make_pair(initValue, addNode(node, initValue));
 
         int mid = left + (right - left) / 2;
-        auto L = initSub<U>(initValue, left, mid, node * 2);
-        auto R = initSub<U>(initValue, mid + 1, right, node * 2 + 1);
+        auto L = initSub(initValue, left, mid, node * 2);
+        auto R = initSub(initValue, mid + 1, right, node * 2 + 1);
         auto value = mergeOp(L.first, R.first);
         return make_pair(value, addNode(node, value, L.second, R.second));
     }
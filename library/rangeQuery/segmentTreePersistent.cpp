@@ -8,6 +8,7 @@ using namespace std;
 
 #include "segmentTreePersistent.h"
 #include "segmentTreePersistentLazy.h"
+#include "segmentTreePartiallyPersistentLazy.h"
 
 /////////// For Testing ///////////////////////////////////////////////////////
 
@@ -39,6 +40,61 @@ static int lowerBoundSlow(vector<int>& v, int k) {
     return int(v.size());
 }
 
+// builds T versions with update(tree, index, value), keeps every 10th version, and checks them and new versions after GC
+template <typename TreeT, typename UpdateT>
+static void testGarbageCollection(const UpdateT& update) {
+    const int N = 1000;
+    const int T = 2000;
+
+    vector<int> in(N);
+    for (int i = 0; i < N; i++)
+        in[i] = RandInt32::get() % 1000;
+
+    TreeT tree(in, [](int a, int b) { return a + b; }, 0);
+
+    vector<vector<int>> vv(1, in);
+    for (int i = 0; i < T; i++) {
+        int idx = RandInt32::get() % N;
+        int newVal = RandInt32::get() % 1000;
+        update(tree, idx, newVal);
+        in[idx] = newVal;
+        vv.push_back(in);
+    }
+
+    vector<int> keep;
+    for (int i = 0; i <= T; i += 10)
+        keep.push_back(i);
+
+    int nodeN = tree.getNodeCount();
+    int removed = tree.collectGarbage(keep, true);
+    assert(removed > 0 && tree.getNodeCount() == nodeN - removed);
+    assert(tree.getHistorySize() == int(keep.size()));
+
+    for (int j = 0; j < int(keep.size()); j++) {
+        for (int i = 0; i < 10; i++) {
+            int L = RandInt32::get() % N;
+            int R = RandInt32::get() % N;
+            if (L > R)
+                swap(L, R);
+            assert(tree.query(j, L, R) == sumSlow(vv[keep[j]], L, R));
+        }
+    }
+
+    // new versions after GC
+    for (int i = 0; i < 100; i++) {
+        int idx = RandInt32::get() % N;
+        int newVal = RandInt32::get() % 1000;
+        update(tree, idx, newVal);
+        in[idx] = newVal;
+
+        int L = RandInt32::get() % N;
+        int R = RandInt32::get() % N;
+        if (L > R)
+            swap(L, R);
+        assert(tree.query(L, R) == sumSlow(in, L, R));
+    }
+}
+
 void testSegmentTreePersistent() {
     return; //TODO: if you want to test, make this line a comment.
 
@@ -245,6 +301,16 @@ void testSegmentTreePersistent() {
         }
     }
     cout << "OK!" << endl;
+    cout << "*** garbage collection" << endl;
+    {
+        typedef PersistentSegmentTree<int> TreeT;
+        typedef PersistentSegmentTreeLazy<int> TreeLazyT;
+        typedef PartiallyPersistentSegmentTreeLazy<int> PartialTreeT;
+        testGarbageCollection<TreeT>([](TreeT& tree, int idx, int val) { tree.upgrade(idx, val); });
+        testGarbageCollection<TreeLazyT>([](TreeLazyT& tree, int idx, int val) { tree.upgrade(idx, val); });
+        testGarbageCollection<PartialTreeT>([](PartialTreeT& tree, int idx, int val) { tree.update(idx, val); });
+    }
+    cout << "OK!" << endl;
     cout << "-- Persistent Segment Tree Performance Test -----------------------" << endl;
     cout << "*** Persistent segment tree vs RMQ" << endl;
     {
@@ -2,6 +2,7 @@
 
 #include <vector>
 #include <functional>
+#include "persistentNodeGC.h"
 
 //--------- Simple Persistent Segment Tree ------------------------------------
 
@@ -21,7 +22,7 @@ struct PersistentSegmentTree {
     T           defaultValue;   // 
 
     explicit PersistentSegmentTree(MergeOp op, T dflt = T())
-        : N(0), nodeN(0), mergeOp(op), defaultValue(dflt) {
+        : N(0), mergeOp(op), defaultValue(dflt) {
     }
 
     PersistentSegmentTree(T value, int n, MergeOp op, T dflt = T())
@@ -44,6 +45,38 @@ struct PersistentSegmentTree {
         return int(trees.size());
     }
 
+    int getNodeCount() const {
+        return int(nodes.size());
+    }
+
+    // reserves memory for 'upgradeCount' upgrade() calls to avoid reallocation of node storage
+    void reserve(int upgradeCount) {
+        int height = 1;
+        while ((1 << (height - 1)) < N)
+            height++;
+        nodes.reserve(nodes.size() + size_t(upgradeCount) * height);
+        trees.reserve(trees.size() + upgradeCount);
+    }
+
+    // Drops all versions except 'historyIndexes', and removes nodes unreachable from them.
+    //  - retained versions are renumbered to 0, 1, 2, ... in the order of 'historyIndexes'
+    //  - if 'shrink' is true, unused memory is returned to the system
+    // returns the number of removed nodes, O(#nodes)
+    int collectGarbage(const vector<int>& historyIndexes, bool shrink = false) {
+        vector<int> roots;
+        roots.reserve(historyIndexes.size());
+        for (int h : historyIndexes)
+            roots.push_back(trees[h]);
+
+        int res = compactPersistentNodes(nodes, roots, [](Node& node) { return std::tie(node.left, node.right); }, shrink);
+
+        trees.swap(roots);
+        if (shrink)
+            trees.shrink_to_fit();
+
+        return res;
+    }
+
 
     // O(NlogN)
     T build(T value, int n) {
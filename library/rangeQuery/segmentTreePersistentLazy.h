@@ -1,5 +1,7 @@
 #pragma once
 
+#include "persistentNodeGC.h"
+
 // PersistentSegmentTreeLazy supports full persistent functions,
 //  but the upgrade functions is very slower than PartiallyPersistentSegmentTreeLazy.
 //
@@ -50,6 +52,36 @@ struct PersistentSegmentTreeLazy {
         return int(trees.size());
     }
 
+    int getNodeCount() const {
+        return int(nodes.size());
+    }
+
+    // Drops all versions except 'historyIndexes', and removes nodes unreachable from them.
+    //  - retained versions are renumbered to 0, 1, 2, ... in the order of 'historyIndexes'
+    //  - if 'shrink' is true, unused memory is returned to the system
+    // returns the number of removed nodes, O(#nodes + #lazy values of retained versions)
+    int collectGarbage(const vector<int>& historyIndexes, bool shrink = false) {
+        vector<int> roots;
+        vector<unordered_map<int, T>> lazy;
+        roots.reserve(historyIndexes.size());
+        lazy.reserve(historyIndexes.size());
+        for (int h : historyIndexes) {
+            roots.push_back(trees[h]);
+            lazy.push_back(treesLazy[h]);   // lazy values are keyed by 'id', not by node index
+        }
+
+        int res = compactPersistentNodes(nodes, roots, [](Node& node) { return std::tie(node.left, node.right); }, shrink);
+
+        trees.swap(roots);
+        treesLazy.swap(lazy);
+        if (shrink) {
+            trees.shrink_to_fit();
+            treesLazy.shrink_to_fit();
+        }
+
+        return res;
+    }
+
 
     // O(NlogN)
     T build(T value, int n) {
@@ -147,7 +179,7 @@ struct PersistentSegmentTreeLazy {
     // inclusive, O(klogN)
     T upgradeRange(int historyIndex, int left, int right, T newValue) {
         treesLazy.push_back(treesLazy[historyIndex]);
-        auto t = upgradeeRangeSub(int(treesLazy.size()) - 1, trees[historyIndex], left, right, newValue, 0, N - 1);
+        auto t = upgradeRangeSub(int(treesLazy.size()) - 1, trees[historyIndex], left, right, newValue, 0, N - 1);
         trees.push_back(t.second);
         return t.first;
     }
@@ -193,8 +225,8 @@ private:
             return make_pair(initValue, addNode(node, initValue));
 
         int mid = left + (right - left) / 2;
-        auto L = initSub<U>(initValue, left, mid, node * 2);
-        auto R = initSub<U>(initValue, mid + 1, right, node * 2 + 1);
+        auto L = initSub(initValue, left, mid, node * 2);
+        auto R = initSub(initValue, mid + 1, right, node * 2 + 1);
         auto value = mergeOp(L.first, R.first);
         return make_pair(value, addNode(node, value, L.second, R.second));
     }
@@ -248,7 +280,7 @@ private:
             pushDown(historyIndex, nodes[node].right, it->second, mid + 1, nodeRight);
             treesLazy[historyIndex].erase(it);
         }
-        return nodes[p].value = mergeOp(updateSub(historyIndex, nodes[node].left, index, newValue, nodeLeft, mid),
+        return nodes[node].value = mergeOp(updateSub(historyIndex, nodes[node].left, index, newValue, nodeLeft, mid),
                                         updateSub(historyIndex, nodes[node].right, index, newValue, mid + 1, nodeRight));
     }
 
@@ -133,6 +133,47 @@ void testSegmentTreePersistentLazySimple() {
             }
         }
     }
+    cout << "*** garbage collection" << endl;
+    {
+        int N = 1000;
+        int T = 10000;
+        int K = 50;         // the number of retained versions
+
+        SimplePersistentSegmentTreeLazy<long long> tree(N,
+            [](long long a, long long b) { return a + b; },
+            [](long long x, int n) { return x * n; },
+            0ll);
+
+        vector<vector<long long>> v(1, vector<long long>(N));
+        vector<int> roots(1, tree.getInitRoot());
+
+        for (int i = 0; i < T; i++) {
+            int L = RandInt32::get() % N;
+            int R = RandInt32::get() % N;
+            if (L > R)
+                swap(L, R);
+
+            int history = RandInt32::get() % int(roots.size());
+            int x = RandInt32::get() % 1000 + 1;
+
+            auto ans = tree.query(roots[history], L, R);
+            long long gt = sumSlow(v[history], L, R);
+            assert(ans == gt);
+
+            roots.push_back(tree.update(roots[history], L, R, x));
+            v.push_back(v[history]);
+            updateSlow(v.back(), L, R, x);
+
+            if (int(roots.size()) >= 2 * K) {
+                roots.erase(roots.begin(), roots.end() - K);
+                v.erase(v.begin(), v.end() - K);
+
+                int nodeN = tree.getNodeCount();
+                roots = tree.collectGarbage(roots);
+                assert(tree.getNodeCount() <= nodeN);
+            }
+        }
+    }
 
     cout << "OK!" << endl;
 }
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "persistentNodeGC.h"
+
 template <typename T, typename MergeOp = function<T(T, T)>, typename BlockOp = function<T(T, int)>>
 struct SimplePersistentSegmentTreeLazy {
     struct Node {
@@ -43,6 +45,25 @@ struct SimplePersistentSegmentTreeLazy {
         return initRoot;
     }
 
+    int getNodeCount() const {
+        return int(nodes.size());
+    }
+
+    // Removes nodes unreachable from the initial root and 'liveRoots'.
+    //  - if 'shrink' is true, unused memory is returned to the system
+    // returns new root indexes of 'liveRoots', O(#nodes)
+    vector<int> collectGarbage(const vector<int>& liveRoots, bool shrink = false) {
+        vector<int> roots;
+        roots.reserve(liveRoots.size() + 1);
+        roots.push_back(initRoot);
+        roots.insert(roots.end(), liveRoots.begin(), liveRoots.end());
+
+        compactPersistentNodes(nodes, roots, [](Node& node) { return std::tie(node.L, node.R); }, shrink);
+
+        initRoot = roots.front();
+        return vector<int>(roots.begin() + 1, roots.end());
+    }
+
     // return root node index, O(logN)
     int update(int root, int index, T val) {
         return dfsUpdate(root, 0, N - 1, index, index, val);
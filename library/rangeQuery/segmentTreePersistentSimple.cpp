@@ -80,6 +80,46 @@ void testSegmentTreePersistentSimple() {
             }
         }
     }
+    cout << "*** garbage collection" << endl;
+    {
+        int N = 1000;
+        int T = 100000;
+        int K = 100;        // the number of retained versions
+
+        vector<vector<int>> vv;
+        vector<int> liveRoots;
+
+        SimplePersistentSegmentTree<int> tree(N, [](int a, int b) { return a + b; }, 0);
+        vv.push_back(vector<int>(N));
+        liveRoots.push_back(tree.getInitRoot());
+
+        int maxNodeN = 0;
+        for (int i = 1; i <= T; i++) {
+            int idx = RandInt32::get() % N;
+            int x = RandInt32::get() % 10000;
+            vv.push_back(vv.back());
+            vv.back()[idx] = x;
+            liveRoots.push_back(tree.set(liveRoots.back(), idx, x));
+
+            if (int(liveRoots.size()) >= 2 * K) {
+                vv.erase(vv.begin(), vv.end() - K);
+                liveRoots.erase(liveRoots.begin(), liveRoots.end() - K);
+
+                maxNodeN = max(maxNodeN, tree.getNodeCount());
+                liveRoots = tree.collectGarbage(liveRoots);
+            }
+
+            int L = RandInt32::get() % N;
+            int R = RandInt32::get() % N;
+            if (L > R)
+                swap(L, R);
+
+            int v = RandInt32::get() % int(liveRoots.size());
+            assert(tree.query(liveRoots[v], L, R) == sumSlow(vv[v], L, R));
+            assert(tree.query(tree.getInitRoot(), L, R) == 0);
+        }
+        cout << "max node count = " << maxNodeN << " (without GC: " << 2 * N - 1 + T * 11 << ")" << endl;
+    }
 
     cout << "OK!" << endl;
 }
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "persistentNodeGC.h"
+
 template <typename T, typename MergeOp = function<T(T,T)>>
 struct SimplePersistentSegmentTree {
     int N;
@@ -36,6 +38,51 @@ struct SimplePersistentSegmentTree {
         return roots.front();
     }
 
+    int getNodeCount() const {
+        return int(value.size());
+    }
+
+    // Removes nodes unreachable from the initial root and 'liveRoots'.
+    //  - 'roots' is replaced with the initial root and 'liveRoots'
+    //  - if 'shrink' is true, unused memory is returned to the system
+    // returns new root indexes of 'liveRoots', O(#nodes)
+    vector<int> collectGarbage(const vector<int>& liveRoots, bool shrink = false) {
+        vector<int> newRoots;
+        newRoots.reserve(liveRoots.size() + 1);
+        newRoots.push_back(roots.front());
+        newRoots.insert(newRoots.end(), liveRoots.begin(), liveRoots.end());
+
+        int nodeN = int(value.size());
+        int liveN = 0;
+        auto newIndex = makePersistentNodeMap(nodeN, newRoots,
+            [this](int u) { return L[u]; },
+            [this](int u) { return R[u]; },
+            &liveN);
+
+        for (int i = 0; i < nodeN; i++) {
+            int j = newIndex[i];
+            if (j < 0)
+                continue;
+            value[j] = value[i];
+            L[j] = (L[i] >= 0) ? newIndex[L[i]] : -1;
+            R[j] = (R[i] >= 0) ? newIndex[R[i]] : -1;
+        }
+        value.resize(liveN);
+        L.resize(liveN);
+        R.resize(liveN);
+        if (shrink) {
+            value.shrink_to_fit();
+            L.shrink_to_fit();
+            R.shrink_to_fit();
+        }
+
+        for (auto& r : newRoots)
+            r = newIndex[r];
+        roots = newRoots;
+
+        return vector<int>(newRoots.begin() + 1, newRoots.end());
+    }
+
     // return root node index, O(logN)
     int update(int root, int index, T val) {
         int r = dfsUpdate(root, 0, N - 1, index, val);
@@ -0,0 +1,221 @@
+#pragma once
+
+#include <immintrin.h>
+
+#include <algorithm>
+
+//--------- SIMD Min / Max Kernels --------------------------------------------
+
+// Vectorized min / max kernels for int, long long and float.
+//  - AVX2 (or SSE4.1 / SSE4.2) is used when the compiler is allowed to (ex: -mavx2, -march=native, /arch:AVX2)
+//  - other types and targets use scalar loops
+//
+//  SimdMinMax<T, IsMax>::merge(dst, a, b, n)   : dst[i] = op(a[i], b[i]),  0 <= i < n
+//  SimdMinMax<T, IsMax>::merge(dst, a, x, n)   : dst[i] = op(a[i], x),     0 <= i < n
+//  SimdMinMax<T, IsMax>::reduce(a, n)          : op(a[0], a[1], ..., a[n - 1]),  n > 0
+// ('dst' can be the same as 'a' or 'b')
+
+template <typename T, bool IsMax>
+struct SimdMinMaxLane {
+    static const bool enabled = false;
+};
+
+#if defined(__AVX2__)
+
+template <bool IsMax>
+struct SimdMinMaxLane<int, IsMax> {
+    static const bool enabled = true;
+    static const int width = 8;
+    typedef __m256i V;
+
+    static V load(const int* p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+    static void store(int* p, V v) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v); }
+    static V set1(int x) { return _mm256_set1_epi32(x); }
+    static V op(V a, V b) { return IsMax ? _mm256_max_epi32(a, b) : _mm256_min_epi32(a, b); }
+};
+
+template <bool IsMax>
+struct SimdMinMaxLane<long long, IsMax> {
+    static const bool enabled = true;
+    static const int width = 4;
+    typedef __m256i V;
+
+    static V load(const long long* p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+    static void store(long long* p, V v) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v); }
+    static V set1(long long x) { return _mm256_set1_epi64x(x); }
+    static V op(V a, V b) {
+        // a > b ? (max: a, min: b) : (max: b, min: a)
+        V gt = _mm256_cmpgt_epi64(a, b);
+        return IsMax ? _mm256_blendv_epi8(b, a, gt) : _mm256_blendv_epi8(a, b, gt);
+    }
+};
+
+template <bool IsMax>
+struct SimdMinMaxLane<float, IsMax> {
+    static const bool enabled = true;
+    static const int width = 8;
+    typedef __m256 V;
+
+    static V load(const float* p) { return _mm256_loadu_ps(p); }
+    static void store(float* p, V v) { _mm256_storeu_ps(p, v); }
+    static V set1(float x) { return _mm256_set1_ps(x); }
+    static V op(V a, V b) { return IsMax ? _mm256_max_ps(a, b) : _mm256_min_ps(a, b); }
+};
+
+#elif defined(__SSE4_1__)
+
+template <bool IsMax>
+struct SimdMinMaxLane<int, IsMax> {
+    static const bool enabled = true;
+    static const int width = 4;
+    typedef __m128i V;
+
+    static V load(const int* p) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+    static void store(int* p, V v) { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v); }
+    static V set1(int x) { return _mm_set1_epi32(x); }
+    static V op(V a, V b) { return IsMax ? _mm_max_epi32(a, b) : _mm_min_epi32(a, b); }
+};
+
+#if defined(__SSE4_2__)
+template <bool IsMax>
+struct SimdMinMaxLane<long long, IsMax> {
+    static const bool enabled = true;
+    static const int width = 2;
+    typedef __m128i V;
+
+    static V load(const long long* p) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+    static void store(long long* p, V v) { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v); }
+    static V set1(long long x) { return _mm_set1_epi64x(x); }
+    static V op(V a, V b) {
+        V gt = _mm_cmpgt_epi64(a, b);
+        return IsMax ? _mm_blendv_epi8(b, a, gt) : _mm_blendv_epi8(a, b, gt);
+    }
+};
+#endif
+
+template <bool IsMax>
+struct SimdMinMaxLane<float, IsMax> {
+    static const bool enabled = true;
+    static const int width = 4;
+    typedef __m128 V;
+
+    static V load(const float* p) { return _mm_loadu_ps(p); }
+    static void store(float* p, V v) { _mm_storeu_ps(p, v); }
+    static V set1(float x) { return _mm_set1_ps(x); }
+    static V op(V a, V b) { return IsMax ? _mm_max_ps(a, b) : _mm_min_ps(a, b); }
+};
+
+#endif
+
+template <typename T, bool IsMax, bool Vectorized = SimdMinMaxLane<T, IsMax>::enabled>
+struct SimdMinMax {
+    static const bool vectorized = false;
+
+    static T op(T a, T b) {
+        return IsMax ? (a < b ? b : a) : (b < a ? b : a);
+    }
+
+    static void merge(T* dst, const T* a, const T* b, int n) {
+        for (int i = 0; i < n; i++)
+            dst[i] = op(a[i], b[i]);
+    }
+
+    static void merge(T* dst, const T* a, T x, int n) {
+        for (int i = 0; i < n; i++)
+            dst[i] = op(a[i], x);
+    }
+
+    static T reduce(const T* a, int n) {
+        T res = a[0];
+        for (int i = 1; i < n; i++)
+            res = op(res, a[i]);
+        return res;
+    }
+};
+
+template <typename T, bool IsMax>
+struct SimdMinMax<T, IsMax, true> {
+    typedef SimdMinMaxLane<T, IsMax> Lane;
+    typedef typename Lane::V V;
+
+    static const bool vectorized = true;
+
+    static T op(T a, T b) {
+        return IsMax ? (a < b ? b : a) : (b < a ? b : a);
+    }
+
+    static void merge(T* dst, const T* a, const T* b, int n) {
+        int i = 0;
+        for (; i + Lane::width <= n; i += Lane::width)
+            Lane::store(dst + i, Lane::op(Lane::load(a + i), Lane::load(b + i)));
+        for (; i < n; i++)
+            dst[i] = op(a[i], b[i]);
+    }
+
+    static void merge(T* dst, const T* a, T x, int n) {
+        V vx = Lane::set1(x);
+
+        int i = 0;
+        for (; i + Lane::width <= n; i += Lane::width)
+            Lane::store(dst + i, Lane::op(Lane::load(a + i), vx));
+        for (; i < n; i++)
+            dst[i] = op(a[i], x);
+    }
+
+    static T reduce(const T* a, int n) {
+        if (n < Lane::width) {
+            T res = a[0];
+            for (int i = 1; i < n; i++)
+                res = op(res, a[i]);
+            return res;
+        }
+
+        // the last vector overlaps the previous one, it's OK for min / max
+        V acc = Lane::load(a);
+        for (int i = Lane::width; i + Lane::width <= n; i += Lane::width)
+            acc = Lane::op(acc, Lane::load(a + i));
+        acc = Lane::op(acc, Lane::load(a + n - Lane::width));
+
+        T buf[Lane::width];
+        Lane::store(buf, acc);
+
+        T res = buf[0];
+        for (int i = 1; i < Lane::width; i++)
+            res = op(res, buf[i]);
+        return res;
+    }
+};
+
+//--------- MergeOp to SIMD kernel --------------------------------------------
+
+template <typename T> struct MinOp;
+template <typename T> struct MaxOp;
+
+struct SimdMergeNone {
+    template <typename T>
+    static void merge(T*, const T*, const T*, int) {
+    }
+
+    template <typename T>
+    static void merge(T*, const T*, T, int) {
+    }
+};
+
+// SimdMergeOp<T, MergeOp>::enabled is true if MergeOp is MinOp<T> or MaxOp<T> and T has a vectorized kernel.
+template <typename T, typename MergeOp>
+struct SimdMergeOp {
+    static const bool enabled = false;
+    typedef SimdMergeNone Kernel;
+};
+
+template <typename T>
+struct SimdMergeOp<T, MinOp<T>> {
+    typedef SimdMinMax<T, false> Kernel;
+    static const bool enabled = Kernel::vectorized;
+};
+
+template <typename T>
+struct SimdMergeOp<T, MaxOp<T>> {
+    typedef SimdMinMax<T, true> Kernel;
+    static const bool enabled = Kernel::vectorized;
+};
@@ -19,6 +19,7 @@ using namespace std;
 #include <string>
 #include <iostream>
 #include "../common/iostreamhelper.h"
+#include "../common/profile.h"
 #include "../common/rand.h"
 
 void testSparseTable() {
@@ -76,6 +77,41 @@ void testSparseTable() {
         cout << "OK!" << endl;
     }
 
+    cout << "*** batch query ***" << endl;
+    {
+        int N = 10000;
+        vector<int> in(N);
+        for (int i = 0; i < N; i++)
+            in[i] = RandInt32::get() % 1000000;
+
+        auto st = makeSparseTable<int>(in, [](int a, int b) { return min(a, b); }, INT_MAX);
+        auto stFlat = makeFlatSparseTable<int>(in, [](int a, int b) { return min(a, b); }, INT_MAX);
+        auto seg = makeSegmentTree<int>(in, [](int a, int b) { return min(a, b); }, INT_MAX);
+
+        vector<pair<int, int>> qry;
+        for (int i = 0; i < N; i++) {
+            int L = RandInt32::get() % N;
+            int R = RandInt32::get() % N;
+            if (L > R)
+                swap(L, R);
+            qry.emplace_back(L, R);
+        }
+
+        for (int threadN = 1; threadN <= 4; threadN++) {
+            vector<int> ans1, ans2, ans3;
+            st.queryBatch(qry, ans1, threadN);
+            seg.queryBatch(qry, ans2, threadN, true);
+            stFlat.queryBatch(qry, ans3, threadN);
+            for (int i = 0; i < N; i++) {
+                int gt = *min_element(in.begin() + qry[i].first, in.begin() + qry[i].second + 1);
+                assert(ans1[i] == gt);
+                assert(ans2[i] == gt);
+                assert(ans3[i] == gt);
+                assert(stFlat.query(qry[i].first, qry[i].second) == gt);
+            }
+        }
+    }
+
     cout << "-- Segment Tree & Sparse Table Performance Test --------" << endl;
     {
         int N = 1000000;
@@ -128,6 +164,81 @@ void testSparseTable() {
             }
         }
         cout << "elapsed time(" << res << ") : " << double(clock() - start) / CLOCKS_PER_SEC << endl;
+
+        auto stGeneral = makeSparseTable<int>(T, [](int a, int b) { return min(a, b); }, INT_MAX);
+        vector<int> out;
+
+        cout << "*** Sparse Table - single query ***" << endl;
+        res = 0;
+        PROFILE_HI_START(0);
+        for (int i = 0; i < TN; i++) {
+            for (auto& it : Q) {
+                res += stGeneral.query(it.first, it.second);
+            }
+        }
+        PROFILE_HI_STOP(0);
+        cout << "result = " << res << endl;
+
+        for (int threadN = 1; threadN <= 8; threadN <<= 1) {
+            cout << "*** Sparse Table - batch query (" << threadN << " threads) ***" << endl;
+            res = 0;
+            PROFILE_HI_START(1);
+            for (int i = 0; i < TN; i++) {
+                stGeneral.queryBatch(Q, out, threadN);
+                for (auto x : out)
+                    res += x;
+            }
+            PROFILE_HI_STOP(1);
+            cout << "result = " << res << endl;
+        }
+    }
+    cout << "-- Sparse Table Layout Performance Test ----------------" << endl;
+    {
+        // N = 10^8 needs about 10GB per table
+#ifdef _DEBUG
+        int maxN = 1000000;
+#else
+        int maxN = 10000000;
+#endif
+        int TN = 10000000;
+        for (int N = 1000000; N <= maxN; N *= 10) {
+            vector<int> T(N);
+            for (int i = 0; i < N; i++)
+                T[i] = RandInt32::get() % 65536;
+
+            vector<pair<int, int>> Q(TN);
+            for (auto& it : Q) {
+                int a = RandInt32::get() % N;
+                int b = RandInt32::get() % N;
+                it = make_pair(min(a, b), max(a, b));
+            }
+
+            cout << "N = " << N << endl;
+            {
+                PROFILE_HI_START(0);
+                auto st = makeSparseTable<int>(T, [](int a, int b) { return min(a, b); }, INT_MAX);
+                PROFILE_HI_STOP(0);
+
+                int res = 0;
+                PROFILE_HI_START(1);
+                for (auto& it : Q)
+                    res += st.query(it.first, it.second);
+                PROFILE_HI_STOP(1);
+                cout << "  SparseTableNestedLayout (build, query) : " << res << endl;
+            }
+            {
+                PROFILE_HI_START(0);
+                auto st = makeFlatSparseTable<int>(T, [](int a, int b) { return min(a, b); }, INT_MAX);
+                PROFILE_HI_STOP(0);
+
+                int res = 0;
+                PROFILE_HI_START(1);
+                for (auto& it : Q)
+                    res += st.query(it.first, it.second);
+                PROFILE_HI_STOP(1);
+                cout << "  SparseTableFlatLayout (build, query) : " << res << endl;
+            }
+        }
     }
 
     cout << "OK!" << endl;
@@ -8,12 +8,68 @@
 #include <vector>
 #include <functional>
 
+#include "rangeQueryBatch.h"
+
+//--------- Sparse Table Layouts ----------------------------------------------
+
+// each level is a separate heap block
+struct SparseTableNestedLayout {
+    template <typename T>
+    struct Storage {
+        vector<vector<T>> value;
+
+        void assign(int levels, int n, const T& dflt) {
+            value.assign(levels, vector<T>(n, dflt));
+        }
+
+        int size() const {
+            return int(value.size());
+        }
+
+        T* operator [](int level) {
+            return value[level].data();
+        }
+
+        const T* operator [](int level) const {
+            return value[level].data();
+        }
+    };
+};
+
+// all levels are in one contiguous block (level-major)
+struct SparseTableFlatLayout {
+    template <typename T>
+    struct Storage {
+        int levels = 0;
+        int N = 0;
+        vector<T> value;                // value[level * N + i]
+
+        void assign(int levels, int n, const T& dflt) {
+            this->levels = levels;
+            this->N = n;
+            value.assign(size_t(levels) * n, dflt);
+        }
+
+        int size() const {
+            return levels;
+        }
+
+        T* operator [](int level) {
+            return value.data() + size_t(level) * N;
+        }
+
+        const T* operator [](int level) const {
+            return value.data() + size_t(level) * N;
+        }
+    };
+};
+
 //--------- General Sparse Table ----------------------------------------------
 
-template <typename T, typename MergeOp = function<T(T,T)>>
+template <typename T, typename MergeOp = function<T(T,T)>, typename LayoutT = SparseTableNestedLayout>
 struct SparseTable {
     int                 N;
-    vector<vector<T>>   value;
+    typename LayoutT::template Storage<T> value;
     vector<int>         H;
     MergeOp             mergeOp;
     T                   defaultValue;
@@ -46,13 +102,13 @@ struct SparseTable {
         for (int i = 2; i < int(H.size()); i++)
             H[i] = H[i >> 1] + 1;
 
-        value.assign(H.back() + 1, vector<T>(n, defaultValue));
+        value.assign(H.back() + 1, n, defaultValue);
         for (int i = 0; i < n; i++)
             value[0][i] = a[i];
 
-        for (int i = 1; i < int(value.size()); i++) {
-            vector<T>& prev = value[i - 1];
-            vector<T>& curr = value[i];
+        for (int i = 1; i < value.size(); i++) {
+            const T* prev = value[i - 1];
+            T* curr = value[i];
             for (int v = 0; v < n; v++) {
                 if (v + (1 << (i - 1)) < n)
                     curr[v] = mergeOp(prev[v], prev[v + (1 << (i - 1))]);
@@ -74,10 +130,29 @@ struct SparseTable {
             return defaultValue;
 
         int k = H[right - left];
-        const vector<T>& mink = value[k];
+        const T* mink = value[k];
         return mergeOp(mink[left], mink[right - (1 << k)]);
     }
 
+    // out[i] = query(qry[i].first, qry[i].second), O(Q / threadN)
+    void queryBatch(const pair<int, int> qry[], int n, T out[], int threadN = 1, bool sortByLeft = false) const {
+        processQueryBatch(qry, n, out,
+            [this](int left, int right) { return query(left, right); },
+            [this](int left, int right) {
+                if (left <= right) {
+                    int k = H[right + 1 - left];
+                    prefetchQueryData(&value[k][left]);
+                    prefetchQueryData(&value[k][right + 1 - (1 << k)]);
+                }
+            },
+            threadN, sortByLeft);
+    }
+
+    void queryBatch(const vector<pair<int, int>>& qry, vector<T>& out, int threadN = 1, bool sortByLeft = false) const {
+        out.resize(qry.size());
+        queryBatch(qry.data(), int(qry.size()), out.data(), threadN, sortByLeft);
+    }
+
     // O(log(right - left + 1)), inclusive
     T queryNoOverlap(int left, int right) const {
         right++;
@@ -113,6 +188,16 @@ inline SparseTable<T, MergeOp> makeSparseTable(const T arr[], int size, MergeOp
     return SparseTable<T, MergeOp>(arr, size, op, dfltValue);
 }
 
+template <typename T, typename MergeOp>
+inline SparseTable<T, MergeOp, SparseTableFlatLayout> makeFlatSparseTable(const vector<T>& arr, MergeOp op, T dfltValue = T()) {
+    return SparseTable<T, MergeOp, SparseTableFlatLayout>(arr, op, dfltValue);
+}
+
+template <typename T, typename MergeOp>
+inline SparseTable<T, MergeOp, SparseTableFlatLayout> makeFlatSparseTable(const T arr[], int size, MergeOp op, T dfltValue = T()) {
+    return SparseTable<T, MergeOp, SparseTableFlatLayout>(arr, size, op, dfltValue);
+}
+
 /* example
     1) Min Sparse Table (RMQ)
         auto sparseTable = makeSparseTable<int>(v, [](int a, int b) { return min(a, b); }, INT_MAX);
@@ -133,4 +218,9 @@ inline SparseTable<T, MergeOp> makeSparseTable(const T arr[], int size, MergeOp
         auto sparseTable = makeSparseTable<int>(v, [](int a, int b) { return a + b; });
         ...
         sparseTable.queryNoOverlap(left, right);
+
+    5) Min Sparse Table with one contiguous memory block
+        auto sparseTable = makeFlatSparseTable<int>(v, [](int a, int b) { return min(a, b); }, INT_MAX);
+        ...
+        sparseTable.query(left, right);
 */
@@ -95,6 +95,57 @@ void testSparseTableSimpleRMQ() {
             assert(ans == gt);
         }
     }
+    cout << "*** long long & float ***" << endl;
+    {
+        int N = 1000;
+        int T = 10000;
+
+        vector<long long> valueLL(N);
+        vector<float> valueF(N);
+        for (int i = 0; i < N; i++) {
+            valueLL[i] = (static_cast<long long>(RandInt32::get()) << 20) - RandInt32::get();
+            valueF[i] = float(RandInt32::get() % 100000) / 3.0f;
+        }
+
+        SimpleSparseTableRMQ<long long> rmqLL(valueLL);
+        SimpleSparseTableRMQ<float> rmqF(valueF);
+        for (int i = 0; i < T; i++) {
+            int L = RandInt32::get() % N;
+            int R = min(N - 1, L + int(RandInt32::get() % (i & 1 ? 40 : N)));
+            assert(rmqLL.query(L, R) == *min_element(valueLL.begin() + L, valueLL.begin() + R + 1));
+            assert(rmqF.query(L, R) == *min_element(valueF.begin() + L, valueF.begin() + R + 1));
+        }
+    }
+    cout << "*** SIMD min / max kernel ***" << endl;
+    {
+        int N = 10000000;
+#ifdef _DEBUG
+        N = 10000;
+#endif
+        vector<int> a(N), b(N), out1(N), out2(N);
+        for (int i = 0; i < N; i++) {
+            a[i] = RandInt32::get();
+            b[i] = RandInt32::get();
+        }
+
+        PROFILE_START(0);
+        for (int i = 0; i < 10; i++)
+            SimdMinMax<int, false, false>::merge(out1.data(), a.data(), b.data(), N);
+        PROFILE_STOP(0);
+
+        PROFILE_START(1);
+        for (int i = 0; i < 10; i++)
+            SimdMinMax<int, false>::merge(out2.data(), a.data(), b.data(), N);
+        PROFILE_STOP(1);
+
+        assert(out1 == out2);
+        int maxA = SimdMinMax<int, true>::reduce(a.data(), N);
+        assert(maxA == *max_element(a.begin(), a.end()));
+        for (int n = 1; n <= 40; n++) {
+            int minA = SimdMinMax<int, false>::reduce(a.data() + 7, n);
+            assert(minA == *min_element(a.begin() + 7, a.begin() + 7 + n));
+        }
+    }
     cout << "*** Speed test ***" << endl;
     {
         int N = 10000;
@@ -158,7 +209,9 @@ void testSparseTableSimpleRMQ() {
 
         PROFILE_START(3);
         {
+            PROFILE_START(4);
             SimpleSparseTableRMQ<int> rmq(value);
+            PROFILE_STOP(4);
 
             int ansSum = 0;
             for (auto q : query)
@@ -5,8 +5,12 @@
 #endif
 #include <immintrin.h>
 
+#include "simdMinMax.h"
+
 template<typename T>
 struct SimpleSparseTableRMQ {
+    static const int SHORT_RANGE = 16;  // ranges shorter than this are scanned directly
+
     int N;
     int H;
     vector<vector<T>> values;
@@ -21,14 +25,16 @@ struct SimpleSparseTableRMQ {
         H = 32 - __builtin_clz((N << 1) - 1);
 #endif
 
-        values.assign(H, v);
+        values.resize(H);
+        values[0] = v;
         for (int i = 1; i < H; i++) {
             int d = 1 << (i - 1);
             auto& prev = values[i - 1];
             auto& curr = values[i];
-            for (int j = 0; j < N - d; j++)
-                //curr[j] = min(prev[j], prev[min(N - 1, j + d)]);
-                curr[j] = min(prev[j], prev[j + d]);
+            // curr[j] = min(prev[j], prev[j + d]), 0 <= j <= N - 2d
+            int n = max(0, N - 2 * d + 1);
+            curr.resize(n);
+            SimdMinMax<T, false>::merge(curr.data(), prev.data(), prev.data() + d, n);
         }
     }
 
@@ -36,6 +42,9 @@ struct SimpleSparseTableRMQ {
     // PRECONDITION: L <= R
     T query(int L, int R) const {
         //assert(L <= R);
+        if (R - L < SHORT_RANGE)
+            return SimdMinMax<T, false>::reduce(&values[0][L], R - L + 1);
+
         R++;
 #ifndef __GNUC__
         int depth = 31 - _lzcnt_u32((unsigned int)(R - L));
@@ -178,6 +178,36 @@ void testFastSqrtTree() {
             }
         }
     }
+    // Min / Max (SIMD build)
+    {
+        int N = 10000;
+        int T = 1000;
+
+        vector<int> in(N);
+        vector<float> inF(N);
+        for (int i = 0; i < N; i++) {
+            in[i] = RandInt32::get();
+            inF[i] = float(RandInt32::get() % 100000) / 7.0f;
+        }
+
+        FastSqrtTree<int, MinOp<int>> treeMin(in, MinOp<int>(), INT_MAX);
+        FastSqrtTree<float, MaxOp<float>> treeMax(inF, MaxOp<float>(), -numeric_limits<float>::max());
+
+        for (int i = 0; i < T; i++) {
+            int left = RandInt32::get() % N;
+            int right = RandInt32::get() % N;
+            if (left > right)
+                swap(left, right);
+
+            assert(treeMin.query(left, right) == *min_element(in.begin() + left, in.begin() + right + 1));
+            assert(treeMax.query(left, right) == *max_element(inF.begin() + left, inF.begin() + right + 1));
+
+            int idx = left + (right - left) / 2;
+            in[idx] = RandInt32::get();
+            treeMin.update(idx, in[idx]);
+            assert(treeMin.query(left, right) == *min_element(in.begin() + left, in.begin() + right + 1));
+        }
+    }
     cout << "*** Speed Test for Query ***" << endl;
     // Sparse Table ~ Disjoint Sparse Table > Sqrt Tree >> Compact Segment Tree (x3) >>> Segment Tree (x15)
     {
@@ -146,6 +146,17 @@ private:
     void buildBetween(int layer, int left, int right, int sizeLog, int countLog) {
         int count = (right - left) / (1 << sizeLog) + 1;
 
+        if (SimdMergeOp<T, MergeOp>::enabled) {
+            // between[i][j] = op(A[block i], between[i + 1][j]), from the last row
+            T* rows = &between[layer - 1][left];
+            for (int i = count - 1; i >= 0; i--) {
+                T* row = rows + (i << countLog);
+                row[i] = suffix[layer][left + (i << sizeLog)];
+                SimdMergeOp<T, MergeOp>::Kernel::merge(row + i + 1, row + (1 << countLog) + i + 1, row[i], count - i - 1);
+            }
+            return;
+        }
+
         for (int i = 0; i < count; i++) {
             T ans = defaultValue;
             for (int j = i; j < count; j++) {
@@ -14,6 +14,7 @@ using namespace std;
 #include "scapegoatTree.h"
 #include "splayTree.h"
 #include "treap.h"
+#include "../memory/newTypeAllocator.h"
 
 /////////// For Testing ///////////////////////////////////////////////////////
 
@@ -173,7 +174,9 @@ void testBenchmarkBST() {
         { cout << "SGT(0.75): "; ScapegoatTree<int> tree(0.75); testInsertSorted(tree, in); }
         { cout << "SGT(0.9):  "; ScapegoatTree<int> tree(0.9);  testInsertSorted(tree, in); }
         { cout << "SPT:       "; SplayTree<int> tree;           testInsertSorted(tree, in); }
+        { cout << "SPT(new):  "; SplayTree<int, NewTypeAllocator> tree; testInsertSorted(tree, in); }
         { cout << "TRP:       "; Treap<int> tree;               testInsertSorted(tree, in); }
+        { cout << "TRP(new):  "; Treap<int, NewTypeAllocator> tree; testInsertSorted(tree, in); }
     }
     cout << "2) Insert random elements and Search elements" << endl;
     {
@@ -195,7 +198,9 @@ void testBenchmarkBST() {
         { cout << "SGT(0.75): "; ScapegoatTree<int> tree(0.75); testInsertAndSearchRandom(tree, in, key); }
         { cout << "SGT(0.9):  "; ScapegoatTree<int> tree(0.9);  testInsertAndSearchRandom(tree, in, key); }
         { cout << "SPT:       "; SplayTree<int> tree;           testInsertAndSearchRandom(tree, in, key); }
+        { cout << "SPT(new):  "; SplayTree<int, NewTypeAllocator> tree; testInsertAndSearchRandom(tree, in, key); }
         { cout << "TRP:       "; Treap<int> tree;               testInsertAndSearchRandom(tree, in, key); }
+        { cout << "TRP(new):  "; Treap<int, NewTypeAllocator> tree; testInsertAndSearchRandom(tree, in, key); }
     }
     cout << "3) Insert random elements and Erase elements" << endl;
     {
@@ -217,7 +222,9 @@ void testBenchmarkBST() {
         { cout << "SGT(0.75): "; ScapegoatTree<int> tree(0.75); testInsertAndEraseRandom(tree, in, key); }
         { cout << "SGT(0.9):  "; ScapegoatTree<int> tree(0.9);  testInsertAndEraseRandom(tree, in, key); }
         { cout << "SPT:       "; SplayTree<int> tree;           testInsertAndEraseRandom(tree, in, key); }
+        { cout << "SPT(new):  "; SplayTree<int, NewTypeAllocator> tree; testInsertAndEraseRandom(tree, in, key); }
         { cout << "TRP:       "; Treap<int> tree;               testInsertAndEraseRandom(tree, in, key); }
+        { cout << "TRP(new):  "; Treap<int, NewTypeAllocator> tree; testInsertAndEraseRandom(tree, in, key); }
     }
 
     cout << "OK!" << endl;
@@ -107,6 +107,26 @@ void testSplay() {
             }
         }
     }
+    {
+        // move-only with a pooled allocator
+        vector<int> in(100);
+        iota(in.begin(), in.end(), 0);
+
+        vector<SplayTree<int>> v;
+        v.emplace_back();
+        for (int x : in)
+            v.back().insert(x);
+        v.emplace_back();
+
+        SplayTree<int> spt(std::move(v[0]));
+        assert(v[0].size() == 0);
+        checkSearch(spt, in);
+        checkIndex(spt, in);
+
+        v[1] = std::move(spt);
+        checkSearch(v[1], in);
+        checkIndex(v[1], in);
+    }
     cout << "OK!" << endl;
 
     cout << "*** Speed test RBTree vs SplayTree ***" << endl;
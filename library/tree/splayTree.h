@@ -1,8 +1,12 @@
 #pragma once
 
 #include <algorithm>
+#include "../memory/fixedSizeAllocator.h"
 
-template <typename T>
+// Splay tree
+//  - AllocatorT : node allocator (TypeAllocator, SimpleTypeAllocator, NewTypeAllocator, ...)
+//      [CAUTION] the splay tree is move-only because it owns its nodes (see memory/fixedSizeAllocator.h)
+template <typename T, template <typename> class AllocatorT = TypeAllocator>
 struct SplayTree {
     struct Node {
         Node* parent;
@@ -21,11 +25,35 @@ struct SplayTree {
     int     count;
     Node*   tree;
 
+    AllocatorT<Node> allocator;
+
     SplayTree() {
         count = 0;
         tree = nullptr;
     }
 
+    SplayTree(const SplayTree&) = delete;
+    SplayTree& operator =(const SplayTree&) = delete;
+
+    SplayTree(SplayTree&& rhs) : count(rhs.count), tree(rhs.tree), allocator(std::move(rhs.allocator)) {
+        rhs.count = 0;
+        rhs.tree = nullptr;
+    }
+
+    SplayTree& operator =(SplayTree&& rhs) {
+        if (this != &rhs) {
+            deleteRecursive(tree);
+
+            count = rhs.count;
+            tree = rhs.tree;
+            allocator = std::move(rhs.allocator);
+
+            rhs.count = 0;
+            rhs.tree = nullptr;
+        }
+        return *this;
+    }
+
     ~SplayTree() {
         deleteRecursive(tree);
     }
@@ -168,12 +196,12 @@ struct SplayTree {
 protected:
     Node* createNode() {
         count++;
-        return new Node();
+        return allocator.construct();
     }
 
     void destroyNode(Node* node) {
         count--;
-        delete node;
+        allocator.destroy(node);
     }
 
     void deleteRecursive(Node* node) {
@@ -206,6 +206,26 @@ void testTreap() {
             }
         }
     }
+    {
+        // move-only with a pooled allocator
+        vector<int> in(100);
+        iota(in.begin(), in.end(), 0);
+
+        vector<Treap<int>> v;
+        v.emplace_back();
+        for (int x : in)
+            v.back().insert(x);
+        v.emplace_back();
+
+        Treap<int> tr(std::move(v[0]));
+        assert(v[0].size() == 0);
+        checkSearch(tr, in);
+        checkIndex(tr, in);
+
+        v[1] = std::move(tr);
+        checkSearch(v[1], in);
+        checkIndex(v[1], in);
+    }
     cout << "OK!" << endl;
 
     cout << "*** Speed test RBTree vs SplayTree vs Treap ***" << endl;
@@ -1,9 +1,12 @@
 #pragma once
 
 #include <algorithm>
+#include "../memory/fixedSizeAllocator.h"
 
 // Treap (Cartesian tree) = tree + heap
-template <typename T>
+//  - AllocatorT : node allocator (TypeAllocator, SimpleTypeAllocator, NewTypeAllocator, ...)
+//      [CAUTION] the treap is move-only because it owns its nodes (see memory/fixedSizeAllocator.h)
+template <typename T, template <typename> class AllocatorT = TypeAllocator>
 struct Treap {
     struct Node {
         Node* parent;
@@ -17,7 +20,7 @@ struct Treap {
 
         void init() {
             parent = left = right = nullptr;
-            priority = Treap<T>::random();
+            priority = Treap::random();
             cnt = 1;
         }
     };
@@ -25,11 +28,35 @@ struct Treap {
     int     count;
     Node*   tree;
 
+    AllocatorT<Node> allocator;
+
     Treap() {
         count = 0;
         tree = nullptr;
     }
 
+    Treap(const Treap&) = delete;
+    Treap& operator =(const Treap&) = delete;
+
+    Treap(Treap&& rhs) : count(rhs.count), tree(rhs.tree), allocator(std::move(rhs.allocator)) {
+        rhs.count = 0;
+        rhs.tree = nullptr;
+    }
+
+    Treap& operator =(Treap&& rhs) {
+        if (this != &rhs) {
+            deleteRecursive(tree);
+
+            count = rhs.count;
+            tree = rhs.tree;
+            allocator = std::move(rhs.allocator);
+
+            rhs.count = 0;
+            rhs.tree = nullptr;
+        }
+        return *this;
+    }
+
     ~Treap() {
         deleteRecursive(tree);
     }
@@ -129,7 +156,7 @@ struct Treap {
 
 protected:
     Node* createNode(T item) {
-        Node* p = new Node();
+        Node* p = allocator.construct();
         p->init();
         p->value = item;
         count++;
@@ -138,7 +165,7 @@ protected:
 
     void destroyNode(Node* node) {
         count--;
-        delete node;
+        allocator.destroy(node);
     }
 
     void deleteRecursive(Node* node) {